@@ -0,0 +1,87 @@
+# Copyright (c) 2025 Jakub Zimnol
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+# Prints the static RAM (.data and .bss) used by the shell library and fails if
+# it exceeds the budget. Run after every build of the library:
+#
+#   cmake -DNM=<nm> -DLIBRARY=<libpico_freertos_shell_lib.a> [-DBUDGET=<bytes>]
+#         -P cmake/pfs_ram_report.cmake
+#
+# The task stacks, command history, session buffers (input line, escape
+# sequences, tokens) and queue storage are all allocated statically, messages
+# themselves are allocated on the heap and are not included.
+
+if(NOT DEFINED NM OR NOT DEFINED LIBRARY)
+    message(FATAL_ERROR "NM and LIBRARY are required")
+endif()
+if(NOT DEFINED BUDGET)
+    set(BUDGET 0)
+endif()
+
+execute_process(
+    COMMAND ${NM} -A -S -t d --size-sort ${LIBRARY}
+    OUTPUT_VARIABLE Symbols
+    ERROR_QUIET
+    RESULT_VARIABLE Ret)
+if(NOT Ret EQUAL 0)
+    message(FATAL_ERROR "${NM} failed on ${LIBRARY}")
+endif()
+
+# lines look like "<archive>:<object>:<address> <size> <type> <name>"
+string(REPLACE "\n" ";" Symbols "${Symbols}")
+set(Total 0)
+set(Lines "")
+foreach(Line ${Symbols})
+    if(NOT Line MATCHES ":([^:]+):[0-9]+ ([0-9]+) [bBdDC] (.+)$")
+        continue()
+    endif()
+    set(Object ${CMAKE_MATCH_1})
+    math(EXPR Size "${CMAKE_MATCH_2}")
+    set(Name ${CMAKE_MATCH_3})
+    if(Size EQUAL 0)
+        continue()
+    endif()
+    math(EXPR Total "${Total} + ${Size}")
+    string(REGEX REPLACE "\\.(c\\.)?o(bj)?$" "" Object ${Object})
+    # right aligned, so the lines sort by size as strings
+    set(Padded "${Size}")
+    string(LENGTH "${Padded}" Len)
+    while(Len LESS 8)
+        set(Padded " ${Padded}")
+        math(EXPR Len "${Len} + 1")
+    endwhile()
+    list(APPEND Lines "${Padded} ${Object}: ${Name}")
+endforeach()
+
+# --size-sort sorts every object separately, print the largest first overall
+list(SORT Lines ORDER DESCENDING)
+message("pico_freertos_shell static RAM:")
+foreach(Line ${Lines})
+    message("  ${Line}")
+endforeach()
+if(BUDGET GREATER 0)
+    message("  total ${Total} bytes, budget ${BUDGET} bytes")
+    if(Total GREATER BUDGET)
+        message(FATAL_ERROR "static RAM of the shell (${Total} bytes) exceeds "
+                            "PFS_RAM_BUDGET (${BUDGET} bytes)")
+    endif()
+else()
+    message("  total ${Total} bytes")
+endif()
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <pico_freertos_shell/init.h>
+#include <pico_freertos_shell/transport.h>
+
+#include <benchmark_utils.h>
+
+// `_pfs_append_queue()` as called by printf() from a task, and the drain of
+// the queue by the shell task into a transport that discards the bytes
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+// stays within the queue, so that no message is dropped
+#define BATCH_SIZE (PFS_MSG_QUEUE_SIZE)
+#define NUMBER_OF_BATCHES (20000U)
+
+void _pfs_append_queue(const char *buffer, uint32_t buffer_size);
+
+typedef struct {
+    pfs_transport_t base;
+    volatile bool measuring;
+    volatile size_t messages;
+    volatile uint64_t last_write_ns;
+} null_transport_t;
+
+static null_transport_t m_transport;
+static size_t m_sizes[16];
+static size_t m_number_of_sizes;
+
+static int null_write(pfs_transport_t *transport,
+                      const char *data,
+                      size_t len,
+                      pfs_transport_write_done_t done,
+                      void *arg) {
+    null_transport_t *t = (null_transport_t *) transport;
+    if (!t->measuring) {
+        // reports are printed through the shell as well
+        fwrite(data, 1, len, stdout);
+        fflush(stdout);
+    } else if (done != NULL) {
+        // only queued messages are counted, not the prompt handling
+        t->messages++;
+        t->last_write_ns = benchmark_now_ns();
+    }
+    if (done != NULL) {
+        done(arg);
+    }
+    return 0;
+}
+
+static size_t null_read(pfs_transport_t *transport, char *buffer, size_t size) {
+    (void) transport;
+    (void) buffer;
+    (void) size;
+    return 0;
+}
+
+static void null_flush(pfs_transport_t *transport) {
+    (void) transport;
+}
+
+static const pfs_transport_vtable_t NULL_TRANSPORT_VTABLE = {
+        .write = null_write,
+        .read = null_read,
+        .flush = null_flush,
+        .set_rx_callback = NULL,
+        .is_connected = NULL,
+};
+
+static void wait_for_messages(size_t messages) {
+    while (m_transport.messages < messages) {
+        vTaskDelay(1);
+    }
+}
+
+static void benchmark_append_queue(size_t message_size) {
+    char *message = malloc(message_size);
+    memset(message, 'a', message_size);
+
+    benchmark_t append = {0};
+    benchmark_t drain = {0};
+    m_transport.messages = 0;
+    m_transport.measuring = true;
+    for (size_t i = 0; i < NUMBER_OF_BATCHES; i++) {
+        // the benchmark task has a higher priority than the shell task, so
+        // the whole batch is queued before the shell starts printing it
+        for (size_t j = 0; j < BATCH_SIZE; j++) {
+            benchmark_begin(&append);
+            _pfs_append_queue(message, message_size);
+            benchmark_end(&append);
+        }
+        uint64_t queued_ns = benchmark_now_ns();
+        wait_for_messages((i + 1) * BATCH_SIZE);
+        drain.elapsed_ns += m_transport.last_write_ns - queued_ns;
+        drain.iterations += BATCH_SIZE;
+    }
+    m_transport.measuring = false;
+
+    benchmark_report(&append, "append_queue",
+                     "\"message_size\": %zu, \"queue_size\": %u",
+                     message_size, (unsigned) PFS_MSG_QUEUE_SIZE);
+    benchmark_report(&drain, "append_queue_drain",
+                     "\"message_size\": %zu, \"queue_size\": %u",
+                     message_size, (unsigned) PFS_MSG_QUEUE_SIZE);
+    free(message);
+}
+
+static void benchmark_task(void *pvParameters) {
+    (void) pvParameters;
+    // wait for the shell to print its greeting
+    vTaskDelay(pdMS_TO_TICKS(100));
+    for (size_t i = 0; i < m_number_of_sizes; i++) {
+        benchmark_append_queue(m_sizes[i]);
+    }
+    // let the shell print the last report
+    vTaskDelay(pdMS_TO_TICKS(100));
+    exit(0);
+}
+
+int main(int argc, char **argv) {
+    const size_t defaults[] = {16, 128, 1024};
+    m_number_of_sizes =
+            benchmark_sizes(argc, argv, defaults, ARRAY_SIZE(defaults),
+                            m_sizes, ARRAY_SIZE(m_sizes));
+
+    m_transport.base.vtable = &NULL_TRANSPORT_VTABLE;
+    if (pfs_session_add(&m_transport.base)) {
+        return 1;
+    }
+    pfs_init();
+    xTaskCreate(benchmark_task, "Benchmark", configMINIMAL_STACK_SIZE, NULL,
+                configMAX_PRIORITIES - 1, NULL);
+    vTaskStartScheduler();
+    return 0;
+}
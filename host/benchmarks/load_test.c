@@ -0,0 +1,471 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <malloc.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <pico_freertos_shell/init.h>
+#include <pico_freertos_shell/transport.h>
+
+// load test of the output path: M producer tasks print through the wrapped
+// printf()/puts()/_write() into a session served on a transport of a given
+// throughput. Every message carries its producer and the time it was printed
+// at, the transport measures the latency when the message is written. The
+// result is a single JSON line on the real stdout.
+
+#define MAX_PRODUCERS (32U)
+#define MAX_LATENCIES (1U << 20)
+#define MAX_MESSAGE_SIZE (1000U)
+// '@', producer (2 hex digits), time in ns (16 hex digits)
+#define MESSAGE_HEADER_LEN (19U)
+
+int _write(int handle, char *buffer, int length);
+
+typedef enum {
+    METHOD_PRINTF,
+    METHOD_PUTS,
+    METHOD_WRITE,
+    METHOD_MIXED,
+} method_t;
+
+static const char *const METHOD_NAMES[] = {"printf", "puts", "write", "mixed"};
+
+static struct {
+    size_t producers;
+    // messages per second of a single producer, 0 means as fast as possible
+    size_t rate;
+    size_t size;
+    size_t size_max;
+    method_t method;
+    // bytes per second the transport writes, 0 means unlimited
+    size_t link_bps;
+    size_t duration_ms;
+    UBaseType_t priority;
+} m_config = {
+        .producers = 4,
+        .rate = 100,
+        .size = 64,
+        .size_max = 0,
+        .method = METHOD_PRINTF,
+        .link_bps = 11520,
+        .duration_ms = 2000,
+        .priority = tskIDLE_PRIORITY + PFS_TASK_PRIORITY,
+};
+
+static volatile bool m_running;
+static size_t m_sent[MAX_PRODUCERS];
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+/* Heap usage ----------------------------------------------------------- */
+
+static size_t m_heap_used;
+static size_t m_heap_peak;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t number, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+static void heap_add(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    size_t used = __atomic_add_fetch(&m_heap_used, malloc_usable_size(ptr),
+                                     __ATOMIC_RELAXED);
+    size_t peak = __atomic_load_n(&m_heap_peak, __ATOMIC_RELAXED);
+    while (used > peak
+           && !__atomic_compare_exchange_n(&m_heap_peak, &peak, used, true,
+                                           __ATOMIC_RELAXED,
+                                           __ATOMIC_RELAXED)) {
+    }
+}
+
+static void heap_remove(void *ptr) {
+    if (ptr != NULL) {
+        __atomic_sub_fetch(&m_heap_used, malloc_usable_size(ptr),
+                           __ATOMIC_RELAXED);
+    }
+}
+
+void *__wrap_malloc(size_t size) {
+    void *ptr = __real_malloc(size);
+    heap_add(ptr);
+    return ptr;
+}
+
+void *__wrap_calloc(size_t number, size_t size) {
+    void *ptr = __real_calloc(number, size);
+    heap_add(ptr);
+    return ptr;
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    heap_remove(ptr);
+    void *new_ptr = __real_realloc(ptr, size);
+    // the old block is still allocated if reallocation fails
+    heap_add(new_ptr != NULL || size == 0 ? new_ptr : ptr);
+    return new_ptr;
+}
+
+void __wrap_free(void *ptr) {
+    heap_remove(ptr);
+    __real_free(ptr);
+}
+
+/* Transport ------------------------------------------------------------ */
+
+typedef struct {
+    pfs_transport_t base;
+    // time the link is busy until, when its throughput is limited
+    uint64_t busy_until_ns;
+    size_t bytes;
+    size_t messages[MAX_PRODUCERS];
+    size_t reported_drops;
+    uint32_t *latencies_us;
+    size_t number_of_latencies;
+} load_transport_t;
+
+static load_transport_t m_transport;
+
+static void wait_for_link(load_transport_t *t, size_t len) {
+    if (m_config.link_bps == 0) {
+        return;
+    }
+    uint64_t now = now_ns();
+    if (t->busy_until_ns < now) {
+        t->busy_until_ns = now;
+    }
+    t->busy_until_ns += (uint64_t) len * 1000000000u / m_config.link_bps;
+    // the shell task is blocked for as long as the link would be busy
+    while (now_ns() + 1000000u < t->busy_until_ns) {
+        vTaskDelay(1);
+    }
+}
+
+static void record_message(load_transport_t *t, const char *data, size_t len) {
+    unsigned producer;
+    uint64_t sent_ns;
+    if (len < MESSAGE_HEADER_LEN || data[0] != '@'
+        || sscanf(data, "@%2x%16" SCNx64, &producer, &sent_ns) != 2
+        || producer >= MAX_PRODUCERS) {
+        return;
+    }
+    t->messages[producer]++;
+    if (t->number_of_latencies < MAX_LATENCIES) {
+        uint64_t latency_us = (now_ns() - sent_ns) / 1000u;
+        t->latencies_us[t->number_of_latencies++] =
+                latency_us > UINT32_MAX ? UINT32_MAX : (uint32_t) latency_us;
+    }
+}
+
+static int load_transport_write(pfs_transport_t *transport,
+                                const char *data,
+                                size_t len,
+                                pfs_transport_write_done_t done,
+                                void *arg) {
+    load_transport_t *t = (load_transport_t *) transport;
+    wait_for_link(t, len);
+    if (done == NULL) {
+        // written by the shell itself, e.g. the prompt or the drop notice
+        int dropped;
+        const char *notice = strstr(data, "--- ");
+        if (notice != NULL
+            && sscanf(notice, "--- %d messages dropped", &dropped) == 1) {
+            t->reported_drops += (size_t) dropped;
+        }
+        return 0;
+    }
+    t->bytes += len;
+    record_message(t, data, len);
+    done(arg);
+    return 0;
+}
+
+static size_t load_transport_read(pfs_transport_t *transport,
+                                  char *buffer,
+                                  size_t size) {
+    (void) transport;
+    (void) buffer;
+    (void) size;
+    return 0;
+}
+
+static void load_transport_flush(pfs_transport_t *transport) {
+    (void) transport;
+}
+
+static const pfs_transport_vtable_t LOAD_TRANSPORT_VTABLE = {
+        .write = load_transport_write,
+        .read = load_transport_read,
+        .flush = load_transport_flush,
+        .set_rx_callback = NULL,
+        .is_connected = NULL,
+};
+
+/* Producers ------------------------------------------------------------ */
+
+static void print_message(size_t producer, char *buffer, size_t size) {
+    method_t method = m_config.method == METHOD_MIXED
+                              ? (method_t) (producer % METHOD_MIXED)
+                              : m_config.method;
+    // the newline is a part of the size, puts() prints it separately
+    int len = snprintf(buffer, size, "@%02x%016" PRIx64, (unsigned) producer,
+                       now_ns());
+    memset(&buffer[len], '.', size - len);
+    buffer[size - 1] = '\n';
+    switch (method) {
+    case METHOD_PRINTF:
+        // not "%s\n", the compiler would replace it with puts()
+        printf("%.*s", (int) size, buffer);
+        break;
+    case METHOD_PUTS:
+        buffer[size - 1] = '\0';
+        puts(buffer);
+        break;
+    default:
+        (void) _write(1, buffer, (int) size);
+        break;
+    }
+}
+
+static size_t next_size(uint32_t *seed) {
+    if (m_config.size_max <= m_config.size) {
+        return m_config.size;
+    }
+    *seed = *seed * 1103515245u + 12345u;
+    size_t range = m_config.size_max - m_config.size + 1;
+    return m_config.size + (*seed >> 8) % range;
+}
+
+static void producer_task(void *pvParameters) {
+    size_t producer = (size_t) pvParameters;
+    uint32_t seed = (uint32_t) producer;
+    char buffer[MAX_MESSAGE_SIZE + 1];
+    TickType_t start = xTaskGetTickCount();
+    TickType_t last_wake = start;
+    while (m_running) {
+        if (m_config.rate == 0) {
+            print_message(producer, buffer, next_size(&seed) + 1);
+            m_sent[producer]++;
+            taskYIELD();
+            continue;
+        }
+        // the messages due by now are printed at once, the rate may exceed
+        // the tick rate
+        vTaskDelayUntil(&last_wake, 1);
+        uint64_t elapsed = (uint64_t) (last_wake - start);
+        size_t due = (size_t) (elapsed * m_config.rate / configTICK_RATE_HZ);
+        while (m_sent[producer] < due && m_running) {
+            print_message(producer, buffer, next_size(&seed) + 1);
+            m_sent[producer]++;
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+/* Report --------------------------------------------------------------- */
+
+static int compare_latencies(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *) a;
+    uint32_t y = *(const uint32_t *) b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t percentile(const uint32_t *sorted, size_t len, double p) {
+    if (len == 0) {
+        return 0;
+    }
+    size_t index = (size_t) (p / 100.0 * (double) (len - 1) + 0.5);
+    return sorted[index];
+}
+
+static void report(uint64_t elapsed_ns, size_t heap_baseline) {
+    size_t sent = 0;
+    size_t received = 0;
+    for (size_t i = 0; i < m_config.producers; i++) {
+        sent += m_sent[i];
+        received += m_transport.messages[i];
+    }
+    uint32_t *latencies = m_transport.latencies_us;
+    size_t len = m_transport.number_of_latencies;
+    qsort(latencies, len, sizeof(latencies[0]), compare_latencies);
+
+    // printf() is queued by the shell, the report goes to the real stdout
+    fprintf(stdout,
+            "{\"producers\": %zu, \"rate\": %zu, \"size\": %zu, "
+            "\"size_max\": %zu, \"method\": \"%s\", \"link_bps\": %zu, "
+            "\"queue_size\": %u, \"idle_ms\": %u, \"duration_ms\": %zu, "
+            "\"sent\": %zu, \"received\": %zu, \"dropped\": %zu, "
+            "\"dropped_reported\": %zu, \"bytes_per_s\": %.0f, "
+            "\"latency_us\": {\"p50\": %" PRIu32 ", \"p90\": %" PRIu32
+            ", \"p99\": %" PRIu32 ", \"p999\": %" PRIu32 ", \"max\": %" PRIu32
+            "}, \"heap_peak_bytes\": %zu}\n",
+            m_config.producers, m_config.rate, m_config.size,
+            m_config.size_max > m_config.size ? m_config.size_max
+                                              : m_config.size,
+            METHOD_NAMES[m_config.method], m_config.link_bps,
+            (unsigned) PFS_MSG_QUEUE_SIZE, (unsigned) PFS_MAIN_TASK_IDLE_MS,
+            m_config.duration_ms, sent, received, sent - received,
+            m_transport.reported_drops,
+            (double) m_transport.bytes * 1e9 / (double) elapsed_ns,
+            percentile(latencies, len, 50.0), percentile(latencies, len, 90.0),
+            percentile(latencies, len, 99.0), percentile(latencies, len, 99.9),
+            len > 0 ? latencies[len - 1] : 0,
+            m_heap_peak > heap_baseline ? m_heap_peak - heap_baseline : 0);
+    fflush(stdout);
+}
+
+static void control_task(void *pvParameters) {
+    (void) pvParameters;
+    // the shell prints its greeting first
+    vTaskDelay(pdMS_TO_TICKS(100));
+    size_t heap_baseline = __atomic_load_n(&m_heap_used, __ATOMIC_RELAXED);
+    __atomic_store_n(&m_heap_peak, heap_baseline, __ATOMIC_RELAXED);
+    uint64_t start = now_ns();
+
+    m_running = true;
+    for (size_t i = 0; i < m_config.producers; i++) {
+        if (xTaskCreate(producer_task, "Producer", configMINIMAL_STACK_SIZE,
+                        (void *) i, m_config.priority, NULL)
+            != pdPASS) {
+            fprintf(stderr, "failed to create the producer tasks\n");
+            exit(1);
+        }
+    }
+    vTaskDelay(pdMS_TO_TICKS(m_config.duration_ms));
+    m_running = false;
+
+    // the queue is drained once nothing is written for a while
+    size_t bytes;
+    do {
+        bytes = m_transport.bytes;
+        vTaskDelay(pdMS_TO_TICKS(200));
+    } while (bytes != m_transport.bytes);
+    report(now_ns() - start, heap_baseline);
+    exit(0);
+}
+
+/* Main ----------------------------------------------------------------- */
+
+static void usage(const char *name) {
+    fprintf(stderr,
+            "usage: %s [--producers M] [--rate MSG_PER_S] [--size BYTES] "
+            "[--size-max BYTES] [--method printf|puts|write|mixed] "
+            "[--link-bps BYTES_PER_S] [--duration-ms MS] [--priority P]\n",
+            name);
+}
+
+static int parse_method(const char *name, method_t *out) {
+    for (size_t i = 0; i < sizeof(METHOD_NAMES) / sizeof(METHOD_NAMES[0]);
+         i++) {
+        if (strcmp(name, METHOD_NAMES[i]) == 0) {
+            *out = (method_t) i;
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int parse_args(int argc, char **argv) {
+    static const struct option OPTIONS[] = {
+            {"producers", required_argument, NULL, 'p'},
+            {"rate", required_argument, NULL, 'r'},
+            {"size", required_argument, NULL, 's'},
+            {"size-max", required_argument, NULL, 'S'},
+            {"method", required_argument, NULL, 'm'},
+            {"link-bps", required_argument, NULL, 'l'},
+            {"duration-ms", required_argument, NULL, 'd'},
+            {"priority", required_argument, NULL, 'P'},
+            {NULL, 0, NULL, 0}};
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", OPTIONS, NULL)) != -1) {
+        switch (opt) {
+        case 'p':
+            m_config.producers = strtoul(optarg, NULL, 0);
+            break;
+        case 'r':
+            m_config.rate = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            m_config.size = strtoul(optarg, NULL, 0);
+            break;
+        case 'S':
+            m_config.size_max = strtoul(optarg, NULL, 0);
+            break;
+        case 'm':
+            if (parse_method(optarg, &m_config.method)) {
+                return 1;
+            }
+            break;
+        case 'l':
+            m_config.link_bps = strtoul(optarg, NULL, 0);
+            break;
+        case 'd':
+            m_config.duration_ms = strtoul(optarg, NULL, 0);
+            break;
+        case 'P':
+            m_config.priority = (UBaseType_t) strtoul(optarg, NULL, 0);
+            break;
+        default:
+            return 1;
+        }
+    }
+    return optind != argc || m_config.producers == 0
+           || m_config.producers > MAX_PRODUCERS
+           || m_config.size <= MESSAGE_HEADER_LEN
+           || m_config.size > MAX_MESSAGE_SIZE
+           || m_config.size_max > MAX_MESSAGE_SIZE
+           || m_config.priority >= configMAX_PRIORITIES - 1;
+}
+
+int main(int argc, char **argv) {
+    if (parse_args(argc, argv)) {
+        usage(argv[0]);
+        return 1;
+    }
+    m_transport.base.vtable = &LOAD_TRANSPORT_VTABLE;
+    m_transport.latencies_us =
+            malloc(MAX_LATENCIES * sizeof(m_transport.latencies_us[0]));
+    if (m_transport.latencies_us == NULL
+        || pfs_session_add(&m_transport.base)) {
+        return 1;
+    }
+    pfs_init();
+    xTaskCreate(control_task, "LoadTest", configMINIMAL_STACK_SIZE, NULL,
+                configMAX_PRIORITIES - 1, NULL);
+    vTaskStartScheduler();
+    return 0;
+}
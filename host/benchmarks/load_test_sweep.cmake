@@ -0,0 +1,84 @@
+# Copyright (c) 2025 Jakub Zimnol
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+# Runs the load test for every combination of the message queue size and the
+# idle interval of the shell task, each in its own host build:
+#
+#   cmake -DFREERTOS_KERNEL_PATH=... [-DQUEUE_SIZES="10;30;100"]
+#         [-DIDLE_MS="1;10;50"] [-DLOAD_TEST_ARGS="--producers;8;--rate;500"]
+#         [-DBUILD_ROOT=build_sweep] -P host/benchmarks/load_test_sweep.cmake
+#
+# The JSON lines of all runs are collected in ${BUILD_ROOT}/results.jsonl.
+
+if(NOT DEFINED FREERTOS_KERNEL_PATH)
+    message(FATAL_ERROR "FREERTOS_KERNEL_PATH is required")
+endif()
+if(NOT DEFINED QUEUE_SIZES)
+    set(QUEUE_SIZES 10 30 100)
+endif()
+if(NOT DEFINED IDLE_MS)
+    set(IDLE_MS 1 10 50)
+endif()
+if(NOT DEFINED LOAD_TEST_ARGS)
+    set(LOAD_TEST_ARGS "")
+endif()
+if(NOT DEFINED BUILD_ROOT)
+    set(BUILD_ROOT ${CMAKE_CURRENT_BINARY_DIR}/build_sweep)
+endif()
+get_filename_component(SOURCE_DIR ${CMAKE_CURRENT_LIST_DIR}/../.. ABSOLUTE)
+
+set(RESULTS ${BUILD_ROOT}/results.jsonl)
+file(WRITE ${RESULTS} "")
+foreach(QueueSize ${QUEUE_SIZES})
+    foreach(IdleMs ${IDLE_MS})
+        set(BuildDir ${BUILD_ROOT}/queue_${QueueSize}_idle_${IdleMs})
+        execute_process(
+            COMMAND ${CMAKE_COMMAND} -S ${SOURCE_DIR} -B ${BuildDir}
+                    -DPFS_WITH_HOST=ON
+                    -DFREERTOS_KERNEL_PATH=${FREERTOS_KERNEL_PATH}
+                    -DPFS_MSG_QUEUE_SIZE=${QueueSize}
+                    -DPFS_MAIN_TASK_IDLE_MS=${IdleMs}
+            OUTPUT_QUIET
+            RESULT_VARIABLE Ret)
+        if(NOT Ret EQUAL 0)
+            message(FATAL_ERROR "configuring ${BuildDir} failed")
+        endif()
+        execute_process(
+            COMMAND ${CMAKE_COMMAND} --build ${BuildDir} --target load_test
+            OUTPUT_QUIET
+            RESULT_VARIABLE Ret)
+        if(NOT Ret EQUAL 0)
+            message(FATAL_ERROR "building ${BuildDir} failed")
+        endif()
+        execute_process(
+            COMMAND ${BuildDir}/host/load_test ${LOAD_TEST_ARGS}
+            OUTPUT_VARIABLE Output
+            OUTPUT_STRIP_TRAILING_WHITESPACE
+            RESULT_VARIABLE Ret)
+        if(NOT Ret EQUAL 0)
+            message(FATAL_ERROR "load test failed for queue size ${QueueSize}, idle ${IdleMs} ms")
+        endif()
+        # only the report, the shell may print more before it is initialized
+        string(REGEX MATCH "{\"producers\"[^\n]*" Result "${Output}")
+        message(STATUS "${Result}")
+        file(APPEND ${RESULTS} "${Result}\n")
+    endforeach()
+endforeach()
+message(STATUS "Results written to ${RESULTS}")
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <pico/stdlib.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <pico_freertos_shell/commands.h>
+#include <pico_freertos_shell/init.h>
+#include <pico_freertos_shell/transport_linux.h>
+
+#include "pfs_host_trace.h"
+
+// the complete shell running on the host, served on the terminal, a pty or a
+// Unix domain socket, optionally recording the input as a trace
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+static void echo_cmd_handler(int argc, char **argv) {
+    for (int i = 0; i < argc; i++) {
+        printf("%s%s", argv[i], i + 1 < argc ? " " : "\n");
+    }
+}
+
+static void exit_cmd_handler(int argc, char **argv) {
+    (void) argc;
+    (void) argv;
+    exit(0);
+}
+
+static const pfs_command_t SHELL_COMMANDS[] = {
+        PFS_COMMAND_INITIALIZER(echo,
+                                "print the arguments",
+                                PFS_COMMAND_HANDLER(echo_cmd_handler)),
+        PFS_COMMAND_INITIALIZER(exit,
+                                "exit the process",
+                                PFS_COMMAND_HANDLER(exit_cmd_handler))};
+
+static pfs_linux_transport_t m_transport;
+static pfs_stdio_transport_t m_stdio_transport;
+static pfs_host_trace_transport_t m_trace_transport;
+
+static pfs_transport_t *open_transport(int argc, char **argv) {
+    if (argc == 0) {
+        // served on stdin/stdout, as the default session is
+        if (!stdio_init_all()) {
+            return NULL;
+        }
+        pfs_stdio_transport_init(&m_stdio_transport, NULL);
+        return &m_stdio_transport.base;
+    }
+    if (argc == 1 && strcmp(argv[0], "--pty") == 0) {
+        char name[64];
+        if (pfs_linux_transport_open_pty(&m_transport, name, sizeof(name))) {
+            return NULL;
+        }
+        printf("serving the shell on %s\n", name);
+        return &m_transport.base;
+    }
+    if (argc == 2 && strcmp(argv[0], "--socket") == 0) {
+        if (pfs_linux_transport_open_socket(&m_transport, argv[1])) {
+            return NULL;
+        }
+        printf("serving the shell on %s\n", argv[1]);
+        return &m_transport.base;
+    }
+    return NULL;
+}
+
+static int add_session(int argc, char **argv) {
+    const char *trace_path = NULL;
+    if (argc >= 3 && strcmp(argv[1], "--record") == 0) {
+        trace_path = argv[2];
+    }
+    int skipped = trace_path != NULL ? 3 : 1;
+    pfs_transport_t *transport = open_transport(argc - skipped, &argv[skipped]);
+    if (transport == NULL) {
+        fprintf(stderr, "usage: %s [--record TRACE] [--pty | --socket PATH]\n",
+                argv[0]);
+        return 1;
+    }
+    if (trace_path != NULL) {
+        if (pfs_host_trace_transport_init(&m_trace_transport, transport,
+                                          trace_path)) {
+            return 1;
+        }
+        transport = &m_trace_transport.base;
+    }
+    return pfs_session_add(transport);
+}
+
+int main(int argc, char **argv) {
+    if (add_session(argc, argv)) {
+        return 1;
+    }
+    if (pfs_commands_register(SHELL_COMMANDS, ARRAY_SIZE(SHELL_COMMANDS))) {
+        printf("Failed to register commands\n");
+    }
+    pfs_init();
+    vTaskStartScheduler();
+    return 0;
+}
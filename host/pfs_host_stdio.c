@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <poll.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <pico/printf.h>
+#include <pico/stdio/driver.h>
+#include <pico/stdlib.h>
+
+// host counterpart of the wrapped pico-sdk stdio (cmake_preinit/pico_stdio):
+// printf(), vprintf(), puts() and _write() are queued once the shell is
+// initialized, putchar() always writes directly
+
+void _pfs_append_queue(const char *buffer, uint32_t buffer_size);
+bool _pfs_is_initialized(void);
+
+int __real_vprintf(const char *format, va_list va);
+int __real_puts(const char *s);
+
+static struct termios m_original_attributes;
+
+static void host_out_chars(const char *buf, int len) {
+    fwrite(buf, 1, len, stdout);
+}
+
+static void host_out_flush(void) {
+    fflush(stdout);
+}
+
+static int host_in_chars(char *buf, int len) {
+    struct pollfd pfd = {.fd = STDIN_FILENO, .events = POLLIN};
+    if (poll(&pfd, 1, 0) <= 0 || !(pfd.revents & POLLIN)) {
+        return PICO_ERROR_TIMEOUT;
+    }
+    ssize_t ret = read(STDIN_FILENO, buf, len);
+    return ret > 0 ? (int) ret : PICO_ERROR_TIMEOUT;
+}
+
+struct stdio_driver stdio_host = {
+        .out_chars = host_out_chars,
+        .out_flush = host_out_flush,
+        .in_chars = host_in_chars,
+        // FreeRTOS must not be called from other threads, the input is polled
+        .set_chars_available_callback = NULL,
+        .next = NULL,
+};
+
+static void restore_terminal(void) {
+    tcsetattr(STDIN_FILENO, TCSANOW, &m_original_attributes);
+}
+
+bool stdio_init_all(void) {
+    if (!isatty(STDIN_FILENO)
+        || tcgetattr(STDIN_FILENO, &m_original_attributes) != 0) {
+        return true;
+    }
+    // the shell handles echo, line editing and ctrl+c itself, the output
+    // keeps the newline translation as pico-sdk stdio does
+    struct termios attributes = m_original_attributes;
+    attributes.c_iflag &= ~(ICRNL | IXON);
+    attributes.c_lflag &= ~(ICANON | ECHO | ISIG | IEXTEN);
+    attributes.c_cc[VMIN] = 1;
+    attributes.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSANOW, &attributes) == 0) {
+        atexit(restore_terminal);
+    }
+    return true;
+}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+    static char m_buffer[64];
+    static int m_len;
+    static int m_position;
+    if (m_position == m_len) {
+        m_position = 0;
+        m_len = stdio_host.in_chars(m_buffer, sizeof(m_buffer));
+        if (m_len <= 0 && timeout_us > 0) {
+            usleep(timeout_us);
+            m_len = stdio_host.in_chars(m_buffer, sizeof(m_buffer));
+        }
+        if (m_len <= 0) {
+            m_len = 0;
+            return PICO_ERROR_TIMEOUT;
+        }
+    }
+    return (uint8_t) m_buffer[m_position++];
+}
+
+void stdio_flush(void) {
+    stdio_host.out_flush();
+}
+
+void stdio_set_chars_available_callback(void (*fn)(void *), void *param) {
+    (void) fn;
+    (void) param;
+}
+
+uint64_t time_us_64(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000u + (uint64_t) now.tv_nsec / 1000u;
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t) time_us_64();
+}
+
+int vfctprintf(void (*out)(char character, void *arg),
+               void *arg,
+               const char *format,
+               va_list va) {
+    va_list copy;
+    va_copy(copy, va);
+    int len = vsnprintf(NULL, 0, format, copy);
+    va_end(copy);
+    char *buffer = len > 0 ? malloc((size_t) len + 1) : NULL;
+    if (buffer == NULL) {
+        return len;
+    }
+    vsnprintf(buffer, (size_t) len + 1, format, va);
+    for (int i = 0; i < len; i++) {
+        out(buffer[i], arg);
+    }
+    free(buffer);
+    return len;
+}
+
+int __wrap_vprintf(const char *format, va_list va) {
+    if (!_pfs_is_initialized()) {
+        return __real_vprintf(format, va);
+    }
+    char buffer[1024];
+    int ret = vsnprintf(buffer, sizeof(buffer), format, va);
+    if (ret > 0) {
+        size_t len = (size_t) ret < sizeof(buffer) ? (size_t) ret
+                                                   : sizeof(buffer) - 1;
+        _pfs_append_queue(buffer, len);
+    }
+    return ret;
+}
+
+int __wrap_printf(const char *format, ...) {
+    va_list va;
+    va_start(va, format);
+    int ret = __wrap_vprintf(format, va);
+    va_end(va);
+    return ret;
+}
+
+int __wrap_puts(const char *s) {
+    if (!_pfs_is_initialized()) {
+        return __real_puts(s);
+    }
+    int len = (int) strlen(s);
+    _pfs_append_queue(s, len);
+    _pfs_append_queue("\n", 1);
+    return len;
+}
+
+// newlib routes stdout of the target through _write(), glibc does not, but
+// host code may call it directly to exercise the same path
+int _write(int handle, char *buffer, int length) {
+    if (handle != STDOUT_FILENO && handle != STDERR_FILENO) {
+        return -1;
+    }
+    if (!_pfs_is_initialized()) {
+        return (int) fwrite(buffer, 1, length, stdout);
+    }
+    _pfs_append_queue(buffer, length);
+    return length;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+
+#include <pico/stdlib.h>
+
+#include "pfs_host_trace.h"
+
+static pfs_transport_t *get_inner(pfs_transport_t *transport) {
+    return ((pfs_host_trace_transport_t *) transport)->transport;
+}
+
+static int trace_write(pfs_transport_t *transport,
+                       const char *data,
+                       size_t len,
+                       pfs_transport_write_done_t done,
+                       void *arg) {
+    pfs_transport_t *inner = get_inner(transport);
+    return inner->vtable->write(inner, data, len, done, arg);
+}
+
+static size_t trace_read(pfs_transport_t *transport,
+                         char *buffer,
+                         size_t size) {
+    pfs_host_trace_transport_t *trace =
+            (pfs_host_trace_transport_t *) transport;
+    size_t len = trace->transport->vtable->read(trace->transport, buffer, size);
+    if (len == 0) {
+        return 0;
+    }
+    uint64_t now = time_us_64();
+    fprintf(trace->file, "%llu ", (unsigned long long) (now - trace->last_us));
+    for (size_t i = 0; i < len; i++) {
+        fprintf(trace->file, "%02x", (unsigned char) buffer[i]);
+    }
+    fputc('\n', trace->file);
+    // the shell may be left with exit or ctrl+c of the host terminal
+    fflush(trace->file);
+    trace->last_us = now;
+    return len;
+}
+
+static void trace_flush(pfs_transport_t *transport) {
+    pfs_transport_t *inner = get_inner(transport);
+    inner->vtable->flush(inner);
+}
+
+static void trace_set_rx_callback(pfs_transport_t *transport,
+                                  pfs_transport_rx_callback_t callback,
+                                  void *arg) {
+    pfs_transport_t *inner = get_inner(transport);
+    if (inner->vtable->set_rx_callback != NULL) {
+        inner->vtable->set_rx_callback(inner, callback, arg);
+    }
+}
+
+static bool trace_is_connected(pfs_transport_t *transport) {
+    pfs_transport_t *inner = get_inner(transport);
+    return inner->vtable->is_connected == NULL
+           || inner->vtable->is_connected(inner);
+}
+
+static const pfs_transport_vtable_t TRACE_TRANSPORT_VTABLE = {
+        .write = trace_write,
+        .read = trace_read,
+        .flush = trace_flush,
+        .set_rx_callback = trace_set_rx_callback,
+        .is_connected = trace_is_connected,
+};
+
+int pfs_host_trace_transport_init(pfs_host_trace_transport_t *trace,
+                                  pfs_transport_t *transport,
+                                  const char *path) {
+    trace->file = fopen(path, "w");
+    if (trace->file == NULL) {
+        perror(path);
+        return 1;
+    }
+    fprintf(trace->file, "# pfs input trace v1\n");
+    trace->base.vtable = &TRACE_TRANSPORT_VTABLE;
+    trace->transport = transport;
+    trace->last_us = time_us_64();
+    return 0;
+}
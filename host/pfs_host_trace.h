@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <pico_freertos_shell/transport.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+/**
+ * Transport recording the input of another one as a trace, replayed by
+ * tests/replay/trace_replay.c. Every read chunk is a line with the
+ * microseconds since the previous chunk and the bytes as hex.
+ */
+typedef struct {
+    pfs_transport_t base;
+    pfs_transport_t *transport;
+    FILE *file;
+    uint64_t last_us;
+} pfs_host_trace_transport_t;
+
+/**
+ * @brief Records the input of @p transport into the file at @p path.
+ *
+ * @return 0 on success, 1 if the file cannot be created.
+ */
+int pfs_host_trace_transport_init(pfs_host_trace_transport_t *trace,
+                                  pfs_transport_t *transport,
+                                  const char *path);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <pfs_output_sequence.h>
+
+// checks output captured from a shell built with PFS_WITH_OUTPUT_SEQUENCE:
+//
+//   pfs_seq_check [CAPTURE]
+//
+// reads the capture (stdin by default), reports every gap and every message
+// out of order per producer and a summary line. Exits with 1 if any message
+// was lost, out of order or its prefix malformed. The first message of every
+// producer is taken as its start, as the capture may begin at any time.
+
+#define MAX_PRODUCERS (256U)
+// a sequence number this far behind the expected one is late, not ahead
+#define REORDER_WINDOW (0x8000U)
+
+typedef struct {
+    bool seen;
+    uint16_t expected;
+    size_t records;
+} producer_t;
+
+static producer_t m_producers[MAX_PRODUCERS];
+
+static struct {
+    size_t records;
+    size_t producers;
+    size_t lost;
+    size_t out_of_order;
+    size_t malformed;
+} m_summary;
+
+static void check_record(uint8_t id, uint16_t sequence, long offset) {
+    producer_t *producer = &m_producers[id];
+    m_summary.records++;
+    producer->records++;
+    if (!producer->seen) {
+        producer->seen = true;
+        producer->expected = (uint16_t) (sequence + 1);
+        m_summary.producers++;
+        return;
+    }
+    uint16_t distance = (uint16_t) (sequence - producer->expected);
+    if (distance == 0) {
+        producer->expected++;
+    } else if (distance < REORDER_WINDOW) {
+        printf("producer %02x: lost %u message(s) %04x..%04x before byte %ld\n",
+               id, (unsigned) distance, (unsigned) producer->expected,
+               (unsigned) (uint16_t) (sequence - 1), offset);
+        m_summary.lost += distance;
+        producer->expected = (uint16_t) (sequence + 1);
+    } else {
+        printf("producer %02x: %04x out of order (expected %04x) at byte %ld\n",
+               id, (unsigned) sequence, (unsigned) producer->expected, offset);
+        m_summary.out_of_order++;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 2 || (argc == 2 && argv[1][0] == '-')) {
+        fprintf(stderr, "usage: %s [CAPTURE]\n", argv[0]);
+        return 2;
+    }
+    FILE *capture = stdin;
+    if (argc == 2) {
+        capture = fopen(argv[1], "rb");
+        if (capture == NULL) {
+            perror(argv[1]);
+            return 2;
+        }
+    }
+
+    long offset = 0;
+    int c;
+    while ((c = getc(capture)) != EOF) {
+        offset++;
+        if (c != PFS_OUTPUT_SEQUENCE_MARK) {
+            continue;
+        }
+        long record_offset = offset - 1;
+        char prefix[PFS_OUTPUT_SEQUENCE_PREFIX_LEN] = {
+                PFS_OUTPUT_SEQUENCE_MARK};
+        size_t len = 1;
+        while (len < sizeof(prefix) && (c = getc(capture)) != EOF) {
+            offset++;
+            prefix[len++] = (char) c;
+        }
+        uint8_t producer;
+        uint16_t sequence;
+        if (len < sizeof(prefix)
+            || pfs_output_sequence_parse(prefix, &producer, &sequence)) {
+            printf("malformed prefix at byte %ld\n", record_offset);
+            m_summary.malformed++;
+            continue;
+        }
+        check_record(producer, sequence, record_offset);
+    }
+    if (capture != stdin) {
+        fclose(capture);
+    }
+
+    for (size_t i = 0; i < MAX_PRODUCERS; i++) {
+        if (m_producers[i].seen) {
+            printf("producer %02x: %zu message(s)\n", (unsigned) i,
+                   m_producers[i].records);
+        }
+    }
+    printf("records %zu, producers %zu, lost %zu, out of order %zu, "
+           "malformed %zu\n",
+           m_summary.records, m_summary.producers, m_summary.lost,
+           m_summary.out_of_order, m_summary.malformed);
+    return m_summary.lost || m_summary.out_of_order || m_summary.malformed;
+}
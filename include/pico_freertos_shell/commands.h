@@ -42,6 +42,33 @@ extern "C" {
  */
 typedef void (*pfs_command_handler_t)(int argc, char **argv);
 
+/**
+ * @brief Buffer for argument completion candidates. Use
+ *        `pfs_completion_add_candidate()` to fill it.
+ */
+typedef struct {
+    char *buffer;
+    size_t size;
+    size_t len;
+} pfs_completion_candidates_t;
+
+/**
+ * @brief Argument completion function type. Called when the user presses TAB
+ *        while typing an argument of a command.
+ *
+ * @param argc       Number of arguments preceding the one being completed.
+ * @param argv       Array of null-terminated arguments preceding the one being
+ *                   completed.
+ * @param candidates Buffer the candidates should be added to.
+ *
+ * @note Candidates are cached, so the function is not called again for the
+ *       same command and preceding arguments until
+ *       `pfs_completion_invalidate()` is called.
+ */
+typedef void (*pfs_command_completion_t)(int argc,
+                                         char **argv,
+                                         pfs_completion_candidates_t *candidates);
+
 typedef struct {
     const char *name;
     const char *help;
@@ -59,6 +86,7 @@ typedef struct pfs_command {
     const size_t number_of_subcommands;
     const struct pfs_command *subcommands;
     pfs_command_handler_t handler;
+    pfs_command_completion_t completion;
  } pfs_command_t;
 
 /**
@@ -67,7 +95,18 @@ typedef struct pfs_command {
  *
  * @param Handler Command handler function. Must not be NULL.
  */
-#define PFS_COMMAND_HANDLER(Handler) Handler, NULL, 0
+#define PFS_COMMAND_HANDLER(Handler) Handler, NULL, 0, NULL
+
+/**
+ * @brief Command handler initialization macro with argument completion. Use
+ *        this macro instead of `PFS_COMMAND_HANDLER` if the command arguments
+ *        should be completed with TAB.
+ *
+ * @param Handler    Command handler function. Must not be NULL.
+ * @param Completion Argument completion function. Must not be NULL.
+ */
+#define PFS_COMMAND_HANDLER_WITH_COMPLETION(Handler, Completion) \
+    Handler, NULL, 0, Completion
 
 /**
  * @brief Subcommands initialization macro. Use this macro to attach subcommands
@@ -76,12 +115,15 @@ typedef struct pfs_command {
  * @param Subcommands Array of subcommands. Must not be NULL.
  * @param Size        Number of subcommands.
  */
-#define PFS_SUBCOMMANDS(Subcommands, Size) NULL, Subcommands, Size
+#define PFS_SUBCOMMANDS(Subcommands, Size) NULL, Subcommands, Size, NULL
 
-#define _PFS_COMMAND_DEFINE(Name, Help, Handler, Subcommands, Number)     \
+// the trailing arguments make the completion optional when no macro is used
+#define _PFS_COMMAND_DEFINE(Name, Help, Handler, Subcommands, Number,    \
+                            Completion, ...)                              \
     {                                                                     \
         .description = {.name = #Name, .help = Help}, .handler = Handler, \
-        .subcommands = Subcommands, .number_of_subcommands = Number       \
+        .subcommands = Subcommands, .number_of_subcommands = Number,      \
+        .completion = Completion                                          \
     }
 
 /**
@@ -93,12 +135,13 @@ typedef struct pfs_command {
  * @param ...  Command handler or subcommands. If the command has subcommands
  *             (doesn't have a handler), the `PFS_SUBCOMMANDS` macro must be
  *             used. If the command has a handler (does not have subcommands),
- *             the `PFS_COMMAND_HANDLER` macro must be used. If no macro is
- *             used, user should make sure that the command does not have both
- *             handler and subcommands.
+ *             the `PFS_COMMAND_HANDLER` or
+ *             `PFS_COMMAND_HANDLER_WITH_COMPLETION` macro must be used. If no
+ *             macro is used, user should make sure that the command does not
+ *             have both handler and subcommands.
  */
 #define PFS_COMMAND_INITIALIZER(Name, Help, ...) \
-    _PFS_COMMAND_DEFINE(Name, Help, __VA_ARGS__)
+    _PFS_COMMAND_DEFINE(Name, Help, __VA_ARGS__, NULL, NULL)
 
 /**
  * @brief Registers commands in the shell.
@@ -111,11 +154,88 @@ typedef struct pfs_command {
  *         An error message will be printed to the standard output (if any).
  *
  * @note This function must be called before the shell is initialized using
- *       `pfs_init()`, otherwise will return an error.
+ *       `pfs_init()`, otherwise will return an error. Use `pfs_commands_add()`
+ *       to register commands at runtime.
  */
 int pfs_commands_register(const pfs_command_t commands[],
                           size_t number_of_commands);
 
+/**
+ * @brief Checks a command tree without registering it.
+ *
+ * @param commands           Array of commands to check. Must not be NULL.
+ * @param number_of_commands Number of commands in the array.
+ *
+ * @return 0 if the commands are valid and could be registered,
+ *         non-zero otherwise.
+ *         An error message will be printed for every problem found.
+ *
+ * @note Names clashing with the already registered commands are not checked.
+ */
+int pfs_commands_validate(const pfs_command_t commands[],
+                          size_t number_of_commands);
+
+/**
+ * @brief Adds commands to the shell. Can be called at any time and from any
+ *        task, also after `pfs_init()`.
+ *
+ * @param commands           Array of commands to add. Must not be NULL. The
+ *                           array must stay valid until it is removed using
+ *                           `pfs_commands_remove()`.
+ * @param number_of_commands Number of commands in the array.
+ *
+ * @return 0 on success,
+ *         non-zero on failure (e.g. invalid commands or a command with the same
+ *         name already registered).
+ *         An error message will be printed to the standard output (if any).
+ *
+ * @note Keystroke processing is never blocked by this function. The command
+ *       list is swapped atomically and the shell task sees either the old or
+ *       the new list.
+ */
+int pfs_commands_add(const pfs_command_t commands[],
+                     size_t number_of_commands);
+
+/**
+ * @brief Removes commands previously registered using `pfs_commands_add()` or
+ *        `pfs_commands_register()`.
+ *
+ * @param commands           The same array that was passed when registering.
+ * @param number_of_commands Number of commands in the array.
+ *
+ * @return 0 on success,
+ *         non-zero on failure (e.g. the commands are not registered).
+ *         An error message will be printed to the standard output (if any).
+ *
+ * @note When this function returns, the shell tasks no longer reference the
+ *       removed commands: the commands dispatched before have finished and
+ *       their profiles (see `cmdstats`) are dropped, so the array may be freed
+ *       or reused. Called from a command handler, the function can't wait for
+ *       that handler, so its own array must stay valid until it returns.
+ */
+int pfs_commands_remove(const pfs_command_t commands[],
+                        size_t number_of_commands);
+
+/**
+ * @brief Adds an argument completion candidate. Meant to be called from the
+ *        command's completion function.
+ *
+ * @param candidates Buffer passed to the completion function.
+ * @param candidate  Null-terminated candidate. Should not contain spaces.
+ *
+ * @return 0 on success,
+ *         non-zero if the buffer is full (the candidate is not added).
+ */
+int pfs_completion_add_candidate(pfs_completion_candidates_t *candidates,
+                                 const char *candidate);
+
+/**
+ * @brief Invalidates all cached argument completion candidates. Call this
+ *        function when the set of values a completion function yields changes
+ *        (e.g. a device was connected). Can be called from any task.
+ */
+void pfs_completion_invalidate(void);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
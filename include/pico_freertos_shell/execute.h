@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <FreeRTOS.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#define PFS_EXECUTE_OK 0
+// invalid input or command not found, the reason is in the output
+#define PFS_EXECUTE_FAILED 1
+// the command did not finish in time, the rest of its output is discarded
+#define PFS_EXECUTE_TIMEOUT 2
+// the shell is not initialized, the caller is a shell task, or a command that
+// timed out before is still being executed
+#define PFS_EXECUTE_BUSY 3
+
+typedef void (*pfs_output_callback_t)(const char *data, size_t len, void *arg);
+
+/**
+ * Receives the output of a command run with `pfs_execute()`.
+ */
+typedef struct {
+    // if set, called by the shell task with every chunk of output
+    pfs_output_callback_t callback;
+    void *arg;
+    // otherwise the output is stored here, NUL-terminated
+    char *buffer;
+    size_t size;
+    // set by pfs_execute()
+    size_t len;
+    bool truncated;
+} pfs_output_sink_t;
+
+/**
+ * @brief Runs a command line as if it was typed, built-in commands and pipes
+ *        included, and waits until it finishes. Its output (shell messages
+ *        included) is given to @p sink instead of the terminals. May be
+ *        called from any task but the shell ones, calls are serialized.
+ *
+ * @param line    command line, at most `PFS_MAX_INPUT_SIZE - 1` characters
+ * @param sink    receives the output, NULL discards it
+ * @param timeout ticks to wait for the command (and other callers) for
+ *
+ * @return `PFS_EXECUTE_OK` or one of the `PFS_EXECUTE_*` errors
+ */
+int pfs_execute(const char *line, pfs_output_sink_t *sink, TickType_t timeout);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
@@ -33,6 +33,22 @@ extern "C" {
  */
 void pfs_init(void);
 
+struct pfs_transport;
+
+/**
+ * @brief Adds a shell session served on a transport, e.g. a single stdio
+ *        driver (see `pfs_stdio_transport_init()`) or a Linux pty/Unix socket
+ *        (see `transport_linux.h`). Each session has its own input line,
+ *        command history and output queue. Command output is printed by the
+ *        session the command was issued from only, any other output is printed
+ *        by all sessions. Must be called before `pfs_init()`, at most
+ *        `PFS_MAX_SESSIONS` times. The transport must stay valid afterwards.
+ *        If no session is added, a single session served on all enabled stdio
+ *        drivers is created.
+ * @return 0 on success, non-zero otherwise.
+ */
+int pfs_session_add(struct pfs_transport *transport);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
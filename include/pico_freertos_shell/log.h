@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#define PFS_LOG_LEVEL_OFF 0
+#define PFS_LOG_LEVEL_ERR 1
+#define PFS_LOG_LEVEL_WRN 2
+#define PFS_LOG_LEVEL_INF 3
+#define PFS_LOG_LEVEL_DBG 4
+
+/**
+ * @brief Most verbose level compiled in, `PFS_LOG()` calls above it are
+ *        stripped entirely. Set with the `PFS_LOG_LEVEL_MAX` CMake option.
+ */
+#ifndef PFS_LOG_LEVEL_MAX
+#define PFS_LOG_LEVEL_MAX PFS_LOG_LEVEL_DBG
+#endif // PFS_LOG_LEVEL_MAX
+
+/**
+ * @brief Log module, i.e. a tag with its own runtime threshold.
+ *
+ * @note This structure is not meant to be initialized directly. Use the
+ *       `PFS_LOG_MODULE_DEFINE` macro instead.
+ */
+typedef struct pfs_log_module {
+    const char *name;
+    // messages above the level are discarded, changed by the `loglevel`
+    // command
+    uint8_t level;
+    struct pfs_log_module *next;
+} pfs_log_module_t;
+
+/**
+ * @brief Defines a log module.
+ *
+ * @param Name  Module name. Must not be a string and can't be empty.
+ * @param Level Initial threshold: `OFF`, `ERR`, `WRN`, `INF` or `DBG`.
+ */
+#define PFS_LOG_MODULE_DEFINE(Name, Level)             \
+    pfs_log_module_t pfs_log_module_##Name = {         \
+            .name = #Name,                             \
+            .level = PFS_LOG_LEVEL_##Level,            \
+            .next = NULL,                              \
+    }
+
+/**
+ * @brief Declares a log module defined in another file.
+ */
+#define PFS_LOG_MODULE_DECLARE(Name) \
+    extern pfs_log_module_t pfs_log_module_##Name
+
+/**
+ * @brief Pointer to a log module, e.g. for `pfs_log_module_register()`.
+ */
+#define PFS_LOG_MODULE(Name) (&pfs_log_module_##Name)
+
+/**
+ * @brief Logs a message of a module, printed as `<LEVEL> <module>: <message>`.
+ *
+ * @param Module Module name (see `PFS_LOG_MODULE_DEFINE`).
+ * @param Level  `ERR`, `WRN`, `INF` or `DBG`.
+ * @param ...    printf-like format and arguments.
+ *
+ * @note The threshold is checked before the arguments are evaluated, so a
+ *       disabled message costs a load and a branch only. Messages above
+ *       `PFS_LOG_LEVEL_MAX` are not compiled in at all.
+ */
+#define PFS_LOG(Module, Level, ...)                                        \
+    do {                                                                   \
+        if (PFS_LOG_LEVEL_##Level <= PFS_LOG_LEVEL_MAX                     \
+            && PFS_LOG_LEVEL_##Level <= pfs_log_module_##Module.level) {   \
+            pfs_log(&pfs_log_module_##Module, PFS_LOG_LEVEL_##Level,       \
+                    __VA_ARGS__);                                          \
+        }                                                                  \
+    } while (0)
+
+/**
+ * @brief Registers a log module, so its threshold can be changed with the
+ *        `loglevel` command. May be called at any time and from any task,
+ *        registering a module again has no effect.
+ *
+ * @param module Module to register. Must not be NULL.
+ *
+ * @return 0 on success,
+ *         non-zero on failure (e.g. another module has the same name).
+ */
+int pfs_log_module_register(pfs_log_module_t *module);
+
+/**
+ * @brief Formats and queues a single log message. Use `PFS_LOG()` instead,
+ *        this function does not check the threshold.
+ */
+void __attribute__((format(printf, 3, 4)))
+pfs_log(const pfs_log_module_t *module, uint8_t level, const char *format, ...);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
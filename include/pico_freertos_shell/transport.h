@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+struct pfs_transport;
+
+typedef void (*pfs_transport_write_done_t)(void *arg);
+typedef void (*pfs_transport_rx_callback_t)(void *arg);
+
+/**
+ * Byte stream a shell session is served on. All functions are called by the
+ * shell tasks only.
+ */
+typedef struct {
+    // starts writing `len` bytes; `done` is called (from a task, possibly
+    // before returning) once `data` is no longer referenced; if `done` is NULL,
+    // `data` is consumed before returning
+    int (*write)(struct pfs_transport *transport,
+                 const char *data,
+                 size_t len,
+                 pfs_transport_write_done_t done,
+                 void *arg);
+    // reads up to `size` already available bytes, never blocks
+    size_t (*read)(struct pfs_transport *transport, char *buffer, size_t size);
+    // waits until all written bytes are sent
+    void (*flush)(struct pfs_transport *transport);
+    // optional, `callback` may be called from an interrupt when input arrives;
+    // transports without it are polled
+    void (*set_rx_callback)(struct pfs_transport *transport,
+                            pfs_transport_rx_callback_t callback,
+                            void *arg);
+    // optional, transports without it are always connected; nothing is
+    // written to a disconnected transport, its output is discarded
+    bool (*is_connected)(struct pfs_transport *transport);
+} pfs_transport_vtable_t;
+
+/**
+ * Base of all transports, must be the first member of an implementation.
+ */
+typedef struct pfs_transport {
+    const pfs_transport_vtable_t *vtable;
+} pfs_transport_t;
+
+struct stdio_driver;
+
+/**
+ * pico-sdk stdio transport. A NULL driver means all enabled stdio drivers.
+ */
+typedef struct {
+    pfs_transport_t base;
+    struct stdio_driver *driver;
+} pfs_stdio_transport_t;
+
+/**
+ * @brief Initializes a transport served on a single stdio driver (e.g.
+ *        `&stdio_uart` or `&stdio_usb`), or on all of them if NULL.
+ */
+void pfs_stdio_transport_init(pfs_stdio_transport_t *transport,
+                              struct stdio_driver *driver);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
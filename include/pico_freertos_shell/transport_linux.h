@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#include <pico_freertos_shell/transport.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+/**
+ * Linux transport backed by a pseudo terminal or a Unix domain socket, used to
+ * drive the shell from host scripts. Writes complete before returning, input
+ * is polled (there is no rx callback).
+ */
+typedef struct {
+    pfs_transport_t base;
+    // pty master or connected socket client, -1 if there is none
+    int fd;
+    // listening socket, -1 for a pty
+    int listen_fd;
+} pfs_linux_transport_t;
+
+/**
+ * @brief Opens a pseudo terminal in raw mode. The path of its slave side (to
+ *        be opened with e.g. `picocom` or `socat`) is written to `out_name`.
+ * @return 0 on success, non-zero otherwise.
+ */
+int pfs_linux_transport_open_pty(pfs_linux_transport_t *transport,
+                                 char *out_name,
+                                 size_t name_size);
+
+/**
+ * @brief Listens on a Unix domain socket at `path`. A single client is served
+ *        at a time, the next one is accepted after it disconnects. Output is
+ *        dropped while no client is connected.
+ * @return 0 on success, non-zero otherwise.
+ */
+int pfs_linux_transport_open_socket(pfs_linux_transport_t *transport,
+                                    const char *path);
+
+void pfs_linux_transport_close(pfs_linux_transport_t *transport);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
@@ -28,190 +28,226 @@
 #include <string.h>
 
 #include "pfs_autocompletion.h"
+#include "pfs_command_index.h"
 #include "pfs_escape_sequences.h"
 #include "pfs_handle_shell_input.h"
 #include "pfs_io.h"
 
-static size_t find_smallest_command_name_len(const pfs_command_t *commands,
-                                             size_t number_of_commands) {
-    if (number_of_commands == 0) {
-        return 0;
+// number of commands whose argument candidates are cached at the same time
+#define PFS_COMPLETION_CACHE_ENTRIES 2
+
+typedef struct {
+    const pfs_command_t *command;
+    uint32_t generation;
+    // the hash rejects most misses quickly, a hit is confirmed with the text
+    uint32_t arguments_hash;
+    size_t arguments_len;
+    char arguments[PFS_MAX_INPUT_SIZE];
+    size_t len;
+    char candidates[PFS_COMPLETION_CACHE_SIZE];
+} completion_cache_entry_t;
+
+// the cache is accessed by the shell task only, other tasks just bump the
+// generation; a lost increment still invalidates the cache
+static completion_cache_entry_t m_completion_cache[PFS_COMPLETION_CACHE_ENTRIES];
+static size_t m_completion_cache_next;
+static volatile uint32_t m_completion_generation = 1;
+
+int pfs_completion_add_candidate(pfs_completion_candidates_t *candidates,
+                                 const char *candidate) {
+    if (candidates == NULL || candidate == NULL) {
+        return 1;
     }
-    size_t smallest_len = strlen(commands[0].description.name);
-    for (size_t i = 1; i < number_of_commands; i++) {
-        if (strlen(commands[i].description.name) < smallest_len) {
-            smallest_len = strlen(commands[i].description.name);
-        }
+
+    size_t candidate_size = strlen(candidate) + 1;
+    if (candidate_size > candidates->size - candidates->len) {
+        return 1;
     }
+    memcpy(candidates->buffer + candidates->len, candidate, candidate_size);
+    candidates->len += candidate_size;
+    return 0;
+}
+
+void pfs_completion_invalidate(void) {
+    m_completion_generation++;
+}
 
-    return smallest_len;
+static void print_list_begin(void) {
+    pfs_io_printf_immediately(
+            "\n" PFS_IO_SHELL_MESSAGE_INF_BEGIN PFS_IO_BOLD_ON);
 }
 
-static const pfs_command_t *
-find_commands_by_substring_dynamic(const pfs_command_t *commands,
-                                   size_t number_of_commands,
-                                   const char *substring,
-                                   size_t *out_len) {
+static void print_list_end(void) {
+    pfs_io_printf_immediately(PFS_IO_BOLD_OFF "\n");
+    pfs_io_restore_shell_prompt();
+}
+
+static void print_all_commands(const pfs_command_index_node_t *nodes,
+                               size_t number_of_nodes) {
+    print_list_begin();
+    for (size_t i = 0; i < number_of_nodes; i++) {
+        pfs_io_printf_immediately("%s" PFS_IO_TAB,
+                                  nodes[i].command->description.name);
+    }
+    print_list_end();
+}
+
+static size_t common_prefix_len(const char *s1, const char *s2) {
     size_t len = 0;
-    for (size_t i = 0; i < number_of_commands; i++) {
-        if (strstr(commands[i].description.name, substring)
-            == commands[i].description.name) {
-            len++;
-        }
+    while (s1[len] != '\0' && s1[len] == s2[len]) {
+        len++;
     }
+    return len;
+}
 
+static void complete_prefix(const pfs_command_index_node_t *nodes,
+                            size_t number_of_nodes,
+                            const char *prefix,
+                            size_t prefix_len) {
+    const pfs_command_index_node_t *first;
+    size_t len = pfs_command_index_find_prefix(nodes, number_of_nodes, prefix,
+                                               prefix_len, &first);
     if (len == 0) {
-        *out_len = 0;
-        return NULL;
+        return;
     }
 
-    pfs_command_t *filtered_commands =
-            (pfs_command_t *) malloc(len * sizeof(pfs_command_t));
-    if (filtered_commands == NULL) {
-        *out_len = 0;
-        return NULL;
+    const char *first_name = first->command->description.name;
+    if (len == 1) {
+        char completion[PFS_MAX_INPUT_SIZE];
+        snprintf(completion, sizeof(completion), "%s ",
+                 first_name + prefix_len);
+        pfs_io_insert_text(completion, strlen(completion));
+        return;
     }
 
-    size_t j = 0;
-    for (size_t i = 0; i < number_of_commands; i++) {
-        if (strstr(commands[i].description.name, substring)
-            == commands[i].description.name) {
-            memcpy(&filtered_commands[j], &commands[i], sizeof(pfs_command_t));
-            j++;
-        }
+    // names are sorted, so the first and the last one differ the most
+    size_t common_len = common_prefix_len(
+            first_name, first[len - 1].command->description.name);
+    if (common_len == prefix_len) {
+        print_all_commands(first, len);
+        return;
     }
-
-    *out_len = len;
-    return filtered_commands;
+    pfs_io_insert_text(first_name + prefix_len, common_len - prefix_len);
 }
 
-static int input_buffer_ends_with_space(pfs_input_buffer_t *input_buffer) {
-    if (input_buffer->len == 0) {
-        return 0;
+static uint32_t hash_arguments(const char *arguments, size_t len) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t) arguments[i];
+        hash *= 16777619u;
     }
-
-    return input_buffer->buffer[input_buffer->len - 1] == ' ';
+    return hash;
 }
 
-static void find_commands_common_string(const pfs_command_t *commands,
-                                        size_t number_of_commands,
-                                        char *out_buffer) {
-    memset(out_buffer, 0, PFS_MAX_INPUT_SIZE);
-    if (number_of_commands == 0 || commands == NULL) {
-        return;
-    }
-    size_t shortest_substring_len =
-            find_smallest_command_name_len(commands, number_of_commands);
-    bool should_break = false;
-    size_t smallest_len = 0;
-    for (size_t i = 0; i < shortest_substring_len; i++) {
-        for (size_t j = 0; j < number_of_commands; j++) {
-            if (commands[j].description.name[i]
-                != commands[0].description.name[i]) {
-                should_break = true;
-                break;
-            }
+static const completion_cache_entry_t *
+get_candidates(const pfs_command_t *command,
+               const char *arguments,
+               size_t arguments_len) {
+    uint32_t generation = m_completion_generation;
+    uint32_t arguments_hash = hash_arguments(arguments, arguments_len);
+    for (size_t i = 0; i < PFS_COMPLETION_CACHE_ENTRIES; i++) {
+        const completion_cache_entry_t *entry = &m_completion_cache[i];
+        if (entry->command == command && entry->generation == generation
+            && entry->arguments_hash == arguments_hash
+            && entry->arguments_len == arguments_len
+            && memcmp(entry->arguments, arguments, arguments_len) == 0) {
+            return entry;
         }
-        if (should_break) {
-            break;
-        }
-        smallest_len++;
     }
-    memcpy(out_buffer, commands[0].description.name, smallest_len);
-}
 
-static void print_command_name_and_space(const pfs_command_t *command,
-                                         int argc,
-                                         char *argv[],
-                                         bool ends_with_space,
-                                         pfs_input_buffer_t *input_buffer) {
-    int beginning = (argc == 0 || ends_with_space) ? 0 : strlen(argv[argc - 1]);
-    for (size_t i = beginning; i < strlen(command->description.name); i++) {
-        pfs_io_handle_input_char(command->description.name[i]);
+    char buffer[PFS_MAX_INPUT_SIZE];
+    memcpy(buffer, arguments, arguments_len);
+    buffer[arguments_len] = '\0';
+    char *argv[PFS_MAX_ARGC];
+    int argc;
+    if (pfs_custom_tokenizer(buffer, argv, PFS_MAX_ARGC, &argc)) {
+        return NULL;
     }
-    pfs_io_handle_input_char(' ');
+
+    completion_cache_entry_t *entry =
+            &m_completion_cache[m_completion_cache_next];
+    m_completion_cache_next =
+            (m_completion_cache_next + 1) % PFS_COMPLETION_CACHE_ENTRIES;
+
+    pfs_completion_candidates_t candidates = {
+        .buffer = entry->candidates,
+        .size = sizeof(entry->candidates),
+        .len = 0,
+    };
+    command->completion(argc, argv, &candidates);
+
+    entry->command = command;
+    entry->generation = generation;
+    entry->arguments_hash = arguments_hash;
+    entry->arguments_len = arguments_len;
+    memcpy(entry->arguments, arguments, arguments_len);
+    entry->len = candidates.len;
+    return entry;
 }
 
-static void print_all_commands(const pfs_command_t *commands,
-                               size_t number_of_commands) {
-    if (commands == NULL || number_of_commands == 0) {
+static void complete_argument(const pfs_command_t *command,
+                              const char *arguments,
+                              const char *end) {
+    if (command->completion == NULL) {
         return;
     }
-    pfs_io_printf_immediately(
-            "\n" PFS_IO_SHELL_MESSAGE_INF_BEGIN PFS_IO_BOLD_ON);
-    for (size_t i = 0; i < number_of_commands; i++) {
-        pfs_io_printf_immediately("%s" PFS_IO_TAB,
-                                  commands[i].description.name);
-    }
-    pfs_io_printf_immediately(PFS_IO_BOLD_OFF "\n");
-    pfs_io_restore_shell_prompt();
-}
 
-static void print_common_string(const char *common_string,
-                                int argc,
-                                char *argv[],
-                                bool ends_with_space,
-                                pfs_input_buffer_t *input_buffer) {
-    int beginning = (argc == 0 || ends_with_space) ? 0 : strlen(argv[argc - 1]);
-    for (size_t i = beginning; i < strlen(common_string); i++) {
-        pfs_io_handle_input_char(common_string[i]);
+    const char *prefix = end;
+    while (prefix > arguments && prefix[-1] != ' ') {
+        prefix--;
     }
-}
+    size_t prefix_len = end - prefix;
 
-static const pfs_command_t *
-find_latest_subcommand(const pfs_command_t *commands,
-                       size_t number_of_commands,
-                       int argc,
-                       char *argv[]) {
-    if (argc == 0) {
-        return commands;
-    }
-    const pfs_command_t *curr_command =
-            pfs_find_command_by_name(commands, argv[0], number_of_commands);
-    if (curr_command == NULL) {
-        return NULL;
+    const completion_cache_entry_t *entry =
+            get_candidates(command, arguments, prefix - arguments);
+    if (entry == NULL) {
+        return;
     }
-    for (int i = 1; i < argc; i++) {
-        if (!pfs_command_has_subcommands(curr_command)) {
-            return NULL;
+
+    // candidates are not sorted, so they all have to be checked
+    const char *candidates_end = entry->candidates + entry->len;
+    const char *first = NULL;
+    size_t matches = 0;
+    size_t common_len = 0;
+    for (const char *candidate = entry->candidates; candidate < candidates_end;
+         candidate += strlen(candidate) + 1) {
+        if (strncmp(candidate, prefix, prefix_len) != 0) {
+            continue;
         }
-        curr_command =
-                pfs_find_command_by_name(curr_command->subcommands, argv[i],
-                                         curr_command->number_of_subcommands);
-        if (curr_command == NULL) {
-            return NULL;
+        if (first == NULL) {
+            first = candidate;
+            common_len = strlen(candidate);
+        } else {
+            size_t len = common_prefix_len(first, candidate);
+            common_len = len < common_len ? len : common_len;
         }
+        matches++;
     }
 
-    return curr_command;
-}
-
-static void print_commands_or_common_string(const pfs_command_t *commands,
-                                            size_t number_of_commands,
-                                            int argc,
-                                            char *argv[],
-                                            bool ends_with_space,
-                                            pfs_input_buffer_t *input_buffer) {
-    if (commands == NULL || number_of_commands == 0) {
+    if (matches == 0) {
         return;
     }
 
-    char common_string[PFS_MAX_INPUT_SIZE] = {0};
-
-    if (number_of_commands == 1) {
-        print_command_name_and_space(&commands[0], argc, argv, ends_with_space,
-                                     input_buffer);
+    if (matches == 1) {
+        char completion[PFS_MAX_INPUT_SIZE];
+        snprintf(completion, sizeof(completion), "%s ", first + prefix_len);
+        pfs_io_insert_text(completion, strlen(completion));
         return;
     }
-    find_commands_common_string(commands, number_of_commands, common_string);
-    if (strlen(common_string) == 0
-        || (strlen(common_string) == strlen(argv[argc - 1])
-            && !ends_with_space)) {
-        print_all_commands(commands, number_of_commands);
+
+    if (common_len == prefix_len) {
+        print_list_begin();
+        for (const char *candidate = first; candidate < candidates_end;
+             candidate += strlen(candidate) + 1) {
+            if (strncmp(candidate, prefix, prefix_len) == 0) {
+                pfs_io_printf_immediately("%s" PFS_IO_TAB, candidate);
+            }
+        }
+        print_list_end();
         return;
     }
-    print_common_string(common_string, argc, argv, ends_with_space,
-                        input_buffer);
+    pfs_io_insert_text(first + prefix_len, common_len - prefix_len);
 }
 
 void pfs_autocompletion(pfs_input_buffer_t *input_buffer) {
@@ -219,71 +255,40 @@ void pfs_autocompletion(pfs_input_buffer_t *input_buffer) {
         return;
     }
 
-    char *argv[PFS_MAX_ARGC];
-    int argc = 0;
-    char buffer[PFS_MAX_INPUT_SIZE];
-    strncpy(buffer, input_buffer->buffer, PFS_MAX_INPUT_SIZE);
-    buffer[PFS_MAX_INPUT_SIZE - 1] = '\0';
-
-    if (pfs_custom_tokenizer(buffer, argv, PFS_MAX_ARGC, &argc)) {
-        return;
-    }
-
-    size_t number_of_core_commands;
-    const pfs_command_t *core_commands =
-            pfs_get_core_commands_sorted_by_name_dynamic(
-                    &number_of_core_commands);
+    // the snapshot stays valid until the shell task handles the next event
+    const pfs_command_index_t *index = pfs_command_index_get();
+    size_t number_of_nodes;
+    const pfs_command_index_node_t *nodes =
+            pfs_command_index_children(index, NULL, &number_of_nodes);
 
-    size_t number_of_commands = number_of_core_commands;
-    const pfs_command_t *commands = core_commands;
-
-    bool ends_with_space = input_buffer_ends_with_space(input_buffer);
-
-    if (argc == 0) {
-        print_commands_or_common_string(commands, number_of_commands, argc,
-                                        argv, ends_with_space, input_buffer);
-        goto on_exit;
-    }
-
-    if (ends_with_space) {
-        const pfs_command_t *curr_command =
-                find_latest_subcommand(commands, number_of_commands, argc,
-                                       argv);
-        if (curr_command == NULL) {
-            goto on_exit;
+    // walk the command tree along the complete words, the last (possibly
+    // empty) word is the one being completed
+    const char *current = input_buffer->buffer;
+    const char *end = input_buffer->buffer + input_buffer->len;
+    while (true) {
+        while (current < end && *current == ' ') {
+            current++;
         }
-        if (pfs_command_has_subcommands(curr_command)) {
-            commands = curr_command->subcommands;
-            number_of_commands = curr_command->number_of_subcommands;
-            print_commands_or_common_string(commands, number_of_commands, argc,
-                                            argv, ends_with_space,
-                                            input_buffer);
+        const char *word = current;
+        while (current < end && *current != ' ') {
+            current++;
         }
-        goto on_exit;
-    }
+        size_t word_len = current - word;
 
-    if (argc == 1) {
-        commands = find_commands_by_substring_dynamic(
-                commands, number_of_commands, argv[0], &number_of_commands);
-    } else {
-        const pfs_command_t *curr_command =
-                find_latest_subcommand(commands, number_of_commands, argc - 1,
-                                       argv);
-        if (curr_command == NULL) {
-            goto on_exit;
+        if (current == end) {
+            complete_prefix(nodes, number_of_nodes, word, word_len);
+            return;
         }
-        if (!pfs_command_has_subcommands(curr_command)) {
-            goto on_exit;
+
+        const pfs_command_index_node_t *node =
+                pfs_command_index_find(nodes, number_of_nodes, word, word_len);
+        if (node == NULL) {
+            return;
+        }
+        if (!pfs_command_has_subcommands(node->command)) {
+            complete_argument(node->command, current + 1, end);
+            return;
         }
-        commands = find_commands_by_substring_dynamic(
-                curr_command->subcommands, curr_command->number_of_subcommands,
-                argv[argc - 1], &number_of_commands);
+        nodes = pfs_command_index_children(index, node, &number_of_nodes);
     }
-
-    print_commands_or_common_string(commands, number_of_commands, argc, argv,
-                                    ends_with_space, input_buffer);
-    free((void *) commands);
-
-on_exit:
-    free((void *) core_commands);
 }
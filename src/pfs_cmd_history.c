@@ -21,6 +21,7 @@
  */
 
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 
 #include "pfs_cmd_history.h"
@@ -29,79 +30,320 @@
 
 #ifdef PFS_WITH_COMMAND_HISTORY
 
-static pfs_input_buffer_t m_cmd_history_buffers[PFS_COMMAND_HISTORY_SIZE + 1];
-static pfs_cmd_history_t m_cmd_history_buff = {
-        .data = m_cmd_history_buffers,
-        .head = 0,
-        .capacity = PFS_ARRAY_SIZE(m_cmd_history_buffers),
-        .occupancy = 0,
-};
-static size_t m_cmd_history_offset;
+#if PFS_MAX_INPUT_SIZE <= UINT8_MAX + 1
+typedef uint8_t entry_len_t;
+#else
+typedef uint16_t entry_len_t;
+#endif
 
-size_t *pfs_cmd_history_get_offset_ptr(void) {
-    return &m_cmd_history_offset;
+// the length is stored both before and after the text, so the entries can be
+// walked from the newest one as well
+#define ENTRY_OVERHEAD (2 * sizeof(entry_len_t))
+
+#ifdef PFS_WITH_COMMAND_HISTORY_STORAGE
+// compaction must always be able to store everything held in RAM
+_Static_assert(PFS_COMMAND_HISTORY_STORAGE_SIZE
+                       >= PFS_HISTORY_STORAGE_MAGIC_SIZE
+                                  + 2 * PFS_COMMAND_HISTORY_BYTES,
+               "PFS_COMMAND_HISTORY_STORAGE_SIZE is too small");
+#endif // PFS_WITH_COMMAND_HISTORY_STORAGE
+
+void pfs_cmd_history_init(pfs_cmd_history_t *cmd_buff,
+                          uint8_t *data,
+                          size_t capacity,
+                          size_t max_occupancy) {
+    memset(cmd_buff, 0, sizeof(*cmd_buff));
+    cmd_buff->data = data;
+    cmd_buff->capacity = capacity;
+    cmd_buff->max_occupancy = max_occupancy;
+}
+
+static void arena_write(pfs_cmd_history_t *cmd_buff,
+                        size_t position,
+                        const void *src,
+                        size_t len) {
+    position %= cmd_buff->capacity;
+    size_t first_part = cmd_buff->capacity - position;
+    if (first_part > len) {
+        first_part = len;
+    }
+    memcpy(&cmd_buff->data[position], src, first_part);
+    memcpy(cmd_buff->data, (const uint8_t *) src + first_part,
+           len - first_part);
+}
+
+static void arena_read(const pfs_cmd_history_t *cmd_buff,
+                       size_t position,
+                       void *dst,
+                       size_t len) {
+    position %= cmd_buff->capacity;
+    size_t first_part = cmd_buff->capacity - position;
+    if (first_part > len) {
+        first_part = len;
+    }
+    memcpy(dst, &cmd_buff->data[position], first_part);
+    memcpy((uint8_t *) dst + first_part, cmd_buff->data, len - first_part);
+}
+
+static size_t entry_len_at(const pfs_cmd_history_t *cmd_buff,
+                           size_t position) {
+    entry_len_t len;
+    arena_read(cmd_buff, position, &len, sizeof(len));
+    return len;
 }
 
-pfs_cmd_history_t *pfs_cmd_history_get_buff_ptr(void) {
-    return &m_cmd_history_buff;
+// position just past the newest entry
+static size_t tail_position(const pfs_cmd_history_t *cmd_buff) {
+    return (cmd_buff->head + cmd_buff->used) % cmd_buff->capacity;
+}
+
+// start of the entry ending at `end`
+static size_t previous_entry(const pfs_cmd_history_t *cmd_buff, size_t end) {
+    size_t capacity = cmd_buff->capacity;
+    size_t len = entry_len_at(cmd_buff,
+                              (end + capacity - sizeof(entry_len_t))
+                                      % capacity);
+    return (end + capacity - ENTRY_OVERHEAD - len) % capacity;
+}
+
+// start of the entry at `offset`, walked from the newest one
+static size_t entry_position(const pfs_cmd_history_t *cmd_buff,
+                             size_t offset) {
+    size_t position = tail_position(cmd_buff);
+    for (size_t i = 0; i < offset; i++) {
+        position = previous_entry(cmd_buff, position);
+    }
+    return position;
+}
+
+static void evict_oldest(pfs_cmd_history_t *cmd_buff) {
+    size_t entry_size =
+            ENTRY_OVERHEAD + entry_len_at(cmd_buff, cmd_buff->head);
+    cmd_buff->head = (cmd_buff->head + entry_size) % cmd_buff->capacity;
+    cmd_buff->used -= entry_size;
+    cmd_buff->occupancy--;
+}
+
+static int append_to_arena(pfs_cmd_history_t *cmd_buff,
+                           const char *line,
+                           size_t line_len) {
+    entry_len_t len = (entry_len_t) line_len;
+    size_t entry_size = ENTRY_OVERHEAD + len;
+    if (entry_size > cmd_buff->capacity || cmd_buff->max_occupancy == 0) {
+        return 1;
+    }
+
+    while (pfs_cmd_history_is_full(cmd_buff)
+           || cmd_buff->used + entry_size > cmd_buff->capacity) {
+        evict_oldest(cmd_buff);
+    }
+
+    size_t position = cmd_buff->head + cmd_buff->used;
+    arena_write(cmd_buff, position, &len, sizeof(len));
+    arena_write(cmd_buff, position + sizeof(len), line, len);
+    arena_write(cmd_buff, position + sizeof(len) + len, &len, sizeof(len));
+    cmd_buff->used += entry_size;
+    cmd_buff->occupancy++;
+    return 0;
 }
 
 int pfs_cmd_history_append(pfs_cmd_history_t *cmd_buff,
                            pfs_input_buffer_t *value) {
+    if (!(cmd_buff && value)) {
+        return 1;
+    }
+
+    if (append_to_arena(cmd_buff, value->buffer, value->len)) {
+        return 1;
+    }
+
+    if (cmd_buff->storage
+        && cmd_buff->storage->append(value->buffer, value->len)) {
+        // the storage is full, keep only what is held in RAM (including the
+        // command that has just been appended)
+        (void) cmd_buff->storage->compact(cmd_buff);
+    }
+    return 0;
+}
+
+static void load_entry(const char *line, size_t len, void *arg) {
+    (void) append_to_arena((pfs_cmd_history_t *) arg, line, len);
+}
+
+int pfs_cmd_history_load(pfs_cmd_history_t *cmd_buff) {
     if (!cmd_buff) {
         return 1;
     }
+    if (!cmd_buff->storage) {
+        return 0;
+    }
+    return cmd_buff->storage->read(load_entry, cmd_buff);
+}
 
-    size_t index = (cmd_buff->head + cmd_buff->occupancy) % cmd_buff->capacity;
+void pfs_cmd_history_for_each(const pfs_cmd_history_t *cmd_buff,
+                              pfs_history_storage_entry_cb_t callback,
+                              void *arg) {
+    char line[PFS_MAX_INPUT_SIZE];
+    size_t position = cmd_buff->head;
+    for (size_t i = 0; i < cmd_buff->occupancy; i++) {
+        size_t len = entry_len_at(cmd_buff, position);
+        arena_read(cmd_buff, position + sizeof(entry_len_t), line, len);
+        callback(line, len, arg);
+        position += ENTRY_OVERHEAD + len;
+    }
+}
 
-    memcpy(&cmd_buff->data[index], value, sizeof(pfs_input_buffer_t));
-    if (pfs_cmd_history_is_full(cmd_buff)) {
-        cmd_buff->head++;
-        cmd_buff->head %= cmd_buff->capacity;
-    } else {
-        cmd_buff->occupancy++;
+int pfs_cmd_history_read(pfs_cmd_history_t *cmd_buff,
+                         const pfs_cmd_history_entry_t *entry,
+                         pfs_input_buffer_t *out_value) {
+    if (!(cmd_buff && entry && out_value)) {
+        return 1;
+    }
+    if (pfs_cmd_history_is_empty(cmd_buff)) {
+        return 1;
+    }
+    if (cmd_buff->occupancy < entry->offset) {
+        return 1;
     }
+
+    // copy only the used bytes, the rest of the buffer is left as it is
+    if (entry->offset == 0) {
+        memcpy(out_value->buffer, cmd_buff->newest.buffer,
+               cmd_buff->newest.len);
+        out_value->len = cmd_buff->newest.len;
+        out_value->cursor = cmd_buff->newest.cursor;
+        out_value->buffer[out_value->len] = '\0';
+        return 0;
+    }
+
+    size_t len = entry_len_at(cmd_buff, entry->position);
+    arena_read(cmd_buff, entry->position + sizeof(entry_len_t),
+               out_value->buffer, len);
+    out_value->len = len;
+    out_value->cursor = len;
+    out_value->buffer[len] = '\0';
+
     return 0;
 }
 
 int pfs_cmd_history_get(pfs_cmd_history_t *cmd_buff,
                         size_t offset,
                         pfs_input_buffer_t *out_value) {
-    if (!(cmd_buff && out_value)) {
+    if (!cmd_buff || cmd_buff->occupancy < offset) {
         return 1;
     }
-    if (pfs_cmd_history_is_empty(cmd_buff)) {
+    pfs_cmd_history_entry_t entry = {
+            .offset = offset,
+            .position = entry_position(cmd_buff, offset),
+    };
+    return pfs_cmd_history_read(cmd_buff, &entry, out_value);
+}
+
+static bool entry_matches(const pfs_cmd_history_t *cmd_buff,
+                          size_t position,
+                          const char *pattern,
+                          size_t pattern_len,
+                          bool prefix) {
+    size_t len = entry_len_at(cmd_buff, position);
+    if (len < pattern_len) {
+        return false;
+    }
+    size_t last_start = prefix ? 0 : len - pattern_len;
+    position += sizeof(entry_len_t);
+
+    // compare in place, entries may wrap around the end of the arena
+    for (size_t start = 0; start <= last_start; start++) {
+        size_t i = 0;
+        while (i < pattern_len
+               && cmd_buff->data[(position + start + i) % cmd_buff->capacity]
+                          == (uint8_t) pattern[i]) {
+            i++;
+        }
+        if (i == pattern_len) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int pfs_cmd_history_find_older(pfs_cmd_history_t *cmd_buff,
+                               const pfs_cmd_history_entry_t *from,
+                               const char *pattern,
+                               size_t pattern_len,
+                               bool prefix,
+                               pfs_cmd_history_entry_t *out_entry) {
+    if (!(cmd_buff && from && pattern && out_entry)) {
+        return 1;
+    }
+
+    // from the newest to the oldest, the first match is the nearest one
+    size_t position =
+            from->offset == 0 ? tail_position(cmd_buff) : from->position;
+    for (size_t offset = from->offset + 1; offset <= cmd_buff->occupancy;
+         offset++) {
+        position = previous_entry(cmd_buff, position);
+        if (entry_matches(cmd_buff, position, pattern, pattern_len, prefix)) {
+            out_entry->offset = offset;
+            out_entry->position = position;
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int pfs_cmd_history_find(pfs_cmd_history_t *cmd_buff,
+                         size_t offset,
+                         bool older,
+                         const char *pattern,
+                         size_t pattern_len,
+                         bool prefix,
+                         size_t *out_offset) {
+    if (!(cmd_buff && pattern && out_offset)) {
         return 1;
     }
 
-    if (!pfs_cmd_history_is_full(cmd_buff)) {
+    if (older) {
         if (cmd_buff->occupancy < offset) {
             return 1;
         }
-    } else {
-        if (cmd_buff->occupancy <= offset) {
+        pfs_cmd_history_entry_t from = {
+                .offset = offset,
+                .position = entry_position(cmd_buff, offset),
+        };
+        pfs_cmd_history_entry_t found;
+        if (pfs_cmd_history_find_older(cmd_buff, &from, pattern, pattern_len,
+                                       prefix, &found)) {
             return 1;
         }
+        *out_offset = found.offset;
+        return 0;
     }
 
-    size_t index = (cmd_buff->head + cmd_buff->occupancy - offset)
-                   % cmd_buff->capacity;
-
-    // get by copy so that the original data is not modified
-    memcpy(out_value, &cmd_buff->data[index], sizeof(pfs_input_buffer_t));
+    // the oldest newer match is the last one seen before reaching `offset`
+    bool found = false;
+    size_t position = tail_position(cmd_buff);
+    for (size_t entry_offset = 1;
+         entry_offset < offset && entry_offset <= cmd_buff->occupancy;
+         entry_offset++) {
+        position = previous_entry(cmd_buff, position);
+        if (entry_matches(cmd_buff, position, pattern, pattern_len, prefix)) {
+            *out_offset = entry_offset;
+            found = true;
+        }
+    }
 
-    return 0;
+    return found ? 0 : 1;
 }
 
 int pfs_cmd_history_update_newest(pfs_cmd_history_t *cmd_buff,
                                   pfs_input_buffer_t *value) {
-    if (!cmd_buff) {
+    if (!(cmd_buff && value)) {
         return 1;
     }
 
-    size_t index = (cmd_buff->head + cmd_buff->occupancy) % cmd_buff->capacity;
-
-    memcpy(&cmd_buff->data[index], value, sizeof(pfs_input_buffer_t));
+    memcpy(cmd_buff->newest.buffer, value->buffer, value->len);
+    cmd_buff->newest.len = value->len;
+    cmd_buff->newest.cursor = value->cursor;
 
     return 0;
 }
@@ -111,7 +353,10 @@ int pfs_cmd_history_reset(pfs_cmd_history_t *cmd_buff) {
         return 1;
     }
     cmd_buff->head = 0;
+    cmd_buff->used = 0;
     cmd_buff->occupancy = 0;
+    cmd_buff->newest.len = 0;
+    cmd_buff->newest.cursor = 0;
 
     return 0;
 }
@@ -24,7 +24,9 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
+#include "pfs_history_storage.h"
 #include "pfs_io.h"
 
 #ifdef __cplusplus
@@ -33,23 +35,68 @@ extern "C" {
 
 #ifdef PFS_WITH_COMMAND_HISTORY
 
+/**
+ * Commands are stored back-to-back in a circular byte arena, each between two
+ * copies of its length, so the arena can be walked both ways. The oldest commands are evicted when either the byte budget or
+ * the maximum number of commands is exceeded. The line being edited before
+ * browsing the history is kept separately in `newest`. If `storage` is set,
+ * every appended command is persisted too.
+ */
 typedef struct pfs_cmd_history {
-    pfs_input_buffer_t *data;
-    size_t head;
+    uint8_t *data;
     size_t capacity;
+    size_t head;
+    size_t used;
+    size_t max_occupancy;
     size_t occupancy;
+    pfs_input_buffer_t newest;
+    const pfs_history_storage_t *storage;
 } pfs_cmd_history_t;
 
+/**
+ * An entry of the history, its offset (1 is the newest entry, 0 the line
+ * edited before browsing) and where it starts in the arena. Valid until the
+ * next append.
+ */
+typedef struct {
+    size_t offset;
+    size_t position;
+} pfs_cmd_history_entry_t;
+
+void pfs_cmd_history_init(pfs_cmd_history_t *cmd_buff,
+                          uint8_t *data,
+                          size_t capacity,
+                          size_t max_occupancy);
 int pfs_cmd_history_append(pfs_cmd_history_t *cmd_buff,
                            pfs_input_buffer_t *value);
 int pfs_cmd_history_get(pfs_cmd_history_t *cmd_buff,
                         size_t offset,
                         pfs_input_buffer_t *out_value);
+int pfs_cmd_history_read(pfs_cmd_history_t *cmd_buff,
+                         const pfs_cmd_history_entry_t *entry,
+                         pfs_input_buffer_t *out_value);
+// finds the nearest entry older than `from` that starts with (or contains) the
+// pattern, walking only the entries between them
+int pfs_cmd_history_find_older(pfs_cmd_history_t *cmd_buff,
+                               const pfs_cmd_history_entry_t *from,
+                               const char *pattern,
+                               size_t pattern_len,
+                               bool prefix,
+                               pfs_cmd_history_entry_t *out_entry);
+// finds the nearest entry older (or newer) than `offset` that starts with (or
+// contains) the pattern
+int pfs_cmd_history_find(pfs_cmd_history_t *cmd_buff,
+                         size_t offset,
+                         bool older,
+                         const char *pattern,
+                         size_t pattern_len,
+                         bool prefix,
+                         size_t *out_offset);
 int pfs_cmd_history_update_newest(pfs_cmd_history_t *cmd_buff,
                                   pfs_input_buffer_t *value);
 
 static inline bool pfs_cmd_history_is_full(pfs_cmd_history_t *cmd_buff) {
-    return cmd_buff ? cmd_buff->capacity == cmd_buff->occupancy : true;
+    return cmd_buff ? cmd_buff->max_occupancy == cmd_buff->occupancy : true;
 }
 
 static inline bool pfs_cmd_history_is_empty(pfs_cmd_history_t *cmd_buff) {
@@ -57,6 +104,12 @@ static inline bool pfs_cmd_history_is_empty(pfs_cmd_history_t *cmd_buff) {
 }
 
 int pfs_cmd_history_reset(pfs_cmd_history_t *cmd_buff);
+// loads the commands persisted in the storage (if any)
+int pfs_cmd_history_load(pfs_cmd_history_t *cmd_buff);
+void pfs_cmd_history_for_each(const pfs_cmd_history_t *cmd_buff,
+                              pfs_history_storage_entry_cb_t callback,
+                              void *arg);
+// history of the current session
 size_t *pfs_cmd_history_get_offset_ptr(void);
 pfs_cmd_history_t *pfs_cmd_history_get_buff_ptr(void);
 
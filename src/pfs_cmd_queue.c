@@ -35,8 +35,13 @@ PFS_STATIC_ASSERT(sizeof(SemaphoreHandle_t) == sizeof(void *),
 static QueueHandle_t m_cmd_queue = NULL;
 static SemaphoreHandle_t m_cmd_queue_sem = NULL;
 
+static uint8_t m_cmd_queue_storage[sizeof(pfs_cmd_args_t)];
+static StaticQueue_t m_cmd_queue_buffer;
+static StaticSemaphore_t m_cmd_queue_sem_buffer;
+
 void *pfs_cmd_queue_create(void) {
-    m_cmd_queue = xQueueCreate(1, sizeof(pfs_cmd_args_t));
+    m_cmd_queue = xQueueCreateStatic(1, sizeof(pfs_cmd_args_t),
+                                     m_cmd_queue_storage, &m_cmd_queue_buffer);
     return m_cmd_queue;
 }
 
@@ -48,7 +53,7 @@ int pfs_cmd_queue_add(const pfs_cmd_args_t *cmd_args) {
 }
 
 void *pfs_cmd_queue_create_sem(void) {
-    m_cmd_queue_sem = xSemaphoreCreateBinary();
+    m_cmd_queue_sem = xSemaphoreCreateBinaryStatic(&m_cmd_queue_sem_buffer);
     if (m_cmd_queue_sem) {
         xSemaphoreGive(m_cmd_queue_sem);
     }
@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pfs_cmd_stats.h"
+#include "pfs_command_index.h"
+#include "pfs_handle_shell_input.h"
+#include "pfs_io.h"
+#include "pfs_utils.h"
+
+// open addressing keyed by the command pointer, the entries of removed
+// commands are purged (see pfs_cmd_stats_purge())
+static pfs_cmd_stats_entry_t m_entries[PFS_STATS_MAX_COMMANDS];
+static uint32_t m_untracked_calls;
+// the deepest the handler task stack has been during any command, the stack
+// is repainted before every command, which hides it from the kernel
+static uint32_t m_max_stack_words;
+
+#ifdef PFS_WITH_TESTS
+uint32_t pfs_cmd_stats_untracked_calls(void) {
+    return m_untracked_calls;
+}
+#endif // PFS_WITH_TESTS
+
+static size_t slot_of(const pfs_command_t *command) {
+    // commands are aligned, the low bits carry no information
+    uint32_t key = (uint32_t) ((uintptr_t) command >> 2);
+    return (size_t) ((key * 2654435761u) % PFS_STATS_MAX_COMMANDS);
+}
+
+static pfs_cmd_stats_entry_t *lookup(const pfs_command_t *command,
+                                     bool insert) {
+    size_t slot = slot_of(command);
+    for (size_t i = 0; i < PFS_STATS_MAX_COMMANDS; i++) {
+        pfs_cmd_stats_entry_t *entry = &m_entries[slot];
+        const pfs_command_t *key =
+                __atomic_load_n(&entry->command, __ATOMIC_ACQUIRE);
+        if (key == command) {
+            return entry;
+        }
+        if (key == NULL) {
+            if (!insert) {
+                return NULL;
+            }
+            memset(entry, 0, sizeof(*entry));
+            // readers see the entry only once it is initialized
+            __atomic_store_n(&entry->command, command, __ATOMIC_RELEASE);
+            return entry;
+        }
+        slot = (slot + 1) % PFS_STATS_MAX_COMMANDS;
+    }
+    return NULL;
+}
+
+void pfs_cmd_stats_record(const pfs_command_t *command,
+                          uint32_t elapsed_us,
+                          uint32_t stack_words) {
+    if (stack_words > m_max_stack_words) {
+        m_max_stack_words = stack_words;
+    }
+    pfs_cmd_stats_entry_t *entry = lookup(command, true);
+    if (entry == NULL) {
+        m_untracked_calls++;
+        return;
+    }
+    entry->calls++;
+    entry->last_us = elapsed_us;
+    entry->total_us += elapsed_us;
+    if (elapsed_us > entry->max_us) {
+        entry->max_us = elapsed_us;
+    }
+    if (stack_words > entry->max_stack_words) {
+        entry->max_stack_words = stack_words;
+    }
+}
+
+const pfs_cmd_stats_entry_t *pfs_cmd_stats_find(const pfs_command_t *command) {
+    return lookup(command, false);
+}
+
+static bool is_indexed(const pfs_command_index_t *index,
+                       const pfs_command_t *command) {
+    for (size_t i = 0; index != NULL && i < index->number_of_nodes; i++) {
+        if (index->nodes[i].command == command) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void pfs_cmd_stats_purge(const pfs_command_index_t *index) {
+    for (size_t i = 0; i < PFS_STATS_MAX_COMMANDS; i++) {
+        if (m_entries[i].command != NULL
+            && !is_indexed(index, m_entries[i].command)) {
+            memset(&m_entries[i], 0, sizeof(m_entries[i]));
+        }
+    }
+    // the remaining entries may have been placed past a purged one, probe
+    // sequences must not cross empty slots
+    for (size_t i = 0; i < PFS_STATS_MAX_COMMANDS; i++) {
+        pfs_cmd_stats_entry_t entry = m_entries[i];
+        if (entry.command == NULL) {
+            continue;
+        }
+        memset(&m_entries[i], 0, sizeof(m_entries[i]));
+        pfs_cmd_stats_entry_t *slot = lookup(entry.command, true);
+        *slot = entry;
+    }
+}
+
+uint32_t pfs_cmd_stats_max_stack_words(void) {
+    return m_max_stack_words;
+}
+
+void pfs_cmd_stats_reset(void) {
+    memset(m_entries, 0, sizeof(m_entries));
+    m_untracked_calls = 0;
+}
+
+typedef enum {
+    SORT_BY_CALLS,
+    SORT_BY_TOTAL,
+    SORT_BY_AVG,
+    SORT_BY_MAX,
+    SORT_BY_LAST,
+    SORT_BY_STACK,
+} sort_key_t;
+
+static const char *const SORT_KEYS[] = {"calls", "total", "avg",
+                                        "max",   "last",  "stack"};
+
+typedef struct {
+    pfs_cmd_stats_entry_t entry;
+    char path[PFS_MAX_INPUT_SIZE];
+} row_t;
+
+typedef struct {
+    row_t *rows;
+    size_t len;
+    size_t capacity;
+} rows_t;
+
+static uint64_t average(const pfs_cmd_stats_entry_t *entry) {
+    return entry->calls ? entry->total_us / entry->calls : 0;
+}
+
+static uint64_t sort_value(const pfs_cmd_stats_entry_t *entry, sort_key_t key) {
+    switch (key) {
+    case SORT_BY_CALLS:
+        return entry->calls;
+    case SORT_BY_AVG:
+        return average(entry);
+    case SORT_BY_MAX:
+        return entry->max_us;
+    case SORT_BY_LAST:
+        return entry->last_us;
+    case SORT_BY_STACK:
+        return entry->max_stack_words;
+    default:
+        return entry->total_us;
+    }
+}
+
+static sort_key_t m_sort_key;
+
+static int compare_rows(const void *a, const void *b) {
+    uint64_t x = sort_value(&((const row_t *) a)->entry, m_sort_key);
+    uint64_t y = sort_value(&((const row_t *) b)->entry, m_sort_key);
+    // descending
+    return (x < y) - (x > y);
+}
+
+static void collect_rows(const pfs_command_index_t *index,
+                         const pfs_command_index_node_t *parent,
+                         char *path,
+                         size_t path_len,
+                         rows_t *rows) {
+    size_t len;
+    const pfs_command_index_node_t *children =
+            pfs_command_index_children(index, parent, &len);
+    for (size_t i = 0; i < len && rows->len < rows->capacity; i++) {
+        const pfs_command_t *command = children[i].command;
+        int written = snprintf(&path[path_len], PFS_MAX_INPUT_SIZE - path_len,
+                               path_len ? " %s" : "%s",
+                               command->description.name);
+        size_t child_len = path_len + (size_t) written;
+        if (child_len >= PFS_MAX_INPUT_SIZE) {
+            // too long to be typed anyway
+            continue;
+        }
+        if (pfs_command_has_subcommands(command)) {
+            collect_rows(index, &children[i], path, child_len, rows);
+            continue;
+        }
+        const pfs_cmd_stats_entry_t *entry = lookup(command, false);
+        if (entry == NULL || entry->calls == 0) {
+            continue;
+        }
+        row_t *row = &rows->rows[rows->len++];
+        row->entry = *entry;
+        memcpy(row->path, path, child_len + 1);
+    }
+    path[path_len] = '\0';
+}
+
+static int parse_sort_key(const char *name, sort_key_t *out_key) {
+    for (size_t i = 0; i < PFS_ARRAY_SIZE(SORT_KEYS); i++) {
+        if (strcmp(name, SORT_KEYS[i]) == 0) {
+            *out_key = (sort_key_t) i;
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int pfs_cmd_stats_command(int argc, char **argv) {
+    sort_key_t key = SORT_BY_TOTAL;
+    if (argc == 1 && strcmp(argv[0], "reset") == 0) {
+        pfs_cmd_stats_reset();
+        return 0;
+    }
+    if (argc > 1 || (argc == 1 && parse_sort_key(argv[0], &key))) {
+        PFS_SHELL_LOG(WRN, "usage: cmdstats [calls|total|avg|max|last|stack] "
+                           "| cmdstats reset\n");
+        return 1;
+    }
+
+    rows_t rows = {
+            .rows = malloc(PFS_STATS_MAX_COMMANDS * sizeof(row_t)),
+            .len = 0,
+            .capacity = PFS_STATS_MAX_COMMANDS,
+    };
+    if (rows.rows == NULL) {
+        PFS_SHELL_LOG(ERR, "failed to allocate memory for cmdstats\n");
+        return 1;
+    }
+    char path[PFS_MAX_INPUT_SIZE] = "";
+    collect_rows(pfs_command_index_get(), NULL, path, 0, &rows);
+    m_sort_key = key;
+    qsort(rows.rows, rows.len, sizeof(row_t), compare_rows);
+
+    PFS_SHELL_LOG(INF, "%-24s %8s %10s %10s %10s %6s\n", "command", "calls",
+                  "last us", "avg us", "max us", "stack");
+    for (size_t i = 0; i < rows.len; i++) {
+        const pfs_cmd_stats_entry_t *entry = &rows.rows[i].entry;
+        PFS_SHELL_LOG(INF, "%-24s %8lu %10lu %10lu %10lu %6lu\n",
+                      rows.rows[i].path, (unsigned long) entry->calls,
+                      (unsigned long) entry->last_us,
+                      (unsigned long) average(entry),
+                      (unsigned long) entry->max_us,
+                      (unsigned long) entry->max_stack_words);
+    }
+    if (m_untracked_calls > 0) {
+        PFS_SHELL_LOG(WRN, "%lu calls not tracked, increase "
+                           "PFS_STATS_MAX_COMMANDS\n",
+                      (unsigned long) m_untracked_calls);
+    }
+    free(rows.rows);
+    return 0;
+}
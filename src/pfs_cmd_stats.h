@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <pico_freertos_shell/commands.h>
+
+#include "pfs_command_index.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#ifndef PFS_STATS_MAX_COMMANDS
+#define PFS_STATS_MAX_COMMANDS (32U)
+#endif // PFS_STATS_MAX_COMMANDS
+
+/**
+ * Profile of a single leaf command, written by the command handler task only.
+ */
+typedef struct {
+    const pfs_command_t *command;
+    uint32_t calls;
+    uint32_t last_us;
+    uint32_t max_us;
+    uint64_t total_us;
+    // the deepest the handler task stack has been during the command
+    uint32_t max_stack_words;
+} pfs_cmd_stats_entry_t;
+
+/**
+ * @brief Records a single call of @p command. Commands beyond
+ *        `PFS_STATS_MAX_COMMANDS` are counted as untracked only.
+ */
+void pfs_cmd_stats_record(const pfs_command_t *command,
+                          uint32_t elapsed_us,
+                          uint32_t stack_words);
+
+/**
+ * @brief Returns the profile of @p command, or NULL if it has not been called.
+ */
+const pfs_cmd_stats_entry_t *pfs_cmd_stats_find(const pfs_command_t *command);
+
+/**
+ * @brief Drops the profiles of commands that are not in @p index anymore, so
+ *        their addresses may be reused. Called with the command handler
+ *        stopped.
+ */
+void pfs_cmd_stats_purge(const pfs_command_index_t *index);
+
+/**
+ * @brief Returns the deepest the command handler task stack has been during
+ *        any command since boot (not cleared by `pfs_cmd_stats_reset()`).
+ */
+uint32_t pfs_cmd_stats_max_stack_words(void);
+
+void pfs_cmd_stats_reset(void);
+
+/**
+ * @brief Handles the `cmdstats` built-in command
+ *        (`cmdstats [calls|total|avg|max|last|stack]` or `cmdstats reset`).
+ */
+int pfs_cmd_stats_command(int argc, char **argv);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
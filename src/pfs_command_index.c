@@ -0,0 +1,374 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <pico_freertos_shell/commands.h>
+
+#include "pfs_command_index.h"
+#include "pfs_handle_shell_input.h"
+#include "pfs_io.h"
+
+void _pfs_commands_lock(void);
+void _pfs_commands_unlock(void);
+void _pfs_commands_synchronize(void);
+
+// written only with the commands lock held, read without any lock
+static pfs_command_index_t *m_index = NULL;
+
+#ifdef PFS_WITH_TESTS
+void pfs_reset_commands(void) {
+    free(m_index);
+    m_index = NULL;
+}
+#endif // PFS_WITH_TESTS
+
+const pfs_command_index_t *pfs_command_index_get(void) {
+    return __atomic_load_n(&m_index, __ATOMIC_ACQUIRE);
+}
+
+const pfs_command_index_node_t *
+pfs_command_index_children(const pfs_command_index_t *index,
+                           const pfs_command_index_node_t *parent,
+                           size_t *out_len) {
+    if (index == NULL) {
+        *out_len = 0;
+        return NULL;
+    }
+    if (parent == NULL) {
+        *out_len = index->number_of_commands;
+        return index->nodes;
+    }
+    *out_len = parent->command->number_of_subcommands;
+    return &index->nodes[parent->first_subcommand];
+}
+
+// the same as strcmp(name, other) if `other` was null-terminated at other_len
+static int compare_names(const char *name, const char *other, size_t other_len) {
+    int cmp = strncmp(name, other, other_len);
+    if (cmp != 0) {
+        return cmp;
+    }
+    return name[other_len] != '\0';
+}
+
+const pfs_command_index_node_t *
+pfs_command_index_find(const pfs_command_index_node_t *nodes,
+                       size_t len,
+                       const char *name,
+                       size_t name_len) {
+    if (nodes == NULL || name == NULL) {
+        return NULL;
+    }
+
+    size_t low = 0;
+    size_t high = len;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        int cmp = compare_names(nodes[middle].command->description.name, name,
+                                name_len);
+        if (cmp == 0) {
+            return &nodes[middle];
+        }
+        if (cmp > 0) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+
+    return NULL;
+}
+
+// index of the first node for which strncmp(name, prefix, prefix_len) is
+// greater than (or equal to, if !strict) zero
+static size_t prefix_bound(const pfs_command_index_node_t *nodes,
+                           size_t len,
+                           const char *prefix,
+                           size_t prefix_len,
+                           bool strict) {
+    size_t low = 0;
+    size_t high = len;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        int cmp = strncmp(nodes[middle].command->description.name, prefix,
+                          prefix_len);
+        if (cmp > 0 || (cmp == 0 && !strict)) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return low;
+}
+
+size_t
+pfs_command_index_find_prefix(const pfs_command_index_node_t *nodes,
+                              size_t len,
+                              const char *prefix,
+                              size_t prefix_len,
+                              const pfs_command_index_node_t **out_first) {
+    *out_first = NULL;
+    if (nodes == NULL || len == 0) {
+        return 0;
+    }
+
+    size_t first = prefix_bound(nodes, len, prefix, prefix_len, false);
+    size_t last = prefix_bound(nodes, len, prefix, prefix_len, true);
+    if (first == last) {
+        return 0;
+    }
+
+    *out_first = &nodes[first];
+    return last - first;
+}
+
+static int sort_command_pointers_by_name(const void *a, const void *b) {
+    const pfs_command_t *command_a = *(const pfs_command_t *const *) a;
+    const pfs_command_t *command_b = *(const pfs_command_t *const *) b;
+
+    return strcmp(command_a->description.name, command_b->description.name);
+}
+
+static int sort_nodes_by_name(const void *a, const void *b) {
+    const pfs_command_index_node_t *node_a = a;
+    const pfs_command_index_node_t *node_b = b;
+
+    return sort_command_pointers_by_name(&node_a->command, &node_b->command);
+}
+
+static pfs_command_index_t *index_alloc(pfs_command_index_t *index,
+                                        size_t number_of_nodes) {
+    pfs_command_index_t *new_index =
+            realloc(index, sizeof(pfs_command_index_t)
+                                   + number_of_nodes
+                                             * sizeof(pfs_command_index_node_t));
+    if (new_index == NULL) {
+        PFS_SHELL_LOG(ERR, "failed to allocate memory for command index\n");
+        free(index);
+    }
+    return new_index;
+}
+
+/**
+ * Lays out the tree breadth-first, so that subcommands of every command are
+ * stored next to each other and can be sorted in place. `commands` must be
+ * sorted by name already.
+ */
+static pfs_command_index_t *index_build(const pfs_command_t *const *commands,
+                                        size_t number_of_commands) {
+    size_t capacity = number_of_commands;
+    pfs_command_index_t *index = index_alloc(NULL, capacity);
+    if (index == NULL) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < number_of_commands; i++) {
+        index->nodes[i].command = commands[i];
+    }
+    index->number_of_commands = number_of_commands;
+    index->number_of_nodes = number_of_commands;
+
+    // the tree has been validated, so it has no cycles and this terminates
+    for (size_t i = 0; i < index->number_of_nodes; i++) {
+        const pfs_command_t *command = index->nodes[i].command;
+        size_t len = command->number_of_subcommands;
+        index->nodes[i].first_subcommand = index->number_of_nodes;
+        if (len == 0) {
+            continue;
+        }
+
+        if (index->number_of_nodes + len > capacity) {
+            capacity = 2 * (index->number_of_nodes + len);
+            index = index_alloc(index, capacity);
+            if (index == NULL) {
+                return NULL;
+            }
+        }
+
+        pfs_command_index_node_t *subcommands =
+                &index->nodes[index->number_of_nodes];
+        for (size_t j = 0; j < len; j++) {
+            subcommands[j].command = &command->subcommands[j];
+        }
+        qsort(subcommands, len, sizeof(pfs_command_index_node_t),
+              sort_nodes_by_name);
+        index->number_of_nodes += len;
+    }
+
+    if (index->number_of_nodes < capacity) {
+        // shrinking, can't really fail
+        index = index_alloc(index, index->number_of_nodes);
+    }
+
+    return index;
+}
+
+static const pfs_command_t **collect_commands(size_t extra_commands,
+                                              size_t *out_len) {
+    size_t builtins_len;
+    const pfs_command_t *builtins = pfs_get_aditional_commands(&builtins_len);
+
+    size_t len = m_index ? m_index->number_of_commands : builtins_len;
+    const pfs_command_t **commands =
+            malloc((len + extra_commands) * sizeof(const pfs_command_t *));
+    if (commands == NULL) {
+        PFS_SHELL_LOG(ERR, "failed to allocate memory for command index\n");
+        return NULL;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        commands[i] = m_index ? m_index->nodes[i].command : &builtins[i];
+    }
+    *out_len = len;
+
+    return commands;
+}
+
+/**
+ * Publishes the new snapshot and releases the commands lock. The previous
+ * snapshot is freed once the shell task is guaranteed not to use it anymore.
+ */
+static void publish_and_unlock(pfs_command_index_t *index) {
+    pfs_command_index_t *old_index = m_index;
+    __atomic_store_n(&m_index, index, __ATOMIC_RELEASE);
+    _pfs_commands_unlock();
+
+    if (old_index != NULL) {
+        _pfs_commands_synchronize();
+        free(old_index);
+    }
+}
+
+/**
+ * Builds and publishes a snapshot out of top-level `commands`. Releases the
+ * commands lock in any case.
+ */
+static int rebuild_and_unlock(const pfs_command_t **commands, size_t len) {
+    pfs_command_index_t *index = index_build(commands, len);
+    free(commands);
+    if (index == NULL) {
+        _pfs_commands_unlock();
+        return 1;
+    }
+    publish_and_unlock(index);
+    return 0;
+}
+
+int pfs_command_index_init(void) {
+    _pfs_commands_lock();
+    if (m_index != NULL) {
+        _pfs_commands_unlock();
+        return 0;
+    }
+
+    size_t len;
+    const pfs_command_t **commands = collect_commands(0, &len);
+    if (commands == NULL) {
+        _pfs_commands_unlock();
+        return 1;
+    }
+    qsort(commands, len, sizeof(const pfs_command_t *),
+          sort_command_pointers_by_name);
+
+    return rebuild_and_unlock(commands, len);
+}
+
+int pfs_command_index_add(const pfs_command_t commands[],
+                          size_t number_of_commands) {
+    _pfs_commands_lock();
+    size_t len;
+    const pfs_command_t **all_commands =
+            collect_commands(number_of_commands, &len);
+    if (all_commands == NULL) {
+        _pfs_commands_unlock();
+        return 1;
+    }
+
+    for (size_t i = 0; i < number_of_commands; i++) {
+        all_commands[len++] = &commands[i];
+    }
+    qsort(all_commands, len, sizeof(const pfs_command_t *),
+          sort_command_pointers_by_name);
+
+    for (size_t i = 1; i < len; i++) {
+        if (sort_command_pointers_by_name(&all_commands[i - 1],
+                                          &all_commands[i])
+            == 0) {
+            PFS_SHELL_LOG(ERR, "command '%s' is already registered\n",
+                          all_commands[i]->description.name);
+            _pfs_commands_unlock();
+            free(all_commands);
+            return 1;
+        }
+    }
+
+    return rebuild_and_unlock(all_commands, len);
+}
+
+static bool command_belongs_to(const pfs_command_t *command,
+                               const pfs_command_t commands[],
+                               size_t number_of_commands) {
+    uintptr_t address = (uintptr_t) command;
+    return address >= (uintptr_t) &commands[0]
+           && address < (uintptr_t) &commands[number_of_commands];
+}
+
+int pfs_command_index_remove(const pfs_command_t commands[],
+                             size_t number_of_commands) {
+    _pfs_commands_lock();
+    size_t len;
+    const pfs_command_t **all_commands = collect_commands(0, &len);
+    if (all_commands == NULL) {
+        _pfs_commands_unlock();
+        return 1;
+    }
+
+    // keeps the order, so no need to sort again
+    size_t new_len = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (!command_belongs_to(all_commands[i], commands,
+                                number_of_commands)) {
+            all_commands[new_len++] = all_commands[i];
+        }
+    }
+
+    if (len - new_len != number_of_commands) {
+        _pfs_commands_unlock();
+        free(all_commands);
+        PFS_SHELL_LOG(ERR, "commands are not registered\n");
+        return 1;
+    }
+
+    return rebuild_and_unlock(all_commands, new_len);
+}
+
+size_t pfs_command_index_number_of_user_commands(void) {
+    size_t builtins_len;
+    (void) pfs_get_aditional_commands(&builtins_len);
+
+    const pfs_command_index_t *index = pfs_command_index_get();
+    return index ? index->number_of_commands - builtins_len : 0;
+}
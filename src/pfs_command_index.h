@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#include <pico_freertos_shell/commands.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+typedef struct {
+    const pfs_command_t *command;
+    // subcommands are stored next to each other starting at this index of
+    // `pfs_command_index_t::nodes`, sorted by name
+    size_t first_subcommand;
+} pfs_command_index_node_t;
+
+/**
+ * Snapshot of the whole command tree (including the built-in commands) with
+ * every level sorted by name. Top-level commands are stored at the beginning of
+ * `nodes`. Snapshots are immutable once published. Writers build a new
+ * snapshot, publish it and free the old one only after the shell task has
+ * passed through a quiescent state, so readers never take a lock.
+ */
+typedef struct {
+    size_t number_of_commands;
+    size_t number_of_nodes;
+    pfs_command_index_node_t nodes[];
+} pfs_command_index_t;
+
+const pfs_command_index_t *pfs_command_index_get(void);
+const pfs_command_index_node_t *
+pfs_command_index_children(const pfs_command_index_t *index,
+                           const pfs_command_index_node_t *parent,
+                           size_t *out_len);
+const pfs_command_index_node_t *
+pfs_command_index_find(const pfs_command_index_node_t *nodes,
+                       size_t len,
+                       const char *name,
+                       size_t name_len);
+size_t
+pfs_command_index_find_prefix(const pfs_command_index_node_t *nodes,
+                              size_t len,
+                              const char *prefix,
+                              size_t prefix_len,
+                              const pfs_command_index_node_t **out_first);
+int pfs_command_index_init(void);
+int pfs_command_index_add(const pfs_command_t commands[],
+                          size_t number_of_commands);
+int pfs_command_index_remove(const pfs_command_t commands[],
+                             size_t number_of_commands);
+size_t pfs_command_index_number_of_user_commands(void);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
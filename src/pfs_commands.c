@@ -21,16 +21,19 @@
  */
 
 #include <ctype.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include <pico_freertos_shell/commands.h>
 
+#include "pfs_command_index.h"
 #include "pfs_handle_shell_input.h"
 #include "pfs_io.h"
 
 bool _pfs_is_initialized(void);
+void _pfs_commands_drain(void);
 
 static int name_is_valid(const char *name) {
     size_t len = strlen(name);
@@ -83,14 +86,138 @@ static int pointers_are_valid(const pfs_command_t *command) {
         return 0;
     }
 
+    // only arguments of a command with a handler can be completed
+    if (command->completion != NULL && command->handler == NULL) {
+        return 0;
+    }
+
     return 1;
 }
 
-static int commands_have_the_same_name(const pfs_command_t *c1,
-                                       const pfs_command_t *c2) {
-    return strcmp(c1->description.name, c2->description.name) == 0;
+// a command nested deeper than that could never be typed anyway
+#define PFS_MAX_COMMAND_DEPTH PFS_MAX_ARGC
+
+typedef struct {
+    const pfs_command_t *commands;
+    size_t number_of_commands;
+    size_t next;
+} validation_frame_t;
+
+typedef struct {
+    // indices + 1 of the commands, 0 means an empty slot
+    size_t *slots;
+    // slots allocated, kept for the following levels
+    size_t allocated;
+    // slots used by the current level
+    size_t capacity;
+} name_table_t;
+
+static uint32_t name_hash(const char *name) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash ^= (uint8_t) *name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int name_table_prepare(name_table_t *table, size_t number_of_names) {
+    size_t capacity = 8;
+    while (capacity < 2 * number_of_names) {
+        capacity *= 2;
+    }
+    if (capacity > table->allocated) {
+        size_t *slots = realloc(table->slots, capacity * sizeof(size_t));
+        if (slots == NULL) {
+            return 1;
+        }
+        table->slots = slots;
+        table->allocated = capacity;
+    }
+    // sized by this level only, a wide level doesn't slow down the small ones
+    table->capacity = capacity;
+    memset(table->slots, 0, capacity * sizeof(size_t));
+    return 0;
+}
+
+static size_t find_duplicates_hashed(const pfs_command_t *commands,
+                                     size_t number_of_commands,
+                                     name_table_t *table) {
+    size_t errors = 0;
+    size_t mask = table->capacity - 1;
+    for (size_t i = 0; i < number_of_commands; i++) {
+        const char *name = commands[i].description.name;
+        if (name == NULL) {
+            continue;
+        }
+        size_t slot = name_hash(name) & mask;
+        while (table->slots[slot] != 0) {
+            const pfs_command_t *other = &commands[table->slots[slot] - 1];
+            if (strcmp(other->description.name, name) == 0) {
+                PFS_SHELL_LOG(ERR, "commands %p and %p have the same name\n",
+                              &commands[i], other);
+                errors++;
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+        if (table->slots[slot] == 0) {
+            table->slots[slot] = i + 1;
+        }
+    }
+    return errors;
+}
+
+static size_t find_duplicates_pairwise(const pfs_command_t *commands,
+                                       size_t number_of_commands) {
+    size_t errors = 0;
+    for (size_t i = 1; i < number_of_commands; i++) {
+        for (size_t j = 0; j < i; j++) {
+            if (commands[i].description.name != NULL
+                && commands[j].description.name != NULL
+                && strcmp(commands[i].description.name,
+                          commands[j].description.name)
+                           == 0) {
+                PFS_SHELL_LOG(ERR, "commands %p and %p have the same name\n",
+                              &commands[i], &commands[j]);
+                errors++;
+                break;
+            }
+        }
+    }
+    return errors;
+}
+
+static size_t find_duplicates(const pfs_command_t *commands,
+                              size_t number_of_commands,
+                              name_table_t *table) {
+    if (name_table_prepare(table, number_of_commands)) {
+        // out of memory, still validate, just slower
+        return find_duplicates_pairwise(commands, number_of_commands);
+    }
+    return find_duplicates_hashed(commands, number_of_commands, table);
+}
+
+static size_t validate_command(const pfs_command_t *command) {
+    if (!pointers_are_valid(command)) {
+        PFS_SHELL_LOG(ERR, "command %p has invalid pointers\n", command);
+        return 1;
+    }
+
+    if (!description_is_valid(&command->description)) {
+        PFS_SHELL_LOG(ERR, "command %p has invalid description\n", command);
+        return 1;
+    }
+
+    return 0;
 }
 
+/**
+ * Validates the whole command tree iteratively (the stack depth is bounded by
+ * PFS_MAX_COMMAND_DEPTH) and reports every error found, not only the first
+ * one. Duplicated names are found in linear time using a hash table.
+ */
 static int commands_are_valid(const pfs_command_t *commands,
                               size_t number_of_commands) {
     if (commands == NULL && number_of_commands == 0) {
@@ -103,39 +230,64 @@ static int commands_are_valid(const pfs_command_t *commands,
         return 0;
     }
 
-    for (size_t i = 0; i < number_of_commands; i++) {
-        if (!pointers_are_valid(&commands[i])) {
-            PFS_SHELL_LOG(ERR, "command %p has invalid pointers\n",
-                          &commands[i]);
-            return 0;
-        }
+    validation_frame_t stack[PFS_MAX_COMMAND_DEPTH];
+    size_t depth = 0;
+    name_table_t table = {.slots = NULL, .allocated = 0, .capacity = 0};
 
-        if (!description_is_valid(&commands[i].description)) {
-            PFS_SHELL_LOG(ERR, "command %p has invalid description\n",
-                          &commands[i]);
-            return 0;
+    size_t errors = find_duplicates(commands, number_of_commands, &table);
+    stack[depth++] = (validation_frame_t){.commands = commands,
+                                          .number_of_commands =
+                                                  number_of_commands,
+                                          .next = 0};
+
+    while (depth > 0) {
+        validation_frame_t *frame = &stack[depth - 1];
+        if (frame->next == frame->number_of_commands) {
+            depth--;
+            continue;
         }
 
-        for (int j = i - 1; j >= 0; j--) {
-            if (commands_have_the_same_name(&commands[i], &commands[j])) {
-                PFS_SHELL_LOG(ERR, "commands %p and %p have the same name\n",
-                              &commands[i], &commands[j]);
-                return 0;
-            }
+        const pfs_command_t *command = &frame->commands[frame->next++];
+        if (validate_command(command)) {
+            errors++;
+            continue;
         }
-        if (!commands_are_valid(commands[i].subcommands,
-                                commands[i].number_of_subcommands)) {
-            return 0;
+        if (command->subcommands == NULL) {
+            continue;
         }
+        if (depth == PFS_MAX_COMMAND_DEPTH) {
+            PFS_SHELL_LOG(ERR, "command %p is nested too deep\n", command);
+            errors++;
+            continue;
+        }
+
+        errors += find_duplicates(command->subcommands,
+                                  command->number_of_subcommands, &table);
+        stack[depth++] = (validation_frame_t){
+                .commands = command->subcommands,
+                .number_of_commands = command->number_of_subcommands,
+                .next = 0};
     }
 
-    return 1;
+    free(table.slots);
+
+    return errors == 0;
+}
+
+int pfs_commands_validate(const pfs_command_t commands[],
+                          size_t number_of_commands) {
+    if (commands == NULL || number_of_commands == 0) {
+        PFS_SHELL_LOG(ERR, "commands are NULL or number of commands is 0\n");
+        return 1;
+    }
+
+    return !commands_are_valid(commands, number_of_commands);
 }
 
 int pfs_commands_register(const pfs_command_t commands[],
                           size_t number_of_commands) {
     puts("");
-    if (pfs_get_commands() != NULL) {
+    if (pfs_command_index_number_of_user_commands() != 0) {
         PFS_SHELL_LOG(ERR, "commands already registered\n");
         return -1;
     }
@@ -154,7 +306,30 @@ int pfs_commands_register(const pfs_command_t commands[],
         return 1;
     }
 
-    pfs_set_commands(commands, number_of_commands);
+    return pfs_command_index_add(commands, number_of_commands);
+}
 
-    return 0;
+int pfs_commands_add(const pfs_command_t commands[],
+                     size_t number_of_commands) {
+    if (pfs_commands_validate(commands, number_of_commands)) {
+        return 1;
+    }
+
+    return pfs_command_index_add(commands, number_of_commands);
+}
+
+int pfs_commands_remove(const pfs_command_t commands[],
+                        size_t number_of_commands) {
+    if (commands == NULL || number_of_commands == 0) {
+        PFS_SHELL_LOG(ERR, "commands are NULL or number of commands is 0\n");
+        return 1;
+    }
+
+    int ret = pfs_command_index_remove(commands, number_of_commands);
+    if (ret == 0) {
+        // a new command may be placed at the address of a removed one
+        pfs_completion_invalidate();
+        _pfs_commands_drain();
+    }
+    return ret;
 }
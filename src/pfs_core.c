@@ -32,90 +32,589 @@
 #include <semphr.h>
 #include <task.h>
 
+#include <pico_freertos_shell/execute.h>
 #include <pico_freertos_shell/init.h>
+#include <pico_freertos_shell/transport.h>
 
+#include "pfs_cmd_history.h"
 #include "pfs_cmd_queue.h"
+#include "pfs_cmd_stats.h"
+#include "pfs_command_index.h"
+#include "pfs_dmesg.h"
+#include "pfs_escape_sequences.h"
 #include "pfs_handle_shell_input.h"
 #include "pfs_io.h"
+#include "pfs_output_sequence.h"
+#include "pfs_pipe.h"
+#include "pfs_session.h"
+#include "pfs_stats.h"
+#include "pfs_utils.h"
+
+#ifdef PFS_WITH_OUTPUT_SEQUENCE
+#define MESSAGE_PREFIX_LEN PFS_OUTPUT_SEQUENCE_PREFIX_LEN
+#else // PFS_WITH_OUTPUT_SEQUENCE
+#define MESSAGE_PREFIX_LEN (0U)
+#endif // PFS_WITH_OUTPUT_SEQUENCE
 
-static QueueHandle_t m_msg_queue;
 static SemaphoreHandle_t m_msg_mutex;
+static StaticSemaphore_t m_msg_mutex_buffer;
 
 static QueueHandle_t m_cmd_queue;
 static SemaphoreHandle_t m_cmd_sem;
 
+static SemaphoreHandle_t m_commands_mutex;
+static StaticSemaphore_t m_commands_mutex_buffer;
+static uint32_t m_quiescent_counter;
+
 static bool m_initialized = false;
-static size_t m_dropped_messages;
 
+// used if no session is added with pfs_session_add()
+static pfs_stdio_transport_t m_default_transport;
+
+// serves the commands run by pfs_execute()
+static pfs_session_t m_capture_session;
+
+// session of the command being executed, its output is routed there only
+static pfs_session_t *volatile m_handler_session;
+// output queued by the command handler task, for the `time` prefix
+static uint32_t m_handler_output_bytes;
+// filters of the command being executed, used by the handler task only
+static pfs_pipe_t *m_handler_pipe;
+
+static void queue_handler_output(const char *data, size_t len);
+
+// set with the PFS_MAIN_STACK_SIZE and PFS_CMD_HANDLER_STACK_SIZE CMake options
+#ifndef PFS_MAIN_STACK_SIZE
 #define PFS_MAIN_STACK_SIZE (1500U)
+#endif // PFS_MAIN_STACK_SIZE
 static StackType_t m_pfs_main_task_stack[PFS_MAIN_STACK_SIZE];
 static StaticTask_t m_psf_main_task_buffer;
+static TaskHandle_t m_pfs_main_task_handle;
 
+#ifndef PFS_CMD_HANDLER_STACK_SIZE
 #define PFS_CMD_HANDLER_STACK_SIZE (1500U)
+#endif // PFS_CMD_HANDLER_STACK_SIZE
 static StackType_t m_pfs_cmd_handler_task_stack[PFS_CMD_HANDLER_STACK_SIZE];
 static StaticTask_t m_psf_cmd_handler_task_buffer;
+static TaskHandle_t m_pfs_cmd_handler_task_handle;
+
+// the shell task sleeps until notified, but not longer than that, so input of
+// transports without the rx callback is still polled
+#ifndef PFS_MAIN_TASK_IDLE_MS
+#define PFS_MAIN_TASK_IDLE_MS (50U)
+#endif // PFS_MAIN_TASK_IDLE_MS
+#define ESCAPE_SEQUENCE_TIMEOUT_TICKS \
+    (pdMS_TO_TICKS(PFS_ESCAPE_SEQUENCE_TIMEOUT_US / 1000U) + 1)
+
+/**
+ * A message broadcast to several sessions is allocated once and shared by
+ * their queues, the last session to print (or drop) it frees it. The counter
+ * is modified with `m_msg_mutex` taken.
+ */
+typedef struct {
+    size_t references;
+    size_t len;
+#ifdef PFS_WITH_MESSAGE_TIMESTAMPS
+    // taken when the message is queued, rendered by the shell task
+    uint64_t time_us;
+#endif // PFS_WITH_MESSAGE_TIMESTAMPS
+    char text[];
+} pfs_message_t;
+
+// queues are allocated statically, so the RAM footprint of the shell is known
+// at build time (see cmake/pfs_ram_report.cmake)
+static uint8_t m_output_queue_storage[PFS_MAX_SESSIONS][PFS_MSG_QUEUE_SIZE *
+                                                        sizeof(pfs_message_t *)];
+static StaticQueue_t m_output_queue_buffers[PFS_MAX_SESSIONS];
+
+static void release_message_locked(pfs_message_t *msg) {
+    if (--msg->references == 0) {
+        free(msg);
+    }
+}
+
+static void release_message(void *arg) {
+    xSemaphoreTake(m_msg_mutex, portMAX_DELAY);
+    release_message_locked((pfs_message_t *) arg);
+    xSemaphoreGive(m_msg_mutex);
+}
 
-static void drop_latest_message(void) {
-    char *msg = NULL;
-    xQueueReceive(m_msg_queue, &msg, portMAX_DELAY);
+static void drop_latest_message(pfs_session_t *session) {
+    pfs_message_t *msg = NULL;
+    xQueueReceive(session->output_queue, &msg, portMAX_DELAY);
     if (msg == NULL) {
         return;
     }
-    free(msg);
-    m_dropped_messages++;
+    release_message_locked(msg);
+    session->dropped_messages++;
+    PFS_STATS_ADD(drops_queue_full, 1);
 }
 
-static void handle_dropped_messages(void) {
-    if (m_dropped_messages == 0) {
+static void handle_dropped_messages(pfs_session_t *session) {
+    if (session->dropped_messages == 0) {
         return;
     }
     pfs_io_remove_shell_prompt();
     pfs_io_printf_immediately(
             PFS_IO_ERR_COLOR PFS_IO_BOLD_ON
             "--- %d messages dropped ---\n" PFS_IO_COLOR_RESET PFS_IO_BOLD_OFF,
-            m_dropped_messages);
-    m_dropped_messages = 0;
+            session->dropped_messages);
+    session->dropped_messages = 0;
     pfs_io_restore_shell_prompt();
 }
 
+static void notify_main_task(void) {
+    if (m_pfs_main_task_handle != NULL) {
+        xTaskNotifyGive(m_pfs_main_task_handle);
+    }
+}
+
+#ifdef PFS_WITH_STATS
+// time the last input arrived at, if not handled yet
+static volatile uint32_t m_rx_time_us;
+static volatile bool m_rx_pending;
+#endif // PFS_WITH_STATS
+
+static void chars_available_callback(void *param) {
+    (void) param;
+#ifdef PFS_WITH_STATS
+    if (!m_rx_pending) {
+        m_rx_time_us = time_us_32();
+        m_rx_pending = true;
+    }
+#endif // PFS_WITH_STATS
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    vTaskNotifyGiveFromISR(m_pfs_main_task_handle,
+                           &higher_priority_task_woken);
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+uint32_t _pfs_time_us(void) {
+    return time_us_32();
+}
+
 bool _pfs_is_initialized(void) {
     // don't care about atomicity here
     return m_initialized;
 }
 
-static void pfs_main_task(void *pvParameters) {
-    m_initialized = true;
+void _pfs_output_lock(void) {
+    xSemaphoreTake(m_msg_mutex, portMAX_DELAY);
+}
+
+void _pfs_output_unlock(void) {
+    xSemaphoreGive(m_msg_mutex);
+}
+
+void _pfs_commands_lock(void) {
+    // before pfs_init() commands are registered from a single context
+    if (m_commands_mutex != NULL) {
+        xSemaphoreTake(m_commands_mutex, portMAX_DELAY);
+    }
+}
+
+void _pfs_commands_unlock(void) {
+    if (m_commands_mutex != NULL) {
+        xSemaphoreGive(m_commands_mutex);
+    }
+}
+
+void _pfs_commands_synchronize(void) {
+    // the shell task holds no references to the command index between
+    // iterations of its main loop, so one full iteration is a grace period
+    if (!__atomic_load_n(&m_initialized, __ATOMIC_ACQUIRE)
+        || xTaskGetCurrentTaskHandle() == m_pfs_main_task_handle) {
+        return;
+    }
+    uint32_t counter = __atomic_load_n(&m_quiescent_counter, __ATOMIC_ACQUIRE);
+    notify_main_task();
+    while (counter == __atomic_load_n(&m_quiescent_counter, __ATOMIC_ACQUIRE)) {
+        vTaskDelay(1);
+    }
+}
+
+static bool commands_finished(pfs_session_t *session) {
+    return __atomic_load_n(&session->commands_finished, __ATOMIC_ACQUIRE)
+           == __atomic_load_n(&session->commands_dispatched, __ATOMIC_ACQUIRE);
+}
+
+static bool all_commands_finished(void) {
+    for (size_t i = 0; i < pfs_session_count(); i++) {
+        if (!commands_finished(pfs_session_get(i))) {
+            return false;
+        }
+    }
+    return commands_finished(&m_capture_session);
+}
+
+void _pfs_commands_drain(void) {
+    if (!__atomic_load_n(&m_initialized, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    // a handler removing commands can't wait for itself, it holds m_cmd_sem
+    bool in_handler =
+            xTaskGetCurrentTaskHandle() == m_pfs_cmd_handler_task_handle;
+    if (!in_handler) {
+        // commands dispatched before the removal was published may still be
+        // queued or executing, nothing is dispatched from the removed ones
+        // afterwards
+        while (!all_commands_finished()) {
+            vTaskDelay(1);
+        }
+        xSemaphoreTake(m_cmd_sem, portMAX_DELAY);
+    }
+#ifdef PFS_WITH_STATS
+    _pfs_commands_lock();
+    pfs_cmd_stats_purge(pfs_command_index_get());
+    _pfs_commands_unlock();
+#endif // PFS_WITH_STATS
+    if (!in_handler) {
+        xSemaphoreGive(m_cmd_sem);
+    }
+}
+
+#ifdef PFS_WITH_MESSAGE_TIMESTAMPS
+// a line may be printed in several messages, only its first one is stamped
+static void print_timestamp(pfs_session_t *session, const pfs_message_t *msg) {
+    bool mid_line = session->mid_line;
+    session->mid_line = msg->text[msg->len - 1] != '\n';
+    if (mid_line) {
+        return;
+    }
+    uint64_t time_us = msg->time_us;
+#ifdef PFS_MESSAGE_TIMESTAMPS_RELATIVE
+    // since the previous line, messages may be queued out of timestamp order
+    uint64_t last_time_us = session->last_time_us;
+    session->last_time_us = time_us;
+    time_us = (last_time_us != 0 && time_us > last_time_us)
+                      ? time_us - last_time_us
+                      : 0;
+    const char *format = "[+%lu.%06lu] ";
+#else // PFS_MESSAGE_TIMESTAMPS_RELATIVE
+    const char *format = "[%5lu.%06lu] ";
+#endif // PFS_MESSAGE_TIMESTAMPS_RELATIVE
+    char buffer[32];
+    int len = snprintf(buffer, sizeof(buffer), format,
+                       (unsigned long) (time_us / 1000000u),
+                       (unsigned long) (time_us % 1000000u));
+    pfs_transport_t *transport = session->transport;
+    (void) transport->vtable->write(transport, buffer, (size_t) len, NULL,
+                                    NULL);
+}
+#endif // PFS_WITH_MESSAGE_TIMESTAMPS
+
+static void print_messages(pfs_session_t *session) {
+#ifdef PFS_WITH_STATS
+    uint32_t start_us = time_us_32();
+    uint32_t emitted = pfs_stats.messages_emitted;
+#endif // PFS_WITH_STATS
     while (true) {
-        handle_dropped_messages();
-        bool shell_promt_removed = false;
-        while (true) {
-            char *msg;
-            xSemaphoreTake(m_msg_mutex, portMAX_DELAY);
-            BaseType_t ret = xQueueReceive(m_msg_queue, &msg, 0);
-            xSemaphoreGive(m_msg_mutex);
-            if (ret != pdTRUE) {
-                break;
-            }
-            if (!shell_promt_removed) {
-                pfs_io_remove_shell_prompt();
-                shell_promt_removed = true;
-            }
-            pfs_io_puts_immediately(msg);
-            free(msg);
+        pfs_message_t *msg;
+        xSemaphoreTake(m_msg_mutex, portMAX_DELAY);
+        BaseType_t ret = xQueueReceive(session->output_queue, &msg, 0);
+        xSemaphoreGive(m_msg_mutex);
+        if (ret != pdTRUE) {
+            break;
         }
-        if (shell_promt_removed) {
-            pfs_io_restore_shell_prompt();
+        if (!session->prompt_removed) {
+            pfs_io_remove_shell_prompt();
+            session->prompt_removed = true;
         }
-        while (true) {
-            char c = getchar_timeout_us(10);
+#ifdef PFS_WITH_MESSAGE_TIMESTAMPS
+        print_timestamp(session, msg);
+#endif // PFS_WITH_MESSAGE_TIMESTAMPS
+        // the message is released once the transport is done with it
+        pfs_transport_t *transport = session->transport;
+        PFS_STATS_ADD(messages_emitted, 1);
+        PFS_STATS_ADD(bytes_emitted, msg->len);
+        (void) transport->vtable->write(transport, msg->text, msg->len,
+                                        release_message, msg);
+    }
+    if (session->prompt_removed) {
+        pfs_io_restore_shell_prompt();
+        session->prompt_removed = false;
+    }
+#ifdef PFS_WITH_STATS
+    // only the cycles that drained anything
+    if (pfs_stats.messages_emitted != emitted) {
+        uint32_t elapsed_us = time_us_32() - start_us;
+        PFS_STATS_ADD(drain_cycles, 1);
+        PFS_STATS_ADD(drain_time_total_us, elapsed_us);
+        PFS_STATS_MAX(drain_time_max_us, elapsed_us);
+    }
+#endif // PFS_WITH_STATS
+}
+
+// with nobody listening (e.g. USB CDC not opened by the host) the output is
+// only kept by dmesg, and the prompt is printed again once a terminal connects
+static bool handle_connection(pfs_session_t *session) {
+    pfs_transport_t *transport = session->transport;
+    bool connected = transport->vtable->is_connected == NULL
+                     || transport->vtable->is_connected(transport);
+    if (!connected) {
+        session->disconnected = true;
+        return false;
+    }
+    if (session->disconnected) {
+        session->disconnected = false;
+        session->dropped_messages = 0;
+        pfs_io_restore_shell_prompt();
+    }
+    return true;
+}
+
+static void discard_messages(pfs_session_t *session) {
+    pfs_message_t *msg;
+    xSemaphoreTake(m_msg_mutex, portMAX_DELAY);
+    while (xQueueReceive(session->output_queue, &msg, 0) == pdTRUE) {
+        release_message_locked(msg);
+        PFS_STATS_ADD(drops_disconnected, 1);
+    }
+    xSemaphoreGive(m_msg_mutex);
+}
+
+static void handle_input(pfs_session_t *session) {
+    pfs_transport_t *transport = session->transport;
+    char buffer[16];
+    size_t len;
+    while ((len = transport->vtable->read(transport, buffer, sizeof(buffer)))
+           > 0) {
+#ifdef PFS_WITH_STATS
+        // from the rx interrupt if there is one, polled input from the read
+        uint32_t start_us = m_rx_pending ? m_rx_time_us : time_us_32();
+        m_rx_pending = false;
+#endif // PFS_WITH_STATS
+        for (size_t i = 0; i < len; i++) {
+            char c = buffer[i];
             if (c < 0 || c > 127) {
-                break;
+                continue;
             }
             pfs_io_handle_input_char(c);
         }
-        vTaskDelay(50 / portTICK_PERIOD_MS);
+#ifdef PFS_WITH_STATS
+        // the echo is written by the time the characters are handled
+        uint32_t latency_us = time_us_32() - start_us;
+        PFS_STATS_ADD(keystrokes, len);
+        PFS_STATS_ADD(echo_chunks, 1);
+        PFS_STATS_ADD(echo_latency_total_us, latency_us);
+        PFS_STATS_MAX(echo_latency_max_us, latency_us);
+#endif // PFS_WITH_STATS
+    }
+    // a sequence may continue in the next read, end it only after a pause
+    pfs_escape_sequence_expire(&session->input, _pfs_time_us());
+}
+
+/**
+ * `pfs_execute()` hands the command line over to the shell task, which runs it
+ * in a session of its own, served on a transport writing to the caller's sink.
+ * The state is modified with `m_capture_mutex` taken.
+ */
+typedef enum {
+    CAPTURE_IDLE,
+    CAPTURE_REQUESTED,
+    CAPTURE_RUNNING,
+} capture_state_t;
+
+static uint8_t
+        m_capture_queue_storage[PFS_MSG_QUEUE_SIZE * sizeof(pfs_message_t *)];
+static StaticQueue_t m_capture_queue_buffer;
+static SemaphoreHandle_t m_capture_mutex;
+static StaticSemaphore_t m_capture_mutex_buffer;
+static SemaphoreHandle_t m_capture_done;
+static StaticSemaphore_t m_capture_done_buffer;
+// serializes the callers of pfs_execute()
+static SemaphoreHandle_t m_execute_mutex;
+static StaticSemaphore_t m_execute_mutex_buffer;
+
+static capture_state_t m_capture_state;
+static char m_capture_line[PFS_MAX_INPUT_SIZE];
+static pfs_output_sink_t *m_capture_sink;
+// the caller has not timed out yet
+static bool m_capture_waiting;
+static int m_capture_result;
+
+static void sink_write(pfs_output_sink_t *sink, const char *data, size_t len) {
+    if (sink->callback != NULL) {
+        sink->callback(data, len, sink->arg);
+        return;
+    }
+    if (sink->buffer == NULL || sink->size == 0) {
+        return;
+    }
+    size_t space = sink->size - 1 - sink->len;
+    if (len > space) {
+        len = space;
+        sink->truncated = true;
+    }
+    memcpy(&sink->buffer[sink->len], data, len);
+    sink->len += len;
+    sink->buffer[sink->len] = '\0';
+}
+
+static int capture_transport_write(pfs_transport_t *transport,
+                                   const char *data,
+                                   size_t len,
+                                   pfs_transport_write_done_t done,
+                                   void *arg) {
+    (void) transport;
+    xSemaphoreTake(m_capture_mutex, portMAX_DELAY);
+    if (m_capture_sink != NULL) {
+        sink_write(m_capture_sink, data, len);
+    }
+    xSemaphoreGive(m_capture_mutex);
+    if (done != NULL) {
+        done(arg);
+    }
+    return 0;
+}
+
+static size_t capture_transport_read(pfs_transport_t *transport,
+                                     char *buffer,
+                                     size_t size) {
+    (void) transport;
+    (void) buffer;
+    (void) size;
+    return 0;
+}
+
+static void capture_transport_flush(pfs_transport_t *transport) {
+    (void) transport;
+}
+
+static const pfs_transport_vtable_t CAPTURE_TRANSPORT_VTABLE = {
+        .write = capture_transport_write,
+        .read = capture_transport_read,
+        .flush = capture_transport_flush,
+        .set_rx_callback = NULL,
+        .is_connected = NULL,
+};
+
+static pfs_transport_t m_capture_transport = {
+        .vtable = &CAPTURE_TRANSPORT_VTABLE,
+};
+
+// no prompt and no timestamps, the sequence prefix is left out as well
+static void drain_capture(pfs_session_t *session) {
+    while (true) {
+        pfs_message_t *msg;
+        xSemaphoreTake(m_msg_mutex, portMAX_DELAY);
+        BaseType_t ret = xQueueReceive(session->output_queue, &msg, 0);
+        xSemaphoreGive(m_msg_mutex);
+        if (ret != pdTRUE) {
+            break;
+        }
+        PFS_STATS_ADD(messages_emitted, 1);
+        PFS_STATS_ADD(bytes_emitted, msg->len);
+        (void) m_capture_transport.vtable->write(
+                &m_capture_transport, &msg->text[MESSAGE_PREFIX_LEN],
+                msg->len - MESSAGE_PREFIX_LEN, release_message, msg);
+    }
+    if (session->dropped_messages > 0) {
+        session->dropped_messages = 0;
+        xSemaphoreTake(m_capture_mutex, portMAX_DELAY);
+        if (m_capture_sink != NULL) {
+            m_capture_sink->truncated = true;
+        }
+        xSemaphoreGive(m_capture_mutex);
+    }
+}
+
+static void handle_capture(void) {
+    pfs_session_t *session = &m_capture_session;
+    xSemaphoreTake(m_capture_mutex, portMAX_DELAY);
+    bool requested = m_capture_state == CAPTURE_REQUESTED;
+    if (requested) {
+        m_capture_state = CAPTURE_RUNNING;
+    }
+    bool running = m_capture_state == CAPTURE_RUNNING;
+    xSemaphoreGive(m_capture_mutex);
+    if (!running) {
+        return;
+    }
+
+    pfs_session_set_current(session);
+    if (requested) {
+        m_capture_result = pfs_handle_shell_input(m_capture_line)
+                                   ? PFS_EXECUTE_FAILED
+                                   : PFS_EXECUTE_OK;
+    }
+    // checked before draining, the output of a finished command is all queued
+    bool finished =
+            __atomic_load_n(&session->commands_finished, __ATOMIC_ACQUIRE)
+            == session->commands_dispatched;
+    drain_capture(session);
+    if (!finished) {
+        return;
+    }
+
+    xSemaphoreTake(m_capture_mutex, portMAX_DELAY);
+    if (m_capture_waiting) {
+        m_capture_waiting = false;
+        xSemaphoreGive(m_capture_done);
+    }
+    m_capture_sink = NULL;
+    m_capture_state = CAPTURE_IDLE;
+    xSemaphoreGive(m_capture_mutex);
+}
+
+static void pfs_main_task(void *pvParameters) {
+    __atomic_store_n(&m_initialized, true, __ATOMIC_RELEASE);
+    while (true) {
+        __atomic_fetch_add(&m_quiescent_counter, 1, __ATOMIC_RELEASE);
+        bool escape_pending = false;
+        for (size_t i = 0; i < pfs_session_count(); i++) {
+            pfs_session_t *session = pfs_session_get(i);
+            pfs_session_set_current(session);
+            if (!handle_connection(session)) {
+                discard_messages(session);
+                continue;
+            }
+            handle_dropped_messages(session);
+            print_messages(session);
+            handle_input(session);
+            escape_pending |= session->escape.active;
+        }
+        handle_capture();
+        // come back in time to end an incomplete escape sequence
+        TickType_t idle = escape_pending ? ESCAPE_SEQUENCE_TIMEOUT_TICKS
+                                         : pdMS_TO_TICKS(PFS_MAIN_TASK_IDLE_MS);
+        (void) ulTaskNotifyTake(pdTRUE, idle);
+    }
+}
+
+#ifdef PFS_WITH_STATS
+// the handler task stack (growing down) is painted below the current frame
+// before every command and scanned after it, the margin keeps memset() off its
+// own frame. The paint is the FreeRTOS fill byte, so only what the last command
+// dirtied is repainted and the kernel high-water mark still reads right for the
+// last command; the lifetime peak is kept by pfs_cmd_stats.
+#define STACK_PAINT_BYTE (0xa5U)
+#define STACK_PAINT_WORD ((StackType_t) 0xa5a5a5a5a5a5a5a5ULL)
+#define STACK_PAINT_MARGIN (256U)
+
+// everything below is painted, the whole stack before the first command
+static StackType_t *m_handler_stack_dirty = m_pfs_cmd_handler_task_stack;
+
+static void paint_handler_stack(void) {
+    uint8_t *dirty = (uint8_t *) m_handler_stack_dirty;
+    uint8_t *frame = (uint8_t *) __builtin_frame_address(0);
+    if (frame > dirty + STACK_PAINT_MARGIN) {
+        memset(dirty, STACK_PAINT_BYTE,
+               (size_t) (frame - dirty) - STACK_PAINT_MARGIN);
+    }
+}
+
+static uint32_t handler_stack_words_used(void) {
+    const StackType_t *bottom = m_pfs_cmd_handler_task_stack;
+    size_t size = PFS_ARRAY_SIZE(m_pfs_cmd_handler_task_stack);
+    size_t untouched = 0;
+    while (untouched < size && bottom[untouched] == STACK_PAINT_WORD) {
+        untouched++;
     }
+    m_handler_stack_dirty = &m_pfs_cmd_handler_task_stack[untouched];
+    return (uint32_t) (size - untouched);
 }
+#endif // PFS_WITH_STATS
 
 static void pfs_cmd_handler_task(void *pvParameters) {
     while (1) {
@@ -126,21 +625,64 @@ static void pfs_cmd_handler_task(void *pvParameters) {
         if (cmd_args.handler == NULL) {
             continue;
         }
-        printf(PFS_IO_SHELL_MESSAGE_INF_BEGIN "entering command handler\n");
+        // the shell's own messages are left out of the captured output
+        bool captured = cmd_args.session == &m_capture_session;
+        m_handler_session = cmd_args.session;
+        if (!captured) {
+            printf(PFS_IO_SHELL_MESSAGE_INF_BEGIN "entering command handler\n");
+        }
         xSemaphoreTake(m_cmd_sem, portMAX_DELAY);
+#ifdef PFS_WITH_STATS
+        paint_handler_stack();
+#endif // PFS_WITH_STATS
+        uint32_t output_bytes = m_handler_output_bytes;
+        uint32_t start_us = time_us_32();
+        m_handler_pipe = cmd_args.pipe;
         cmd_args.handler(cmd_args.argc, cmd_args.argv);
+        if (m_handler_pipe != NULL) {
+            pfs_pipe_finish(m_handler_pipe, queue_handler_output);
+            m_handler_pipe = NULL;
+        }
+        uint32_t run_us = time_us_32() - start_us;
+#ifdef PFS_WITH_STATS
+        pfs_cmd_stats_record(cmd_args.command, run_us,
+                             handler_stack_words_used());
+#endif // PFS_WITH_STATS
         xSemaphoreGive(m_cmd_sem);
-        printf(PFS_IO_SHELL_MESSAGE_INF_BEGIN "leaving command handler\n");
+        if (cmd_args.timed) {
+            printf(PFS_IO_SHELL_MESSAGE_INF_BEGIN
+                   "time: lookup %lu us, queue %lu us, run %lu us, "
+                   "output %lu bytes\n",
+                   (unsigned long) cmd_args.lookup_us,
+                   (unsigned long) (start_us - cmd_args.queued_us),
+                   (unsigned long) run_us,
+                   (unsigned long) (m_handler_output_bytes - output_bytes));
+        }
+        if (!captured) {
+            printf(PFS_IO_SHELL_MESSAGE_INF_BEGIN "leaving command handler\n");
+        }
+        m_handler_session = NULL;
+        // after all of its output is queued
+        __atomic_fetch_add(&cmd_args.session->commands_finished, 1,
+                           __ATOMIC_RELEASE);
+        notify_main_task();
     }
 }
 
 void pfs_init(void) {
-    m_msg_queue = xQueueCreate(PFS_MSG_QUEUE_SIZE, sizeof(void *));
-    if (m_msg_queue == NULL) {
-        PFS_SHELL_LOG(ERR, "msg_queue initialization failed\n");
-        exit(1);
+    pfs_stdio_transport_init(&m_default_transport, NULL);
+    pfs_session_init_default(&m_default_transport.base);
+    for (size_t i = 0; i < pfs_session_count(); i++) {
+        pfs_session_t *session = pfs_session_get(i);
+        session->output_queue = xQueueCreateStatic(
+                PFS_MSG_QUEUE_SIZE, sizeof(pfs_message_t *),
+                m_output_queue_storage[i], &m_output_queue_buffers[i]);
+        if (session->output_queue == NULL) {
+            PFS_SHELL_LOG(ERR, "msg_queue initialization failed\n");
+            exit(1);
+        }
     }
-    m_msg_mutex = xSemaphoreCreateMutex();
+    m_msg_mutex = xSemaphoreCreateMutexStatic(&m_msg_mutex_buffer);
     if (m_msg_mutex == NULL) {
         PFS_SHELL_LOG(ERR, "msg_mutex initialization failed\n");
         exit(1);
@@ -155,33 +697,196 @@ void pfs_init(void) {
         PFS_SHELL_LOG(ERR, "cmd_sem initialization failed\n");
         exit(1);
     }
+    if (pfs_command_index_init()) {
+        PFS_SHELL_LOG(ERR, "command index initialization failed\n");
+        exit(1);
+    }
+    m_commands_mutex = xSemaphoreCreateMutexStatic(&m_commands_mutex_buffer);
+    if (m_commands_mutex == NULL) {
+        PFS_SHELL_LOG(ERR, "commands_mutex initialization failed\n");
+        exit(1);
+    }
+    pfs_session_init_detached(&m_capture_session, &m_capture_transport);
+    m_capture_session.output_queue = xQueueCreateStatic(
+            PFS_MSG_QUEUE_SIZE, sizeof(pfs_message_t *),
+            m_capture_queue_storage, &m_capture_queue_buffer);
+    m_capture_mutex = xSemaphoreCreateMutexStatic(&m_capture_mutex_buffer);
+    m_capture_done = xSemaphoreCreateBinaryStatic(&m_capture_done_buffer);
+    m_execute_mutex = xSemaphoreCreateMutexStatic(&m_execute_mutex_buffer);
+    if (m_capture_session.output_queue == NULL || m_capture_mutex == NULL
+        || m_capture_done == NULL || m_execute_mutex == NULL) {
+        PFS_SHELL_LOG(ERR, "pfs_execute initialization failed\n");
+        exit(1);
+    }
+#ifdef PFS_WITH_COMMAND_HISTORY
+    if (pfs_cmd_history_load(&pfs_session_get(0)->history)) {
+        PFS_SHELL_LOG(WRN, "stored command history is corrupted\n");
+    }
+#endif // PFS_WITH_COMMAND_HISTORY
 
-    (void) xTaskCreateStatic(pfs_cmd_handler_task, "PfsCmdHandlerTask",
-                             PFS_CMD_HANDLER_STACK_SIZE, NULL,
-                             tskIDLE_PRIORITY + PFS_TASK_PRIORITY,
-                             m_pfs_cmd_handler_task_stack,
-                             &m_psf_cmd_handler_task_buffer);
-    (void) xTaskCreateStatic(pfs_main_task, "PfsMainTask", PFS_MAIN_STACK_SIZE,
-                             NULL, tskIDLE_PRIORITY + PFS_TASK_PRIORITY,
-                             m_pfs_main_task_stack, &m_psf_main_task_buffer);
+    m_pfs_cmd_handler_task_handle = xTaskCreateStatic(
+            pfs_cmd_handler_task, "PfsCmdHandlerTask",
+            PFS_CMD_HANDLER_STACK_SIZE, NULL,
+            tskIDLE_PRIORITY + PFS_TASK_PRIORITY, m_pfs_cmd_handler_task_stack,
+            &m_psf_cmd_handler_task_buffer);
+    m_pfs_main_task_handle = xTaskCreateStatic(
+            pfs_main_task, "PfsMainTask", PFS_MAIN_STACK_SIZE, NULL,
+            tskIDLE_PRIORITY + PFS_TASK_PRIORITY, m_pfs_main_task_stack,
+            &m_psf_main_task_buffer);
+#ifdef PFS_WITH_STATS
+    pfs_stats_set_tasks(m_pfs_main_task_handle, PFS_MAIN_STACK_SIZE,
+                        m_pfs_cmd_handler_task_handle,
+                        PFS_CMD_HANDLER_STACK_SIZE);
+#endif // PFS_WITH_STATS
+    for (size_t i = 0; i < pfs_session_count(); i++) {
+        pfs_transport_t *transport = pfs_session_get(i)->transport;
+        if (transport->vtable->set_rx_callback != NULL) {
+            transport->vtable->set_rx_callback(
+                    transport, chars_available_callback, NULL);
+        }
+    }
 }
 
-void _pfs_append_queue(const char *buffer, uint32_t buffer_size) {
+static void push_message(pfs_session_t *session, pfs_message_t *msg) {
+    if (uxQueueSpacesAvailable(session->output_queue) == 0) {
+        drop_latest_message(session);
+    }
+    xQueueSendToBack(session->output_queue, &msg, portMAX_DELAY);
+    PFS_STATS_MAX(queue_high_water,
+                  (uint32_t) uxQueueMessagesWaiting(session->output_queue));
+}
+
+static void queue_message(pfs_session_t *target,
+                          const char *buffer,
+                          uint32_t buffer_size) {
     if (buffer_size == 0) {
         return;
     }
-    char *msg = malloc(buffer_size + 1);
+#ifdef PFS_WITH_MESSAGE_TIMESTAMPS
+    uint64_t time_us = time_us_64();
+#endif // PFS_WITH_MESSAGE_TIMESTAMPS
+    pfs_message_t *msg =
+            malloc(sizeof(pfs_message_t) + MESSAGE_PREFIX_LEN + buffer_size + 1);
     if (msg == NULL) {
+#ifdef PFS_WITH_STATS
+        xSemaphoreTake(m_msg_mutex, portMAX_DELAY);
+        PFS_STATS_ADD(drops_no_memory, 1);
+        xSemaphoreGive(m_msg_mutex);
+#endif // PFS_WITH_STATS
         PFS_SHELL_LOG(ERR, "failed to allocate memory for message\n");
         return;
     }
-    memset(msg, 0, buffer_size + 1);
-    memcpy(msg, buffer, buffer_size);
+    memcpy(&msg->text[MESSAGE_PREFIX_LEN], buffer, buffer_size);
+    msg->text[MESSAGE_PREFIX_LEN + buffer_size] = '\0';
+    msg->len = MESSAGE_PREFIX_LEN + buffer_size;
+#ifdef PFS_WITH_MESSAGE_TIMESTAMPS
+    msg->time_us = time_us;
+#endif // PFS_WITH_MESSAGE_TIMESTAMPS
 
     xSemaphoreTake(m_msg_mutex, portMAX_DELAY);
-    if (uxQueueSpacesAvailable(m_msg_queue) == 0) {
-        drop_latest_message();
+#ifdef PFS_WITH_OUTPUT_SEQUENCE
+    // numbered under the lock, so in the order the messages are queued in
+    pfs_output_sequence_stamp(xTaskGetCurrentTaskHandle(), msg->text);
+#endif // PFS_WITH_OUTPUT_SEQUENCE
+#ifdef PFS_WITH_DMESG
+    pfs_dmesg_write(buffer, buffer_size);
+#endif // PFS_WITH_DMESG
+    PFS_STATS_ADD(messages_enqueued, 1);
+    PFS_STATS_ADD(bytes_enqueued, buffer_size);
+    if (target != NULL) {
+        msg->references = 1;
+        push_message(target, msg);
+    } else {
+        msg->references = pfs_session_count();
+        for (size_t i = 0; i < pfs_session_count(); i++) {
+            push_message(pfs_session_get(i), msg);
+        }
     }
-    xQueueSendToBack(m_msg_queue, &msg, portMAX_DELAY);
     xSemaphoreGive(m_msg_mutex);
+    notify_main_task();
+}
+
+static void queue_handler_output(const char *data, size_t len) {
+    queue_message(m_handler_session, data, (uint32_t) len);
+}
+
+void _pfs_append_queue(const char *buffer, uint32_t buffer_size) {
+    // output of a command goes (through its filters, if piped) to the session
+    // it was issued from, everything else is printed by all sessions
+    if (xTaskGetCurrentTaskHandle() == m_pfs_cmd_handler_task_handle) {
+        m_handler_output_bytes += buffer_size;
+        if (m_handler_pipe != NULL) {
+            pfs_pipe_write(m_handler_pipe, buffer, buffer_size,
+                           queue_handler_output);
+        } else {
+            queue_handler_output(buffer, buffer_size);
+        }
+        return;
+    }
+    queue_message(NULL, buffer, buffer_size);
+}
+
+static int wait_for_capture(TickType_t timeout) {
+    if (xSemaphoreTake(m_capture_done, timeout) == pdTRUE) {
+        return m_capture_result;
+    }
+    int ret = PFS_EXECUTE_TIMEOUT;
+    xSemaphoreTake(m_capture_mutex, portMAX_DELAY);
+    if (xSemaphoreTake(m_capture_done, 0) == pdTRUE) {
+        // finished in the meantime
+        ret = m_capture_result;
+    } else {
+        // the command is left running, its output is discarded
+        m_capture_waiting = false;
+        m_capture_sink = NULL;
+        if (m_capture_state == CAPTURE_REQUESTED) {
+            m_capture_state = CAPTURE_IDLE;
+        }
+    }
+    xSemaphoreGive(m_capture_mutex);
+    return ret;
+}
+
+int pfs_execute(const char *line, pfs_output_sink_t *sink, TickType_t timeout) {
+    if (sink != NULL) {
+        sink->len = 0;
+        sink->truncated = false;
+        if (sink->buffer != NULL && sink->size > 0) {
+            sink->buffer[0] = '\0';
+        }
+    }
+    if (line == NULL || strlen(line) >= PFS_MAX_INPUT_SIZE) {
+        return PFS_EXECUTE_FAILED;
+    }
+    // the shell tasks would wait for themselves
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    if (!__atomic_load_n(&m_initialized, __ATOMIC_ACQUIRE)
+        || task == m_pfs_main_task_handle
+        || task == m_pfs_cmd_handler_task_handle) {
+        return PFS_EXECUTE_BUSY;
+    }
+
+    TimeOut_t time_out;
+    vTaskSetTimeOutState(&time_out);
+    if (xSemaphoreTake(m_execute_mutex, timeout) != pdTRUE) {
+        return PFS_EXECUTE_TIMEOUT;
+    }
+    int ret = PFS_EXECUTE_BUSY;
+    xSemaphoreTake(m_capture_mutex, portMAX_DELAY);
+    if (m_capture_state == CAPTURE_IDLE) {
+        strcpy(m_capture_line, line);
+        m_capture_sink = sink;
+        m_capture_waiting = true;
+        m_capture_state = CAPTURE_REQUESTED;
+        ret = PFS_EXECUTE_OK;
+    }
+    xSemaphoreGive(m_capture_mutex);
+    if (ret == PFS_EXECUTE_OK) {
+        notify_main_task();
+        // the time spent waiting for other callers counts as well
+        (void) xTaskCheckForTimeOut(&time_out, &timeout);
+        ret = wait_for_capture(timeout);
+    }
+    xSemaphoreGive(m_execute_mutex);
+    return ret;
 }
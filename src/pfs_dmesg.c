@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "pfs_dmesg.h"
+#include "pfs_io.h"
+#include "pfs_log.h"
+
+void _pfs_output_lock(void);
+void _pfs_output_unlock(void);
+
+// the ring keeps the bytes [m_first, m_written) of all output ever queued, the
+// positions are counted with 64 bits so they never wrap
+static char m_ring[PFS_DMESG_SIZE];
+static size_t m_head;
+static uint64_t m_written;
+static uint64_t m_first;
+// the oldest line kept has (most likely) lost its beginning
+static bool m_truncated;
+
+static size_t ring_index(uint64_t position) {
+    return (m_head + PFS_DMESG_SIZE - (size_t) (m_written - position))
+           % PFS_DMESG_SIZE;
+}
+
+void pfs_dmesg_write(const char *data, size_t len) {
+    m_written += len;
+    if (len > PFS_DMESG_SIZE) {
+        data += len - PFS_DMESG_SIZE;
+        len = PFS_DMESG_SIZE;
+    }
+    while (len > 0) {
+        size_t chunk = PFS_DMESG_SIZE - m_head;
+        if (chunk > len) {
+            chunk = len;
+        }
+        memcpy(&m_ring[m_head], data, chunk);
+        m_head = (m_head + chunk) % PFS_DMESG_SIZE;
+        data += chunk;
+        len -= chunk;
+    }
+    if (m_written - m_first > PFS_DMESG_SIZE) {
+        m_first = m_written - PFS_DMESG_SIZE;
+        m_truncated = true;
+    }
+}
+
+void pfs_dmesg_clear(void) {
+    _pfs_output_lock();
+    m_first = m_written;
+    m_truncated = false;
+    _pfs_output_unlock();
+}
+
+// copies the next line (or its part, if it does not fit) to @p line, the lock
+// is only held for a single line so producers are not stalled by the printing
+static size_t read_line(uint64_t *cursor,
+                        uint64_t end,
+                        bool *line_start,
+                        char *line,
+                        size_t size) {
+    _pfs_output_lock();
+    if (*cursor < m_first) {
+        // overwritten (or cleared) in the meantime
+        *cursor = m_first;
+        *line_start = true;
+        while (m_truncated && *cursor < end
+               && m_ring[ring_index((*cursor)++)] != '\n') {
+        }
+    }
+    size_t len = 0;
+    while (*cursor < end && len < size - 1) {
+        char c = m_ring[ring_index((*cursor)++)];
+        line[len++] = c;
+        if (c == '\n') {
+            break;
+        }
+    }
+    line[len] = '\0';
+    _pfs_output_unlock();
+    return len;
+}
+
+// looks for @p text in the whole line starting at @p cursor, part by part; the
+// end of the previous part is kept in front of the next one, so a match may
+// span two parts
+static bool line_contains(uint64_t cursor, uint64_t end, const char *text) {
+    size_t text_len = strlen(text);
+    if (text_len == 0) {
+        return true;
+    }
+    char window[PFS_MAX_INPUT_SIZE + PFS_DMESG_LINE_SIZE];
+    size_t kept = 0;
+    bool overwritten = false;
+    size_t len;
+    while ((len = read_line(&cursor, end, &overwritten, window + kept,
+                            PFS_DMESG_LINE_SIZE))
+           > 0) {
+        if (overwritten) {
+            // gone, it won't be printed either
+            return false;
+        }
+        if (strstr(window, text) != NULL) {
+            return true;
+        }
+        size_t total = kept + len;
+        if (window[total - 1] == '\n') {
+            return false;
+        }
+        kept = text_len - 1 < total ? text_len - 1 : total;
+        memmove(window, window + total - kept, kept);
+    }
+    return false;
+}
+
+static void print_lines(uint8_t level, const char *text) {
+    _pfs_output_lock();
+    uint64_t end = m_written;
+    _pfs_output_unlock();
+
+    char line[PFS_DMESG_LINE_SIZE];
+    uint64_t cursor = 0;
+    bool line_start = true;
+    bool selected = false;
+    bool line_open = false;
+    size_t len;
+    while ((len = read_line(&cursor, end, &line_start, line, sizeof(line)))
+           > 0) {
+        // a line is selected by its beginning (level) and its whole text,
+        // then all of its parts are printed or none
+        if (line_start) {
+            if (line_open) {
+                // the rest of the line printed last has been overwritten
+                pfs_io_puts_immediately("\n");
+                line_open = false;
+            }
+            uint8_t line_level = pfs_log_line_level(line);
+            selected = (level == PFS_LOG_LEVEL_OFF
+                        || (line_level != PFS_LOG_LEVEL_OFF
+                            && line_level <= level))
+                       && (text == NULL
+                           || line_contains(cursor - len, end, text));
+        }
+        line_start = line[len - 1] == '\n';
+        if (selected) {
+            pfs_io_puts_immediately(line);
+            line_open = !line_start;
+        }
+    }
+    if (line_open) {
+        pfs_io_puts_immediately("\n");
+    }
+}
+
+int pfs_dmesg_command(int argc, char **argv) {
+    if (argc == 1 && strcmp(argv[0], "-c") == 0) {
+        pfs_dmesg_clear();
+        return 0;
+    }
+    uint8_t level = PFS_LOG_LEVEL_OFF;
+    int arg = 0;
+    bool valid = true;
+    if (argc > 0 && strcmp(argv[0], "-l") == 0) {
+        valid = argc >= 2 && !pfs_log_parse_level(argv[1], &level)
+                && level != PFS_LOG_LEVEL_OFF;
+        arg = 2;
+    }
+    if (!valid || argc - arg > 1) {
+        PFS_SHELL_LOG(WRN, "usage: dmesg [-l <err|wrn|inf|dbg>] [<text>] "
+                           "or dmesg -c\n");
+        return 1;
+    }
+    print_lines(level, arg < argc ? argv[arg] : NULL);
+    return 0;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#ifndef PFS_DMESG_SIZE
+#define PFS_DMESG_SIZE (4096U)
+#endif // PFS_DMESG_SIZE
+
+// longer lines are filtered and printed in parts, the buffer is on the shell
+// task stack
+#ifndef PFS_DMESG_LINE_SIZE
+#define PFS_DMESG_LINE_SIZE (128U)
+#endif // PFS_DMESG_LINE_SIZE
+
+/**
+ * @brief Appends queued output to the ring, overwriting its oldest bytes.
+ *        Called with the output lock taken.
+ */
+void pfs_dmesg_write(const char *data, size_t len);
+
+void pfs_dmesg_clear(void);
+
+/**
+ * @brief Handles the `dmesg` built-in command
+ *        (`dmesg [-l <err|wrn|inf|dbg>] [<text>]` or `dmesg -c`).
+ */
+int pfs_dmesg_command(int argc, char **argv);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
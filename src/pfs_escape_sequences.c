@@ -32,30 +32,42 @@
 #include "pfs_io.h"
 
 #ifdef PFS_WITH_COMMAND_HISTORY
+static void show_history_entry(size_t offset) {
+    pfs_input_buffer_t entry;
+    if (!pfs_cmd_history_get(pfs_cmd_history_get_buff_ptr(), offset, &entry)) {
+        *pfs_cmd_history_get_offset_ptr() = offset;
+        pfs_io_replace_input(&entry);
+    }
+}
+
+// the line typed before browsing the history filters the entries by prefix
 void pfs_esc_seq_arrow_up(pfs_input_buffer_t *input_buffer) {
     size_t *offset = pfs_cmd_history_get_offset_ptr();
     pfs_cmd_history_t *cmd_buff = pfs_cmd_history_get_buff_ptr();
     if (*offset == 0) {
         (void) pfs_cmd_history_update_newest(cmd_buff, input_buffer);
     }
-    if (!pfs_cmd_history_get(cmd_buff, (*offset) + 1, input_buffer)) {
-        (*offset)++;
-        pfs_io_remove_shell_prompt();
-        pfs_io_restore_shell_prompt();
+    size_t found;
+    if (!pfs_cmd_history_find(cmd_buff, *offset, true, cmd_buff->newest.buffer,
+                              cmd_buff->newest.len, true, &found)) {
+        show_history_entry(found);
     }
 }
 
 void pfs_esc_seq_arrow_down(pfs_input_buffer_t *input_buffer) {
+    (void) input_buffer;
     size_t *offset = pfs_cmd_history_get_offset_ptr();
     pfs_cmd_history_t *cmd_buff = pfs_cmd_history_get_buff_ptr();
     if (*offset == 0) {
         return;
     }
-    if (!pfs_cmd_history_get(cmd_buff, (*offset) - 1, input_buffer)) {
-        (*offset)--;
-        pfs_io_remove_shell_prompt();
-        pfs_io_restore_shell_prompt();
+    size_t found;
+    if (pfs_cmd_history_find(cmd_buff, *offset, false, cmd_buff->newest.buffer,
+                             cmd_buff->newest.len, true, &found)) {
+        // no newer match, go back to the line typed before browsing
+        found = 0;
     }
+    show_history_entry(found);
 }
 #endif // PFS_WITH_COMMAND_HISTORY
 
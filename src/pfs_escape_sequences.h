@@ -22,12 +22,33 @@
 
 #pragma once
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
 #include "pfs_io.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif // __cplusplus
 
+// longest escape sequence that can be received (without the escape character)
+#define PFS_ESCAPE_SEQUENCE_MAX_LEN 10
+
+// a sequence may be split across reads, it is ended only if no byte of it has
+// arrived for this long
+#ifndef PFS_ESCAPE_SEQUENCE_TIMEOUT_US
+#define PFS_ESCAPE_SEQUENCE_TIMEOUT_US (5000U)
+#endif // PFS_ESCAPE_SEQUENCE_TIMEOUT_US
+
+typedef struct {
+    bool active;
+    char buffer[PFS_ESCAPE_SEQUENCE_MAX_LEN + 1];
+    size_t len;
+    // when the last byte of the sequence was received
+    uint32_t last_us;
+} pfs_escape_state_t;
+
 typedef void (*pfs_escape_sequence_handler_t)(pfs_input_buffer_t *input_buffer);
 
 typedef struct {
@@ -35,7 +56,21 @@ typedef struct {
     pfs_escape_sequence_handler_t handler;
 } pfs_escape_sequence_t;
 
+/**
+ * Escape sequences are parsed character by character using the state of the
+ * current session. `pfs_handle_esacpe_sequence()` starts a sequence after the
+ * escape character, `pfs_escape_sequence_handle_char()` consumes the following
+ * characters (returns false if no sequence is being parsed) and
+ * `pfs_escape_sequence_flush()` ends an incomplete sequence.
+ * `pfs_escape_sequence_expire()` ends it only once
+ * `PFS_ESCAPE_SEQUENCE_TIMEOUT_US` have passed since its last byte, so a
+ * sequence split across reads is still recognized.
+ */
 void pfs_handle_esacpe_sequence(pfs_input_buffer_t *input_buffer);
+bool pfs_escape_sequence_handle_char(pfs_input_buffer_t *input_buffer, char c);
+void pfs_escape_sequence_flush(pfs_input_buffer_t *input_buffer);
+void pfs_escape_sequence_expire(pfs_input_buffer_t *input_buffer,
+                                uint32_t now_us);
 
 #ifdef PFS_WITH_COMMAND_HISTORY
 void pfs_esc_seq_arrow_up(pfs_input_buffer_t *input_buffer);
@@ -28,18 +28,15 @@
 #include <pico_freertos_shell/commands.h>
 
 #include "pfs_cmd_queue.h"
+#include "pfs_cmd_stats.h"
+#include "pfs_command_index.h"
+#include "pfs_dmesg.h"
 #include "pfs_handle_shell_input.h"
 #include "pfs_io.h"
-
-static const pfs_command_t *m_commands = NULL;
-static size_t m_number_of_commands = 0;
-
-#ifdef PFS_WITH_TESTS
-void pfs_reset_commands(void) {
-    m_number_of_commands = 0;
-    m_commands = NULL;
-}
-#endif // PFS_WITH_TESTS
+#include "pfs_log.h"
+#include "pfs_pipe.h"
+#include "pfs_session.h"
+#include "pfs_stats.h"
 
 static const pfs_command_t HELP_COMMAND = {
         .description = {.name = "help",
@@ -58,29 +55,75 @@ static const pfs_command_t HELPTREE_COMMAND = {
         .number_of_subcommands = 0,
 };
 
-static const pfs_command_t m_aditional_commands[] = {HELP_COMMAND,
-                                                     HELPTREE_COMMAND};
+static const pfs_command_t TIME_COMMAND = {
+        .description = {.name = "time",
+                        .help = "run a command and display its lookup, queue "
+                                "and run times and output size"},
+        .handler = NULL,
+        .subcommands = NULL,
+        .number_of_subcommands = 0,
+};
 
-#define PFS_ADDITIONAL_COMMANDS_SIZE \
-    (sizeof(m_aditional_commands) / sizeof(pfs_command_t))
+static const pfs_command_t LOGLEVEL_COMMAND = {
+        .description = {.name = "loglevel",
+                        .help = "display or set log levels, e.g. 'loglevel "
+                                "sensor dbg' or 'loglevel all off'"},
+        .handler = NULL,
+        .subcommands = NULL,
+        .number_of_subcommands = 0,
+};
 
-void pfs_set_commands(const pfs_command_t *commands,
-                      size_t number_of_commands) {
-    m_commands = commands;
-    m_number_of_commands = number_of_commands + PFS_ADDITIONAL_COMMANDS_SIZE;
-}
+#ifdef PFS_WITH_STATS
+static const pfs_command_t STATS_COMMAND = {
+        .description = {.name = "stats",
+                        .help = "display statistics of the shell, 'stats "
+                                "reset' clears them"},
+        .handler = NULL,
+        .subcommands = NULL,
+        .number_of_subcommands = 0,
+};
 
-size_t pfs_get_number_of_commands(void) {
-    if (m_number_of_commands > 0) {
-        return m_number_of_commands;
-    }
-    return PFS_ADDITIONAL_COMMANDS_SIZE;
-}
+static const pfs_command_t CMDSTATS_COMMAND = {
+        .description = {.name = "cmdstats",
+                        .help = "display call counts, execution times and "
+                                "stack usage of commands, sorted by 'calls', "
+                                "'total' (default), 'avg', 'max', 'last' or "
+                                "'stack', 'cmdstats reset' clears them"},
+        .handler = NULL,
+        .subcommands = NULL,
+        .number_of_subcommands = 0,
+};
+#endif // PFS_WITH_STATS
+
+#ifdef PFS_WITH_DMESG
+static const pfs_command_t DMESG_COMMAND = {
+        .description = {.name = "dmesg",
+                        .help = "display the latest output kept in RAM, "
+                                "'-l wrn' limits it to PFS_LOG() messages of "
+                                "that level or above, a text to the lines "
+                                "containing it, 'dmesg -c' clears it"},
+        .handler = NULL,
+        .subcommands = NULL,
+        .number_of_subcommands = 0,
+};
+#endif // PFS_WITH_DMESG
+
+static const pfs_command_t m_aditional_commands[] = {
+        HELP_COMMAND,
+        HELPTREE_COMMAND,
+        TIME_COMMAND,
+        LOGLEVEL_COMMAND,
+#ifdef PFS_WITH_STATS
+        STATS_COMMAND,
+        CMDSTATS_COMMAND,
+#endif // PFS_WITH_STATS
+#ifdef PFS_WITH_DMESG
+        DMESG_COMMAND,
+#endif // PFS_WITH_DMESG
+};
 
-const pfs_command_t *pfs_get_commands(void) {
-    // does not include HELP_COMMAND and HELPTREE_COMMAND
-    return m_commands;
-}
+#define PFS_ADDITIONAL_COMMANDS_SIZE \
+    (sizeof(m_aditional_commands) / sizeof(pfs_command_t))
 
 const pfs_command_t *pfs_get_aditional_commands(size_t *out_len) {
     if (out_len != NULL) {
@@ -89,6 +132,12 @@ const pfs_command_t *pfs_get_aditional_commands(size_t *out_len) {
     return m_aditional_commands;
 }
 
+uint32_t _pfs_time_us(void);
+
+// `|` outside quotes is a token of its own, told apart from a quoted "|"
+// argument by its address
+static char m_pipe_separator[] = "|";
+
 #define RET_UNCLOSED_QUOTE -1
 #define RET_NO_SPACE_AFTER_QUOTE -2
 #define RET_INTERNAL_BUFFER_TOO_SMALL -3
@@ -108,7 +157,8 @@ int pfs_custom_tokenizer(char *input,
             if (*current != '"') {
                 break;
             }
-            if (*(current + 1) != ' ' && *(current + 1) != '\0') {
+            if (*(current + 1) != ' ' && *(current + 1) != '\0'
+                && *(current + 1) != '|') {
                 return RET_NO_SPACE_AFTER_QUOTE;
             }
             *current = '\0';
@@ -130,6 +180,19 @@ int pfs_custom_tokenizer(char *input,
                 (*out_argc)++;
                 token_start = NULL;
                 break;
+            case '|':
+                *current = '\0';
+                if (token_start != NULL) {
+                    argv[*out_argc] = token_start;
+                    (*out_argc)++;
+                    token_start = NULL;
+                    if (*out_argc >= max_argc) {
+                        return RET_INTERNAL_BUFFER_TOO_SMALL;
+                    }
+                }
+                argv[*out_argc] = m_pipe_separator;
+                (*out_argc)++;
+                break;
             case '"':
                 if (*(current + 1) != '\0') {
                     token_start = current + 1;
@@ -163,62 +226,6 @@ int pfs_custom_tokenizer(char *input,
     return 0;
 }
 
-static int sort_commands_by_name(const void *a, const void *b) {
-    const pfs_command_t *command_a = (const pfs_command_t *) a;
-    const pfs_command_t *command_b = (const pfs_command_t *) b;
-
-    return strcmp(command_a->description.name, command_b->description.name);
-}
-
-const pfs_command_t *
-pfs_get_subcommands_sorted_by_name_dynamic(const pfs_command_t *subcommands,
-                                           size_t number_of_subcommands) {
-    pfs_command_t *sorted_subcommands =
-            malloc(number_of_subcommands * sizeof(pfs_command_t));
-    if (sorted_subcommands == NULL) {
-        PFS_SHELL_LOG(ERR,
-                      "*** failed to allocate memory for sorted subcommands\n");
-        return NULL;
-    }
-
-    memcpy(sorted_subcommands, subcommands,
-           number_of_subcommands * sizeof(pfs_command_t));
-    qsort(sorted_subcommands, number_of_subcommands, sizeof(pfs_command_t),
-          sort_commands_by_name);
-
-    return sorted_subcommands;
-}
-
-const pfs_command_t *
-pfs_get_core_commands_sorted_by_name_dynamic(size_t *out_number_of_commands) {
-    pfs_command_t *sorted_commands =
-            malloc((pfs_get_number_of_commands()) * sizeof(pfs_command_t));
-    if (sorted_commands == NULL) {
-        PFS_SHELL_LOG(ERR,
-                      "*** failed to allocate memory for sorted commands\n");
-        return NULL;
-    }
-
-    if (m_commands) {
-        memcpy(sorted_commands, m_commands,
-               (pfs_get_number_of_commands() - PFS_ADDITIONAL_COMMANDS_SIZE)
-                       * sizeof(pfs_command_t));
-    }
-    memcpy(sorted_commands + (pfs_get_number_of_commands() - 1), &HELP_COMMAND,
-           sizeof(pfs_command_t));
-    memcpy(sorted_commands + (pfs_get_number_of_commands() - 2),
-           &HELPTREE_COMMAND, sizeof(pfs_command_t));
-
-    qsort(sorted_commands, pfs_get_number_of_commands(), sizeof(pfs_command_t),
-          sort_commands_by_name);
-
-    if (out_number_of_commands != NULL) {
-        *out_number_of_commands = pfs_get_number_of_commands();
-    }
-
-    return sorted_commands;
-}
-
 int pfs_command_has_subcommands(const pfs_command_t *command) {
     if (command == NULL) {
         return 0;
@@ -226,31 +233,30 @@ int pfs_command_has_subcommands(const pfs_command_t *command) {
     return command->number_of_subcommands > 0;
 }
 
-const pfs_command_t *pfs_find_command_by_name(const pfs_command_t *commands,
-                                              const char *name,
-                                              size_t number_of_commands) {
-    if (commands == m_commands && name != NULL) {
-        if (strcmp(name, "help") == 0) {
-            return &HELP_COMMAND;
-        } else if (strcmp(name, "helptree") == 0) {
-            return &HELPTREE_COMMAND;
-        }
-        number_of_commands -= PFS_ADDITIONAL_COMMANDS_SIZE;
-    }
-
-    if (commands == NULL || name == NULL) {
-        return NULL;
-    }
+static const pfs_command_index_node_t *
+find_command(const pfs_command_index_t *index,
+             const pfs_command_index_node_t *parent,
+             const char *name) {
+    size_t len;
+    const pfs_command_index_node_t *nodes =
+            pfs_command_index_children(index, parent, &len);
+    return pfs_command_index_find(nodes, len, name, strlen(name));
+}
 
-    const pfs_command_t *curr_command = commands;
-    for (size_t i = 0; i < number_of_commands; i++) {
-        if (strcmp(curr_command->description.name, name) == 0) {
-            return curr_command;
+// the command chain is printed word by word, so it needs no buffer
+static void print_command_chain(char *argv[], size_t argc) {
+    for (size_t i = 0; i < argc; i++) {
+        if (i > 0) {
+            pfs_io_putchar_immediately(' ');
         }
-        curr_command++;
+        pfs_io_puts_immediately(argv[i]);
     }
+}
 
-    return NULL;
+static void print_subcommands_hint(char *argv[], size_t argc) {
+    PFS_SHELL_LOG(WRN, "type 'help ");
+    print_command_chain(argv, argc);
+    pfs_io_puts_immediately("' for a list of available subcommands\n");
 }
 
 static void print_tabs(size_t level) {
@@ -259,129 +265,102 @@ static void print_tabs(size_t level) {
     }
 }
 
-static int handle_helptree_command(const pfs_command_t *subcommand, int level) {
-    if (subcommand == NULL) {
-        return 0;
-    }
-
-    if (!pfs_command_has_subcommands(subcommand)) {
-        return 0;
-    }
-
-    const pfs_command_t *sorted_subcommands =
-            pfs_get_subcommands_sorted_by_name_dynamic(
-                    subcommand->subcommands, subcommand->number_of_subcommands);
-    if (sorted_subcommands == NULL) {
-        return 1;
-    }
-    for (size_t i = 0; i < subcommand->number_of_subcommands; i++) {
+static void handle_helptree_command(const pfs_command_index_t *index,
+                                    const pfs_command_index_node_t *node,
+                                    int level) {
+    size_t len;
+    const pfs_command_index_node_t *subcommands =
+            pfs_command_index_children(index, node, &len);
+    for (size_t i = 0; i < len; i++) {
         PFS_SHELL_LOG(INF, "");
         print_tabs(level);
         pfs_io_printf_immediately(PFS_IO_BOLD_ON "%s" PFS_IO_BOLD_OFF " - %s\n",
-                                  sorted_subcommands[i].description.name,
-                                  sorted_subcommands[i].description.help);
-        if (handle_helptree_command(&sorted_subcommands[i], level + 1)) {
-            free((void *) sorted_subcommands);
-            return 1;
-        }
+                                  subcommands[i].command->description.name,
+                                  subcommands[i].command->description.help);
+        handle_helptree_command(index, &subcommands[i], level + 1);
     }
-    free((void *) sorted_subcommands);
-
-    return 0;
 }
 
-static int handle_help_command(char *argv[], int argc, bool helptree) {
+static int handle_help_command(const pfs_command_index_t *index,
+                               char *argv[],
+                               int argc,
+                               bool helptree) {
     if (argc == 0) {
-        const pfs_command_t *sorted_commands =
-                pfs_get_core_commands_sorted_by_name_dynamic(NULL);
-        if (sorted_commands == NULL) {
-            return 1;
-        }
-
         PFS_SHELL_LOG(INF, "Available commands:\n");
-        for (size_t i = 0; i < pfs_get_number_of_commands(); i++) {
+        size_t len;
+        const pfs_command_index_node_t *commands =
+                pfs_command_index_children(index, NULL, &len);
+        for (size_t i = 0; i < len; i++) {
             PFS_SHELL_LOG(INF,
                           PFS_IO_TAB PFS_IO_BOLD_ON "%s" PFS_IO_BOLD_OFF
                                                     " - %s\n",
-                          sorted_commands[i].description.name,
-                          sorted_commands[i].description.help);
+                          commands[i].command->description.name,
+                          commands[i].command->description.help);
             if (helptree) {
-                if (handle_helptree_command(
-                            (const pfs_command_t *) &sorted_commands[i], 2)) {
-                    free((void *) sorted_commands);
-                    return 1;
-                }
+                handle_helptree_command(index, &commands[i], 2);
             }
         }
 
-        free((void *) sorted_commands);
         return 0;
     }
 
-    char message_chain[PFS_MAX_INPUT_SIZE];
-    memset(message_chain, 0, sizeof(message_chain));
-    snprintf(message_chain, sizeof(message_chain), "%s", argv[0]);
-    const pfs_command_t *command =
-            pfs_find_command_by_name(m_commands, argv[0], m_number_of_commands);
-    if (command == NULL) {
-        PFS_SHELL_LOG(WRN, "%s: command not found\n", message_chain);
+    const pfs_command_index_node_t *node = find_command(index, NULL, argv[0]);
+    if (node == NULL) {
+        PFS_SHELL_LOG(WRN, "%s: command not found\n", argv[0]);
         PFS_SHELL_LOG(WRN, "type 'help' for a list of available commands\n");
         return 1;
     }
 
     size_t iterator = 1;
     while (iterator < argc) {
-        if (!pfs_command_has_subcommands(command)) {
-            PFS_SHELL_LOG(WRN, "no help entry for '%s %s'\n", message_chain,
-                          argv[iterator]);
+        if (!pfs_command_has_subcommands(node->command)) {
+            PFS_SHELL_LOG(WRN, "no help entry for '");
+            print_command_chain(argv, iterator + 1);
+            pfs_io_puts_immediately("'\n");
             return 1;
         }
-        command = pfs_find_command_by_name(command->subcommands, argv[iterator],
-                                           command->number_of_subcommands);
-        if (command == NULL) {
-            PFS_SHELL_LOG(WRN, "%s %s: command not found'\n", message_chain,
-                          argv[iterator]);
-            PFS_SHELL_LOG(
-                    WRN, "type 'help %s' for a list of available subcommands\n",
-                    message_chain);
+        node = find_command(index, node, argv[iterator]);
+        if (node == NULL) {
+            PFS_SHELL_LOG(WRN, "");
+            print_command_chain(argv, iterator + 1);
+            pfs_io_puts_immediately(": command not found'\n");
+            print_subcommands_hint(argv, iterator);
             return 1;
         }
-        strcat(message_chain, " ");
-        strcat(message_chain, argv[iterator]);
         iterator++;
     }
 
     PFS_SHELL_LOG(INF, "Description:\n");
-    PFS_SHELL_LOG(INF, PFS_IO_TAB "%s\n", command->description.help);
+    PFS_SHELL_LOG(INF, PFS_IO_TAB "%s\n", node->command->description.help);
     PFS_SHELL_LOG(INF, "Avalable subcommands:\n");
-    if (pfs_command_has_subcommands(command)) {
+    if (pfs_command_has_subcommands(node->command)) {
         if (helptree) {
-            if (handle_helptree_command(command, 1)) {
-                return 1;
-            }
+            handle_helptree_command(index, node, 1);
             return 0;
         }
-        const pfs_command_t *sorted_subcommands =
-                pfs_get_subcommands_sorted_by_name_dynamic(
-                        command->subcommands, command->number_of_subcommands);
-        for (size_t i = 0; i < command->number_of_subcommands; i++) {
+        size_t len;
+        const pfs_command_index_node_t *subcommands =
+                pfs_command_index_children(index, node, &len);
+        for (size_t i = 0; i < len; i++) {
             PFS_SHELL_LOG(INF,
                           PFS_IO_TAB PFS_IO_BOLD_ON "%s" PFS_IO_BOLD_OFF
                                                     " - %s\n",
-                          sorted_subcommands[i].description.name,
-                          sorted_subcommands[i].description.help);
+                          subcommands[i].command->description.name,
+                          subcommands[i].command->description.help);
         }
-        free((void *) sorted_subcommands);
     } else {
-        PFS_SHELL_LOG(INF, PFS_IO_TAB "no subcommands available for '%s'\n",
-                      message_chain);
+        PFS_SHELL_LOG(INF, PFS_IO_TAB "no subcommands available for '");
+        print_command_chain(argv, argc);
+        pfs_io_puts_immediately("'\n");
     }
 
     return 0;
 }
 
-static pfs_command_handler_t
-find_command_handler(char *argv[], int argc, size_t *out_level) {
+static const pfs_command_t *find_leaf_command(const pfs_command_index_t *index,
+                                             char *argv[],
+                                             int argc,
+                                             size_t *out_level) {
     if (!out_level) {
         return NULL;
     }
@@ -391,9 +370,8 @@ find_command_handler(char *argv[], int argc, size_t *out_level) {
         return NULL;
     }
 
-    const pfs_command_t *curr_command =
-            pfs_find_command_by_name(pfs_get_commands(), argv[0],
-                                     pfs_get_number_of_commands());
+    const pfs_command_index_node_t *curr_command =
+            find_command(index, NULL, argv[0]);
     if (curr_command == NULL) {
         PFS_SHELL_LOG(WRN, "%s: command not found\n", argv[0]);
         PFS_SHELL_LOG(WRN, "type 'help' for a list of available commands\n");
@@ -403,7 +381,7 @@ find_command_handler(char *argv[], int argc, size_t *out_level) {
     (*out_level)++;
 
     if (argc == 1) {
-        if (pfs_command_has_subcommands(curr_command)) {
+        if (pfs_command_has_subcommands(curr_command->command)) {
             PFS_SHELL_LOG(WRN, "incomplete command: '%s'\n", argv[0]);
             PFS_SHELL_LOG(
                     WRN, "type 'help %s' for a list of available subcommands\n",
@@ -412,13 +390,12 @@ find_command_handler(char *argv[], int argc, size_t *out_level) {
         }
     }
 
-    if (!pfs_command_has_subcommands(curr_command)) {
-        return curr_command->handler;
+    if (!pfs_command_has_subcommands(curr_command->command)) {
+        return curr_command->command;
     }
 
-    const pfs_command_t *curr_subcommand =
-            pfs_find_command_by_name(curr_command->subcommands, argv[1],
-                                     curr_command->number_of_subcommands);
+    const pfs_command_index_node_t *curr_subcommand =
+            find_command(index, curr_command, argv[1]);
     if (curr_subcommand == NULL) {
         PFS_SHELL_LOG(WRN, "%s: subcommand not found\n", argv[1]);
         PFS_SHELL_LOG(WRN,
@@ -429,41 +406,31 @@ find_command_handler(char *argv[], int argc, size_t *out_level) {
 
     (*out_level)++;
 
-    char message_chain[256];
-    memset(message_chain, 0, sizeof(message_chain));
-    snprintf(message_chain, sizeof(message_chain), "%s %s", argv[0], argv[1]);
-
     size_t iterator = 2;
     while (iterator < argc) {
-        if (!pfs_command_has_subcommands(curr_subcommand)) {
+        if (!pfs_command_has_subcommands(curr_subcommand->command)) {
             break;
         }
 
-        curr_subcommand = pfs_find_command_by_name(
-                curr_subcommand->subcommands, argv[iterator],
-                curr_subcommand->number_of_subcommands);
+        curr_subcommand = find_command(index, curr_subcommand, argv[iterator]);
         if (curr_subcommand == NULL) {
             PFS_SHELL_LOG(WRN, "%s: subcommand not found\n", argv[iterator]);
-            PFS_SHELL_LOG(
-                    WRN, "type 'help %s' for a list of available subcommands\n",
-                    message_chain);
+            print_subcommands_hint(argv, iterator);
             return NULL;
         }
         (*out_level)++;
-        strcat(message_chain, " ");
-        strcat(message_chain, argv[iterator]);
         iterator++;
     }
 
-    if (pfs_command_has_subcommands(curr_subcommand)) {
-        PFS_SHELL_LOG(WRN, "incomplete command: '%s'\n", message_chain);
-        PFS_SHELL_LOG(WRN,
-                      "type 'help %s' for a list of available subcommands\n",
-                      message_chain);
+    if (pfs_command_has_subcommands(curr_subcommand->command)) {
+        PFS_SHELL_LOG(WRN, "incomplete command: '");
+        print_command_chain(argv, iterator);
+        pfs_io_puts_immediately("'\n");
+        print_subcommands_hint(argv, iterator);
         return NULL;
     }
 
-    return curr_subcommand->handler;
+    return curr_subcommand->command;
 }
 
 bool pfs_input_has_only_whitespaces(const char *input) {
@@ -494,8 +461,68 @@ static const char *error_to_string(int error) {
     }
 }
 
-char m_buffer[PFS_MAX_INPUT_SIZE];
-char *m_argv[PFS_MAX_ARGC];
+static bool is_builtin(const char *name) {
+    for (size_t i = 0; i < PFS_ADDITIONAL_COMMANDS_SIZE; i++) {
+        if (strcmp(name, m_aditional_commands[i].description.name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// runs `argv[0]` in the shell task if it is a built-in command
+static bool run_builtin(const pfs_command_index_t *index,
+                        char **argv,
+                        int argc,
+                        int *out_ret) {
+    if (strcmp(argv[0], "help") == 0) {
+        *out_ret = handle_help_command(index, argv + 1, argc - 1, false);
+    } else if (strcmp(argv[0], "helptree") == 0) {
+        *out_ret = handle_help_command(index, argv + 1, argc - 1, true);
+    } else if (strcmp(argv[0], "loglevel") == 0) {
+        *out_ret = pfs_log_command(argc - 1, argv + 1);
+#ifdef PFS_WITH_STATS
+    } else if (strcmp(argv[0], "stats") == 0) {
+        *out_ret = pfs_stats_command(argc - 1, argv + 1);
+    } else if (strcmp(argv[0], "cmdstats") == 0) {
+        *out_ret = pfs_cmd_stats_command(argc - 1, argv + 1);
+#endif // PFS_WITH_STATS
+#ifdef PFS_WITH_DMESG
+    } else if (strcmp(argv[0], "dmesg") == 0) {
+        *out_ret = pfs_dmesg_command(argc - 1, argv + 1);
+#endif // PFS_WITH_DMESG
+    } else {
+        return false;
+    }
+    PFS_STATS_ADD(commands_builtin, 1);
+    return true;
+}
+
+// cuts the filters off the command line
+static int split_pipeline(pfs_pipe_t *pipe, char **argv, int *argc) {
+    pfs_pipe_reset(pipe);
+    int end = 0;
+    while (end < *argc && argv[end] != m_pipe_separator) {
+        end++;
+    }
+    int command_argc = end;
+    if (command_argc == 0) {
+        PFS_SHELL_LOG(WRN, "missing command before '|'\n");
+        return 1;
+    }
+    while (end < *argc) {
+        int start = end + 1;
+        end = start;
+        while (end < *argc && argv[end] != m_pipe_separator) {
+            end++;
+        }
+        if (pfs_pipe_add_stage(pipe, end - start, argv + start)) {
+            return 1;
+        }
+    }
+    *argc = command_argc;
+    return 0;
+}
 
 int pfs_handle_shell_input(const char *input) {
     if (input == NULL || strlen(input) >= PFS_MAX_INPUT_SIZE) {
@@ -507,13 +534,18 @@ int pfs_handle_shell_input(const char *input) {
         return 0;
     }
 
+    uint32_t start_us = _pfs_time_us();
     int argc = 0;
 
-    strncpy(m_buffer, input, PFS_MAX_INPUT_SIZE);
-    m_buffer[PFS_MAX_INPUT_SIZE - 1] = '\0';
+    // the tokens are referred to by the handler, so keep them in the session
+    pfs_session_t *session = pfs_session_current();
+    char **argv = session->argv;
+    strncpy(session->tokens, input, PFS_MAX_INPUT_SIZE);
+    session->tokens[PFS_MAX_INPUT_SIZE - 1] = '\0';
 
-    int ret = pfs_custom_tokenizer(m_buffer, m_argv, PFS_MAX_ARGC, &argc);
+    int ret = pfs_custom_tokenizer(session->tokens, argv, PFS_MAX_ARGC, &argc);
     if (ret != 0) {
+        PFS_STATS_ADD(commands_invalid, 1);
         PFS_SHELL_LOG(ERR, "invalid input: %s\n", error_to_string(ret));
         return 1;
     }
@@ -522,27 +554,73 @@ int pfs_handle_shell_input(const char *input) {
         return 0;
     }
 
-    if (strcmp(m_argv[0], "help") == 0) {
-        return handle_help_command(m_argv + 1, argc - 1, false);
+    // `time` measures the rest of the pipeline for the command that follows
+    bool timed = strcmp(argv[0], "time") == 0;
+    if (timed) {
+        if (argc == 1 || strcmp(argv[1], "time") == 0) {
+            PFS_STATS_ADD(commands_invalid, 1);
+            PFS_SHELL_LOG(WRN, "usage: time <command...>\n");
+            return 1;
+        }
+        argv++;
+        argc--;
+    }
+
+    // `cmd | grep text | head 5`, the filters are applied to the output by
+    // the command handler task
+    pfs_pipe_t *pipe = &session->pipe;
+    if (split_pipeline(pipe, argv, &argc)) {
+        PFS_STATS_ADD(commands_invalid, 1);
+        return 1;
+    }
+    if (pipe->stage_count > 0 && is_builtin(argv[0])) {
+        PFS_STATS_ADD(commands_invalid, 1);
+        PFS_SHELL_LOG(WRN, "%s: output of built-in commands can't be piped\n",
+                      argv[0]);
+        return 1;
     }
 
-    if (strcmp(m_argv[0], "helptree") == 0) {
-        return handle_help_command(m_argv + 1, argc - 1, true);
+    // the snapshot stays valid until the shell task handles the next event
+    const pfs_command_index_t *index = pfs_command_index_get();
+
+    uint32_t run_start_us = _pfs_time_us();
+    if (run_builtin(index, argv, argc, &ret)) {
+        // built-ins run right here in the shell task, nothing is queued
+        if (timed) {
+            PFS_SHELL_LOG(INF, "time: lookup %lu us, run %lu us (built-in)\n",
+                          (unsigned long) (run_start_us - start_us),
+                          (unsigned long) (_pfs_time_us() - run_start_us));
+        }
+        return ret;
     }
 
     size_t level = 0;
-    pfs_command_handler_t handler = find_command_handler(m_argv, argc, &level);
-    if (handler == NULL) {
+    const pfs_command_t *command = find_leaf_command(index, argv, argc, &level);
+    if (command == NULL || command->handler == NULL) {
+        PFS_STATS_ADD(commands_not_found, 1);
         return 1;
     }
 
-    pfs_cmd_args_t cmd_args = {
-            .handler = handler, .argc = argc - level, .argv = m_argv + level};
+    pfs_cmd_args_t cmd_args = {.handler = command->handler,
+                               .command = command,
+                               .argc = argc - level,
+                               .argv = argv + level,
+                               .session = session,
+                               .pipe = pipe->stage_count > 0 ? pipe : NULL,
+                               .timed = timed};
 
+    if (timed) {
+        cmd_args.queued_us = _pfs_time_us();
+        cmd_args.lookup_us = cmd_args.queued_us - start_us;
+    }
     if (pfs_cmd_queue_add(&cmd_args)) {
+        PFS_STATS_ADD(commands_queue_failures, 1);
         PFS_SHELL_LOG(ERR, "failed to add item to cmd_handler_queue\n");
         return 1;
     }
+    PFS_STATS_ADD(commands_dispatched, 1);
+    // read by tasks waiting for the dispatched commands to finish
+    __atomic_fetch_add(&session->commands_dispatched, 1, __ATOMIC_RELEASE);
 
     return 0;
 }
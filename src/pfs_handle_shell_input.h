@@ -22,6 +22,9 @@
 
 #pragma once
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include <pico_freertos_shell/commands.h>
 
 #include "pfs_io.h"
@@ -33,30 +36,33 @@ extern "C" {
 // assume maximum number of arguments
 #define PFS_MAX_ARGC (PFS_MAX_INPUT_SIZE / 5)
 
+struct pfs_pipe;
+struct pfs_session;
+
 typedef struct {
     pfs_command_handler_t handler;
+    // the leaf command the handler belongs to
+    const pfs_command_t *command;
     int argc;
     char **argv;
+    // the session the command was issued from, receives its output
+    struct pfs_session *session;
+    // output filters, NULL if the output is not piped
+    struct pfs_pipe *pipe;
+    // set by the `time` prefix, the handler task reports the measurements
+    bool timed;
+    uint32_t lookup_us;
+    uint32_t queued_us;
 } pfs_cmd_args_t;
 
-void pfs_set_commands(const pfs_command_t *commands, size_t number_of_commands);
-size_t pfs_get_number_of_commands(void);
-const pfs_command_t *pfs_get_commands(void);
+const pfs_command_t *pfs_get_aditional_commands(size_t *out_len);
 int pfs_handle_shell_input(const char *input);
 bool pfs_input_has_only_whitespaces(const char *input);
 int pfs_custom_tokenizer(char *input,
                          char *argv[],
                          int max_argc,
                          int *out_argc);
-const pfs_command_t *
-pfs_get_core_commands_sorted_by_name_dynamic(size_t *out_number_of_commands);
-const pfs_command_t *
-pfs_get_subcommands_sorted_by_name_dynamic(const pfs_command_t *subcommands,
-                                           size_t number_of_subcommands);
 int pfs_command_has_subcommands(const pfs_command_t *command);
-const pfs_command_t *pfs_find_command_by_name(const pfs_command_t *subcommands,
-                                              const char *name,
-                                              size_t number_of_subcommands);
 
 #ifdef __cplusplus
 }
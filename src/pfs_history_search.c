@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "pfs_cmd_history.h"
+#include "pfs_history_search.h"
+#include "pfs_io.h"
+#include "pfs_session.h"
+
+#ifdef PFS_WITH_COMMAND_HISTORY
+
+#define PFS_HISTORY_SEARCH_PROMPT "(reverse-i-search)'"
+#define PFS_HISTORY_SEARCH_FAILED_PROMPT "(failed reverse-i-search)'"
+#define PFS_HISTORY_SEARCH_SEPARATOR "': "
+
+bool pfs_history_search_is_active(void) {
+    pfs_history_search_t *search = &pfs_session_current()->search;
+    return search->active;
+}
+
+// the prompt is a part of the line, as it changes when the search fails
+static void redraw(pfs_history_search_t *search) {
+    char line[PFS_HISTORY_SEARCH_LINE_SIZE];
+    const char *prompt = search->failed ? PFS_HISTORY_SEARCH_FAILED_PROMPT
+                                        : PFS_HISTORY_SEARCH_PROMPT;
+    size_t len = strlen(prompt);
+    memcpy(line, prompt, len);
+    memcpy(&line[len], search->pattern, search->pattern_len);
+    len += search->pattern_len;
+    memcpy(&line[len], PFS_HISTORY_SEARCH_SEPARATOR,
+           sizeof(PFS_HISTORY_SEARCH_SEPARATOR) - 1);
+    len += sizeof(PFS_HISTORY_SEARCH_SEPARATOR) - 1;
+    memcpy(&line[len], search->match.buffer, search->match.len);
+    len += search->match.len;
+
+    pfs_io_line_t old_line = {
+            .text = search->line,
+            .len = search->line_len,
+            .cursor = search->line_len,
+    };
+    pfs_io_line_t new_line = {
+            .text = line,
+            .len = len,
+            .cursor = len,
+    };
+    pfs_io_redraw_line("", &old_line, &new_line);
+
+    memcpy(search->line, line, len);
+    search->line_len = len;
+}
+
+static bool match_contains_pattern(const pfs_history_search_t *search) {
+    if (search->entry.offset == 0) {
+        return false;
+    }
+    for (size_t start = 0;
+         start + search->pattern_len <= search->match.len; start++) {
+        if (memcmp(&search->match.buffer[start], search->pattern,
+                   search->pattern_len)
+            == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// looks for the pattern in the entries older than the current match (or all
+// of them), the current match is kept (and the search failed) if nothing is
+// found
+static void search_older(pfs_history_search_t *search) {
+    pfs_cmd_history_t *cmd_buff = pfs_cmd_history_get_buff_ptr();
+    pfs_cmd_history_entry_t found;
+    if (pfs_cmd_history_find_older(cmd_buff, &search->entry, search->pattern,
+                                   search->pattern_len, false, &found)
+        || pfs_cmd_history_read(cmd_buff, &found, &search->match)) {
+        search->failed = true;
+        return;
+    }
+    search->entry = found;
+    search->failed = false;
+}
+
+static void handle_pattern_char(pfs_history_search_t *search, char c) {
+    if (search->pattern_len >= sizeof(search->pattern) - 1) {
+        return;
+    }
+    search->pattern[search->pattern_len++] = c;
+
+    // entries newer than the current match did not contain the shorter
+    // pattern, so they can't contain the longer one
+    if (match_contains_pattern(search)) {
+        search->failed = false;
+    } else {
+        search_older(search);
+    }
+}
+
+static void handle_backspace(pfs_history_search_t *search) {
+    if (search->pattern_len == 0) {
+        return;
+    }
+    search->pattern_len--;
+    // a shorter pattern may match a newer entry
+    search->entry.offset = 0;
+    search->match.len = 0;
+    search->failed = false;
+    if (search->pattern_len > 0) {
+        search_older(search);
+    }
+}
+
+static void finish(pfs_history_search_t *search,
+                   pfs_input_buffer_t *input_buffer,
+                   const pfs_cmd_history_entry_t *entry) {
+    search->active = false;
+
+    size_t offset = entry->offset;
+    pfs_cmd_history_t *cmd_buff = pfs_cmd_history_get_buff_ptr();
+    if (pfs_cmd_history_read(cmd_buff, entry, input_buffer)) {
+        input_buffer->len = 0;
+        input_buffer->cursor = 0;
+        input_buffer->buffer[0] = '\0';
+    }
+    input_buffer->cursor = input_buffer->len;
+    *pfs_cmd_history_get_offset_ptr() = offset;
+    if (offset != 0) {
+        // browse around the match without filtering by the line typed before
+        cmd_buff->newest.len = 0;
+        cmd_buff->newest.cursor = 0;
+    }
+
+    pfs_io_remove_shell_prompt();
+    pfs_io_restore_shell_prompt();
+}
+
+void pfs_history_search_start(pfs_input_buffer_t *input_buffer) {
+    pfs_history_search_t *search = &pfs_session_current()->search;
+    pfs_cmd_history_t *cmd_buff = pfs_cmd_history_get_buff_ptr();
+    if (pfs_cmd_history_is_empty(cmd_buff)) {
+        return;
+    }
+    if (*pfs_cmd_history_get_offset_ptr() == 0) {
+        (void) pfs_cmd_history_update_newest(cmd_buff, input_buffer);
+    }
+
+    search->active = true;
+    search->pattern_len = 0;
+    search->entry.offset = 0;
+    search->match.len = 0;
+    search->failed = false;
+    search->line_len = 0;
+
+    pfs_io_remove_shell_prompt();
+    redraw(search);
+}
+
+bool pfs_history_search_handle_char(pfs_input_buffer_t *input_buffer,
+                                    char c) {
+    pfs_history_search_t *search = &pfs_session_current()->search;
+    switch (c) {
+    case PFS_IO_CHAR_CTRL_R:
+        if (search->entry.offset != 0) {
+            search_older(search);
+        }
+        break;
+    case PFS_IO_CHAR_CTRL_H:
+    case PFS_IO_CHAR_BACKSPACE:
+        handle_backspace(search);
+        break;
+    case PFS_IO_CHAR_CTRL_C:
+        // restore the line typed before searching
+        search->entry.offset = 0;
+        finish(search, input_buffer, &search->entry);
+        return true;
+    default:
+        if (!isprint((unsigned char) c)) {
+            finish(search, input_buffer, &search->entry);
+            return false;
+        }
+        handle_pattern_char(search, c);
+        break;
+    }
+
+    redraw(search);
+    return true;
+}
+
+#endif // PFS_WITH_COMMAND_HISTORY
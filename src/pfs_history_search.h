@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "pfs_cmd_history.h"
+#include "pfs_io.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#ifdef PFS_WITH_COMMAND_HISTORY
+
+// the displayed line is the prompt, the pattern, the separator and the match
+#define PFS_HISTORY_SEARCH_LINE_SIZE (2 * PFS_MAX_INPUT_SIZE + 32)
+
+typedef struct {
+    bool active;
+    char pattern[PFS_MAX_INPUT_SIZE];
+    size_t pattern_len;
+    // the current match, its offset is 0 if nothing matches; the search
+    // resumes from its position
+    pfs_cmd_history_entry_t entry;
+    // nothing matches the pattern, the match shown is the one of a shorter
+    // pattern (or the oldest one)
+    bool failed;
+    pfs_input_buffer_t match;
+    char line[PFS_HISTORY_SEARCH_LINE_SIZE];
+    size_t line_len;
+} pfs_history_search_t;
+
+// the functions below operate on the search of the current session
+bool pfs_history_search_is_active(void);
+void pfs_history_search_start(pfs_input_buffer_t *input_buffer);
+/**
+ * Handles a character while the search is active. Returns false if the
+ * character ended the search and should be handled as a regular input
+ * character (e.g. enter executes the found command).
+ */
+bool pfs_history_search_handle_char(pfs_input_buffer_t *input_buffer, char c);
+
+#endif // PFS_WITH_COMMAND_HISTORY
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
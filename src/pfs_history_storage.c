@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <ctype.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pfs_history_storage.h"
+
+static uint16_t read_u16(const uint8_t *data) {
+    return (uint16_t) (data[0] | (data[1] << 8));
+}
+
+static uint32_t read_u32(const uint8_t *data) {
+    return (uint32_t) read_u16(data) | ((uint32_t) read_u16(data + 2) << 16);
+}
+
+void pfs_history_storage_encode_magic(uint8_t *out) {
+    for (size_t i = 0; i < PFS_HISTORY_STORAGE_MAGIC_SIZE; i++) {
+        out[i] = (uint8_t) (PFS_HISTORY_STORAGE_MAGIC >> (8 * i));
+    }
+}
+
+size_t pfs_history_storage_encode_record_header(uint8_t *out, size_t len) {
+    out[0] = (uint8_t) len;
+    out[1] = (uint8_t) (len >> 8);
+    return PFS_HISTORY_STORAGE_RECORD_HEADER_SIZE;
+}
+
+static int record_is_valid(const uint8_t *line, size_t len) {
+    if (len == 0 || len >= PFS_MAX_INPUT_SIZE) {
+        return 0;
+    }
+    // only printable characters can be typed, anything else means the log is
+    // corrupted (or was never written, e.g. retained RAM after power-up)
+    for (size_t i = 0; i < len; i++) {
+        if (!isprint(line[i])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Returns 0 if the log is valid up to its end, `out_end` is then the offset
+ * the next record should be written at. Otherwise records before the first
+ * invalid one are still reported.
+ */
+int pfs_history_storage_parse(const uint8_t *data,
+                              size_t size,
+                              pfs_history_storage_entry_cb_t callback,
+                              void *arg,
+                              size_t *out_end) {
+    *out_end = 0;
+    if (size < PFS_HISTORY_STORAGE_MAGIC_SIZE
+        || read_u32(data) != PFS_HISTORY_STORAGE_MAGIC) {
+        return 1;
+    }
+
+    size_t position = PFS_HISTORY_STORAGE_MAGIC_SIZE;
+    while (position + PFS_HISTORY_STORAGE_RECORD_HEADER_SIZE <= size) {
+        uint16_t len = read_u16(&data[position]);
+        if (len == PFS_HISTORY_STORAGE_END) {
+            break;
+        }
+        size_t record_size = PFS_HISTORY_STORAGE_RECORD_HEADER_SIZE + len;
+        const uint8_t *line =
+                &data[position + PFS_HISTORY_STORAGE_RECORD_HEADER_SIZE];
+        if (position + record_size > size || !record_is_valid(line, len)) {
+            *out_end = position;
+            return 1;
+        }
+        if (callback) {
+            callback((const char *) line, len, arg);
+        }
+        position += record_size;
+    }
+
+    *out_end = position;
+    return 0;
+}
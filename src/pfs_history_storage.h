@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+struct pfs_cmd_history;
+
+typedef void (*pfs_history_storage_entry_cb_t)(const char *line,
+                                               size_t len,
+                                               void *arg);
+
+/**
+ * Storage backend for the command history. Commands are appended one by one as
+ * records of a log, so a single command never requires rewriting the whole
+ * history. When there is no space left for a record, the log is compacted to
+ * the commands currently held in RAM.
+ */
+typedef struct {
+    // calls the callback for each stored command, from the oldest one
+    int (*read)(pfs_history_storage_entry_cb_t callback, void *arg);
+    // appends a single command, fails if there is no space left
+    int (*append)(const char *line, size_t len);
+    // replaces the stored commands with the ones held in the history
+    int (*compact)(const struct pfs_cmd_history *history);
+} pfs_history_storage_t;
+
+// selected with the PFS_COMMAND_HISTORY_STORAGE CMake option
+extern const pfs_history_storage_t pfs_history_storage;
+
+/**
+ * All backends share the same log format: a magic number followed by records
+ * made of a 16-bit little-endian length and the command itself. The log ends
+ * with PFS_HISTORY_STORAGE_END, end of the storage or end of the file.
+ */
+#define PFS_HISTORY_STORAGE_MAGIC 0x48534650u // "PFSH"
+#define PFS_HISTORY_STORAGE_MAGIC_SIZE 4
+#define PFS_HISTORY_STORAGE_RECORD_HEADER_SIZE 2
+#define PFS_HISTORY_STORAGE_END 0xFFFFu
+
+void pfs_history_storage_encode_magic(uint8_t *out);
+size_t pfs_history_storage_encode_record_header(uint8_t *out, size_t len);
+int pfs_history_storage_parse(const uint8_t *data,
+                              size_t size,
+                              pfs_history_storage_entry_cb_t callback,
+                              void *arg,
+                              size_t *out_end);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
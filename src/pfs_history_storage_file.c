@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "pfs_cmd_history.h"
+#include "pfs_history_storage.h"
+
+#ifdef PFS_COMMAND_HISTORY_STORAGE_FILE
+
+// host stand-in for the flash backend, the log is kept in a regular file
+static uint8_t m_read_buffer[PFS_COMMAND_HISTORY_STORAGE_SIZE];
+static size_t m_file_size;
+
+static int file_read(pfs_history_storage_entry_cb_t callback, void *arg) {
+    FILE *file = fopen(PFS_COMMAND_HISTORY_FILE, "rb");
+    if (file == NULL) {
+        m_file_size = 0;
+        return 0;
+    }
+    size_t size = fread(m_read_buffer, 1, sizeof(m_read_buffer), file);
+    fclose(file);
+
+    size_t end;
+    if (pfs_history_storage_parse(m_read_buffer, size, callback, arg, &end)) {
+        // force compaction on the next append
+        m_file_size = PFS_COMMAND_HISTORY_STORAGE_SIZE;
+        return size == 0 ? 0 : 1;
+    }
+    m_file_size = end;
+    return 0;
+}
+
+static int write_record(FILE *file, const char *line, size_t len) {
+    uint8_t header[PFS_HISTORY_STORAGE_RECORD_HEADER_SIZE];
+    size_t header_size = pfs_history_storage_encode_record_header(header, len);
+    if (fwrite(header, 1, header_size, file) != header_size
+        || fwrite(line, 1, len, file) != len) {
+        return 1;
+    }
+    return 0;
+}
+
+static int file_append(const char *line, size_t len) {
+    size_t record_size = PFS_HISTORY_STORAGE_RECORD_HEADER_SIZE + len;
+    if (m_file_size == 0
+        || m_file_size + record_size > PFS_COMMAND_HISTORY_STORAGE_SIZE) {
+        return 1;
+    }
+
+    FILE *file = fopen(PFS_COMMAND_HISTORY_FILE, "ab");
+    if (file == NULL) {
+        return 1;
+    }
+    int ret = write_record(file, line, len);
+    ret |= fclose(file);
+    if (ret == 0) {
+        m_file_size += record_size;
+    }
+    return ret;
+}
+
+typedef struct {
+    FILE *file;
+    size_t size;
+    int ret;
+} compact_ctx_t;
+
+static void compact_entry(const char *line, size_t len, void *arg) {
+    compact_ctx_t *ctx = (compact_ctx_t *) arg;
+    size_t record_size = PFS_HISTORY_STORAGE_RECORD_HEADER_SIZE + len;
+    if (ctx->size + record_size > PFS_COMMAND_HISTORY_STORAGE_SIZE) {
+        ctx->ret = 1;
+        return;
+    }
+    ctx->ret |= write_record(ctx->file, line, len);
+    ctx->size += record_size;
+}
+
+static int file_compact(const pfs_cmd_history_t *history) {
+    // write a new file and replace the old one, so the log is never lost
+    FILE *file = fopen(PFS_COMMAND_HISTORY_FILE ".tmp", "wb");
+    if (file == NULL) {
+        return 1;
+    }
+    uint8_t magic[PFS_HISTORY_STORAGE_MAGIC_SIZE];
+    pfs_history_storage_encode_magic(magic);
+    compact_ctx_t ctx = {
+            .file = file,
+            .size = sizeof(magic),
+            .ret = fwrite(magic, 1, sizeof(magic), file) != sizeof(magic),
+    };
+    pfs_cmd_history_for_each(history, compact_entry, &ctx);
+    ctx.ret |= fclose(file);
+    if (ctx.ret
+        || rename(PFS_COMMAND_HISTORY_FILE ".tmp", PFS_COMMAND_HISTORY_FILE)) {
+        return 1;
+    }
+    m_file_size = ctx.size;
+    return 0;
+}
+
+const pfs_history_storage_t pfs_history_storage = {
+        .read = file_read,
+        .append = file_append,
+        .compact = file_compact,
+};
+
+#endif // PFS_COMMAND_HISTORY_STORAGE_FILE
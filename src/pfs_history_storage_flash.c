@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <hardware/flash.h>
+#include <pico/flash.h>
+#include <pico/stdlib.h>
+
+#include "pfs_cmd_history.h"
+#include "pfs_history_storage.h"
+
+#ifdef PFS_COMMAND_HISTORY_STORAGE_FLASH
+
+#if PFS_COMMAND_HISTORY_STORAGE_SIZE % FLASH_SECTOR_SIZE != 0
+#error "PFS_COMMAND_HISTORY_STORAGE_SIZE must be a multiple of the flash sector size"
+#endif
+
+// the log occupies the last sectors of the flash
+#define STORAGE_OFFSET \
+    (PICO_FLASH_SIZE_BYTES - PFS_COMMAND_HISTORY_STORAGE_SIZE)
+#define STORAGE_DATA ((const uint8_t *) (XIP_BASE + STORAGE_OFFSET))
+
+#define MAX_RECORD_SIZE \
+    (PFS_HISTORY_STORAGE_RECORD_HEADER_SIZE + PFS_MAX_INPUT_SIZE - 1)
+// a record starting at the end of a page may span a few pages
+#define PAGES_BUFFER_SIZE                                          \
+    (((FLASH_PAGE_SIZE - 1 + MAX_RECORD_SIZE + FLASH_PAGE_SIZE - 1) \
+      / FLASH_PAGE_SIZE)                                           \
+     * FLASH_PAGE_SIZE)
+
+static uint8_t m_pages_buffer[PAGES_BUFFER_SIZE];
+static size_t m_write_offset;
+
+typedef struct {
+    size_t offset;
+    const uint8_t *data;
+    size_t len;
+} program_args_t;
+
+static void do_program(void *param) {
+    program_args_t *args = (program_args_t *) param;
+    flash_range_program(STORAGE_OFFSET + args->offset, args->data, args->len);
+}
+
+static void do_erase(void *param) {
+    (void) param;
+    flash_range_erase(STORAGE_OFFSET, PFS_COMMAND_HISTORY_STORAGE_SIZE);
+}
+
+static int program(size_t offset, const uint8_t *data, size_t len) {
+    program_args_t args = {
+            .offset = offset,
+            .data = data,
+            .len = len,
+    };
+    // other core and interrupts must not execute from flash in the meantime
+    return flash_safe_execute(do_program, &args, UINT32_MAX) != PICO_OK;
+}
+
+static int flash_read(pfs_history_storage_entry_cb_t callback, void *arg) {
+    size_t end;
+    if (pfs_history_storage_parse(STORAGE_DATA,
+                                  PFS_COMMAND_HISTORY_STORAGE_SIZE, callback,
+                                  arg, &end)) {
+        // force compaction (erase) on the next append
+        m_write_offset = PFS_COMMAND_HISTORY_STORAGE_SIZE;
+        return 1;
+    }
+    m_write_offset = end;
+    return 0;
+}
+
+static int flash_append(const char *line, size_t len) {
+    size_t record_size = PFS_HISTORY_STORAGE_RECORD_HEADER_SIZE + len;
+    if (m_write_offset == 0
+        || m_write_offset + record_size > PFS_COMMAND_HISTORY_STORAGE_SIZE) {
+        return 1;
+    }
+
+    // programming erased (0xFF) bytes leaves the already written ones intact,
+    // so only the record is put into otherwise erased pages
+    size_t page_offset = m_write_offset - m_write_offset % FLASH_PAGE_SIZE;
+    size_t record_offset = m_write_offset - page_offset;
+    size_t program_len = record_offset + record_size;
+    program_len += (FLASH_PAGE_SIZE - program_len % FLASH_PAGE_SIZE)
+                   % FLASH_PAGE_SIZE;
+    memset(m_pages_buffer, 0xFF, program_len);
+    size_t header_size = pfs_history_storage_encode_record_header(
+            &m_pages_buffer[record_offset], len);
+    memcpy(&m_pages_buffer[record_offset + header_size], line, len);
+    if (program(page_offset, m_pages_buffer, program_len)) {
+        return 1;
+    }
+
+    m_write_offset += record_size;
+    return 0;
+}
+
+typedef struct {
+    size_t offset;
+    size_t page_len;
+    int ret;
+} compact_ctx_t;
+
+static void flush_page(compact_ctx_t *ctx) {
+    memset(&m_pages_buffer[ctx->page_len], 0xFF,
+           FLASH_PAGE_SIZE - ctx->page_len);
+    ctx->ret |= program(ctx->offset, m_pages_buffer, FLASH_PAGE_SIZE);
+    ctx->offset += FLASH_PAGE_SIZE;
+    ctx->page_len = 0;
+}
+
+static void write_bytes(compact_ctx_t *ctx, const uint8_t *data, size_t len) {
+    while (len > 0) {
+        size_t chunk = FLASH_PAGE_SIZE - ctx->page_len;
+        if (chunk > len) {
+            chunk = len;
+        }
+        memcpy(&m_pages_buffer[ctx->page_len], data, chunk);
+        ctx->page_len += chunk;
+        data += chunk;
+        len -= chunk;
+        if (ctx->page_len == FLASH_PAGE_SIZE) {
+            flush_page(ctx);
+        }
+    }
+}
+
+static void compact_entry(const char *line, size_t len, void *arg) {
+    compact_ctx_t *ctx = (compact_ctx_t *) arg;
+    size_t record_size = PFS_HISTORY_STORAGE_RECORD_HEADER_SIZE + len;
+    if (ctx->offset + ctx->page_len + record_size
+        > PFS_COMMAND_HISTORY_STORAGE_SIZE) {
+        ctx->ret = 1;
+        return;
+    }
+    uint8_t header[PFS_HISTORY_STORAGE_RECORD_HEADER_SIZE];
+    (void) pfs_history_storage_encode_record_header(header, len);
+    write_bytes(ctx, header, sizeof(header));
+    write_bytes(ctx, (const uint8_t *) line, len);
+}
+
+static int flash_compact(const pfs_cmd_history_t *history) {
+    if (flash_safe_execute(do_erase, NULL, UINT32_MAX) != PICO_OK) {
+        return 1;
+    }
+
+    compact_ctx_t ctx = {0};
+    uint8_t magic[PFS_HISTORY_STORAGE_MAGIC_SIZE];
+    pfs_history_storage_encode_magic(magic);
+    write_bytes(&ctx, magic, sizeof(magic));
+    pfs_cmd_history_for_each(history, compact_entry, &ctx);
+    m_write_offset = ctx.offset + ctx.page_len;
+    if (ctx.page_len > 0) {
+        flush_page(&ctx);
+    }
+    return ctx.ret;
+}
+
+const pfs_history_storage_t pfs_history_storage = {
+        .read = flash_read,
+        .append = flash_append,
+        .compact = flash_compact,
+};
+
+#endif // PFS_COMMAND_HISTORY_STORAGE_FLASH
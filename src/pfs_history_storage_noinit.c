@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <pico/stdlib.h>
+
+#include "pfs_cmd_history.h"
+#include "pfs_history_storage.h"
+
+#ifdef PFS_COMMAND_HISTORY_STORAGE_NOINIT
+
+// not initialized by the runtime, so the log survives soft resets (watchdog,
+// reset button, reflashing over SWD while powered); after power-up the content
+// is random and the magic number or the records are rejected by the parser
+static uint8_t __uninitialized_ram(m_log)[PFS_COMMAND_HISTORY_STORAGE_SIZE];
+static size_t m_write_offset;
+
+static int noinit_read(pfs_history_storage_entry_cb_t callback, void *arg) {
+    size_t end;
+    if (pfs_history_storage_parse(m_log, sizeof(m_log), callback, arg, &end)) {
+        // force compaction on the next append
+        m_write_offset = sizeof(m_log);
+        return 1;
+    }
+    m_write_offset = end;
+    return 0;
+}
+
+static void write_end_marker(size_t offset) {
+    if (offset + PFS_HISTORY_STORAGE_RECORD_HEADER_SIZE <= sizeof(m_log)) {
+        (void) pfs_history_storage_encode_record_header(
+                &m_log[offset], PFS_HISTORY_STORAGE_END);
+    }
+}
+
+static int noinit_append(const char *line, size_t len) {
+    size_t record_size = PFS_HISTORY_STORAGE_RECORD_HEADER_SIZE + len;
+    if (m_write_offset == 0 || m_write_offset + record_size > sizeof(m_log)) {
+        return 1;
+    }
+
+    // the record header replaces the current end marker last, so a reset in
+    // the middle of the append leaves a valid log
+    write_end_marker(m_write_offset + record_size);
+    memcpy(&m_log[m_write_offset + PFS_HISTORY_STORAGE_RECORD_HEADER_SIZE],
+           line, len);
+    (void) pfs_history_storage_encode_record_header(&m_log[m_write_offset],
+                                                    len);
+    m_write_offset += record_size;
+    return 0;
+}
+
+static void compact_entry(const char *line, size_t len, void *arg) {
+    (void) arg;
+    (void) noinit_append(line, len);
+}
+
+static int noinit_compact(const pfs_cmd_history_t *history) {
+    pfs_history_storage_encode_magic(m_log);
+    m_write_offset = PFS_HISTORY_STORAGE_MAGIC_SIZE;
+    write_end_marker(m_write_offset);
+    pfs_cmd_history_for_each(history, compact_entry, NULL);
+    return 0;
+}
+
+const pfs_history_storage_t pfs_history_storage = {
+        .read = noinit_read,
+        .append = noinit_append,
+        .compact = noinit_compact,
+};
+
+#endif // PFS_COMMAND_HISTORY_STORAGE_NOINIT
@@ -28,37 +28,54 @@
 #include <string.h>
 
 #include <pico_freertos_shell/init.h>
+#include <pico_freertos_shell/transport.h>
+
+#ifdef PFS_WITH_TESTS
+// provided by the test mocks
+int vfctprintf(void (*out)(char character, void *arg),
+               void *arg,
+               const char *format,
+               va_list va);
+#else // PFS_WITH_TESTS
+#include <pico/printf.h>
+#endif // PFS_WITH_TESTS
 
 #include "pfs_autocompletion.h"
 #include "pfs_cmd_queue.h"
 #include "pfs_escape_sequences.h"
 #include "pfs_handle_shell_input.h"
 #include "pfs_io.h"
+#include "pfs_session.h"
 #include "pfs_utils.h"
 
 #ifdef PFS_WITH_COMMAND_HISTORY
 #include "pfs_cmd_history.h"
+#include "pfs_history_search.h"
 #endif // PFS_WITH_COMMAND_HISTORY
 
-static pfs_input_buffer_t m_input_buffer;
+static pfs_input_buffer_t *get_input_buffer(void) {
+    return &pfs_session_current()->input;
+}
 
 void pfs_io_remove_shell_prompt(void) {
     pfs_io_puts_immediately(PFS_IO_CLEAR_LINE);
 }
 
 void pfs_io_restore_shell_prompt(void) {
+    pfs_input_buffer_t *input = get_input_buffer();
     pfs_io_puts_immediately(PFS_IO_SHELL_PROMPT);
-    pfs_io_puts_immediately(m_input_buffer.buffer);
-    size_t difference = m_input_buffer.len - m_input_buffer.cursor;
+    pfs_io_puts_immediately(input->buffer);
+    size_t difference = input->len - input->cursor;
     for (size_t i = 0; i < difference; i++) {
         pfs_io_puts_immediately(PFS_IO_MOVE_LEFT);
     }
 }
 
 static void reset_input_buffer(void) {
-    memset(m_input_buffer.buffer, 0, sizeof(m_input_buffer.buffer));
-    m_input_buffer.len = 0;
-    m_input_buffer.cursor = 0;
+    pfs_input_buffer_t *input = get_input_buffer();
+    memset(input->buffer, 0, sizeof(input->buffer));
+    input->len = 0;
+    input->cursor = 0;
 }
 
 static void handle_char_ctrl_c(void) {
@@ -67,82 +84,170 @@ static void handle_char_ctrl_c(void) {
     pfs_io_restore_shell_prompt();
 }
 
+static void write_immediately(const char *data, size_t len) {
+    pfs_transport_t *transport = pfs_session_current()->transport;
+    if (transport == NULL) {
+        // there are no sessions before pfs_init()
+        for (size_t i = 0; i < len; i++) {
+            putchar(data[i]);
+        }
+        return;
+    }
+    (void) transport->vtable->write(transport, data, len, NULL, NULL);
+}
+
 void PFS_REAL(pfs_io_putchar_immediately)(char c) {
-    putchar(c);
+    write_immediately(&c, 1);
 }
 
 static void handle_char_backspace(void) {
-    if (m_input_buffer.cursor == 0) {
+    pfs_input_buffer_t *input = get_input_buffer();
+    if (input->cursor == 0) {
         return;
     }
 
-    m_input_buffer.cursor--;
-    for (size_t i = m_input_buffer.cursor; i < m_input_buffer.len; i++) {
-        m_input_buffer.buffer[i] = m_input_buffer.buffer[i + 1];
+    input->cursor--;
+    for (size_t i = input->cursor; i < input->len; i++) {
+        input->buffer[i] = input->buffer[i + 1];
     }
-    m_input_buffer.len--;
+    input->len--;
     pfs_io_remove_shell_prompt();
     pfs_io_restore_shell_prompt();
 }
 
 static void handle_char_enter(void) {
+    pfs_input_buffer_t *input = get_input_buffer();
     if (pfs_cmd_queue_is_in_handler()) {
         pfs_io_remove_shell_prompt();
         PFS_SHELL_LOG(WRN, "command handler is being executed\n");
         pfs_io_restore_shell_prompt();
         return;
     }
-    m_input_buffer.buffer[m_input_buffer.len] = '\0';
-    if (!pfs_input_has_only_whitespaces(m_input_buffer.buffer)) {
+    input->buffer[input->len] = '\0';
+    if (!pfs_input_has_only_whitespaces(input->buffer)) {
         pfs_io_putchar_immediately('\n');
     }
-    m_input_buffer.cursor = m_input_buffer.len;
+    input->cursor = input->len;
 #ifdef PFS_WITH_COMMAND_HISTORY
-    if (!pfs_input_has_only_whitespaces(m_input_buffer.buffer)) {
-        (void) pfs_cmd_history_append(pfs_cmd_history_get_buff_ptr(),
-                                      &m_input_buffer);
+    if (!pfs_input_has_only_whitespaces(input->buffer)) {
+        (void) pfs_cmd_history_append(pfs_cmd_history_get_buff_ptr(), input);
         size_t *offset = pfs_cmd_history_get_offset_ptr();
         *offset = 0;
     }
 #endif // PFS_WITH_COMMAND_HISTORY
-    pfs_handle_shell_input(m_input_buffer.buffer);
-    if (pfs_input_has_only_whitespaces(m_input_buffer.buffer)) {
+    pfs_handle_shell_input(input->buffer);
+    if (pfs_input_has_only_whitespaces(input->buffer)) {
         pfs_io_putchar_immediately('\n');
     }
     reset_input_buffer();
     pfs_io_restore_shell_prompt();
 }
 
-static void handle_other_characters(char c) {
-    if (!isprint(c)) {
-        return;
+void pfs_io_insert_text(const char *text, size_t len) {
+    pfs_input_buffer_t *input = get_input_buffer();
+    size_t space = PFS_MAX_INPUT_SIZE - 1 - input->len;
+    if (len > space) {
+        len = space;
     }
-    if (m_input_buffer.len >= PFS_MAX_INPUT_SIZE - 1) {
+    if (len == 0) {
         return;
     }
 
-    if (m_input_buffer.cursor != m_input_buffer.len) {
-        pfs_io_puts_immediately(PFS_IO_ERASE_LINE_RIGHT);
-        for (size_t i = m_input_buffer.len; i > m_input_buffer.cursor; i--) {
-            m_input_buffer.buffer[i] = m_input_buffer.buffer[i - 1];
-        }
+    char *insertion = &input->buffer[input->cursor];
+    size_t tail_len = input->len - input->cursor;
+    memmove(insertion + len, insertion, tail_len);
+    memcpy(insertion, text, len);
+    input->len += len;
+    input->cursor += len;
+    input->buffer[input->len] = '\0';
+
+    // the inserted text and the tail are contiguous, so echo them at once
+    pfs_io_puts_immediately(insertion);
+    for (size_t i = 0; i < tail_len; i++) {
+        pfs_io_puts_immediately(PFS_IO_MOVE_LEFT);
     }
-    m_input_buffer.buffer[m_input_buffer.cursor] = c;
-    m_input_buffer.len++;
-    m_input_buffer.cursor++;
-    pfs_io_putchar_immediately(c);
-    if (m_input_buffer.cursor != m_input_buffer.len) {
-        for (size_t i = m_input_buffer.cursor; i < m_input_buffer.len; i++) {
-            pfs_io_putchar_immediately(m_input_buffer.buffer[i]);
-        }
-        size_t difference = m_input_buffer.len - m_input_buffer.cursor;
-        for (size_t i = 0; i < difference; i++) {
-            pfs_io_puts_immediately(PFS_IO_MOVE_LEFT);
+}
+
+static void put_text(const char *text, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        pfs_io_putchar_immediately(text[i]);
+    }
+}
+
+void pfs_io_redraw_line(const char *prompt,
+                        const pfs_io_line_t *old_line,
+                        const pfs_io_line_t *new_line) {
+    size_t common = 0;
+    while (common < old_line->len && common < new_line->len
+           && old_line->text[common] == new_line->text[common]) {
+        common++;
+    }
+
+    if (old_line->cursor > common) {
+        size_t move_left_cost =
+                (old_line->cursor - common) * (sizeof(PFS_IO_MOVE_LEFT) - 1);
+        size_t reprint_cost = 1 + strlen(prompt) + common;
+        if (reprint_cost < move_left_cost) {
+            pfs_io_putchar_immediately('\r');
+            pfs_io_puts_immediately(prompt);
+            put_text(new_line->text, common);
+        } else {
+            for (size_t i = common; i < old_line->cursor; i++) {
+                pfs_io_puts_immediately(PFS_IO_MOVE_LEFT);
+            }
         }
+    } else {
+        put_text(&new_line->text[old_line->cursor],
+                 common - old_line->cursor);
+    }
+
+    put_text(&new_line->text[common], new_line->len - common);
+    if (old_line->len > new_line->len) {
+        pfs_io_puts_immediately(PFS_IO_ERASE_LINE_RIGHT);
+    }
+    for (size_t i = new_line->cursor; i < new_line->len; i++) {
+        pfs_io_puts_immediately(PFS_IO_MOVE_LEFT);
     }
 }
 
+void pfs_io_replace_input(const pfs_input_buffer_t *value) {
+    pfs_input_buffer_t *input = get_input_buffer();
+    pfs_io_line_t old_line = {
+            .text = input->buffer,
+            .len = input->len,
+            .cursor = input->cursor,
+    };
+    pfs_io_line_t new_line = {
+            .text = value->buffer,
+            .len = value->len,
+            .cursor = value->cursor,
+    };
+    pfs_io_redraw_line(PFS_IO_SHELL_PROMPT, &old_line, &new_line);
+
+    memcpy(input->buffer, value->buffer, value->len);
+    input->len = value->len;
+    input->cursor = value->cursor;
+    input->buffer[input->len] = '\0';
+}
+
+static void handle_other_characters(char c) {
+    if (!isprint(c)) {
+        return;
+    }
+    pfs_io_insert_text(&c, 1);
+}
+
 void pfs_io_handle_input_char(char c) {
+    pfs_input_buffer_t *input = get_input_buffer();
+    if (pfs_escape_sequence_handle_char(input, c)) {
+        return;
+    }
+#ifdef PFS_WITH_COMMAND_HISTORY
+    if (pfs_history_search_is_active()
+        && pfs_history_search_handle_char(input, c)) {
+        return;
+    }
+#endif // PFS_WITH_COMMAND_HISTORY
     switch (c) {
     case PFS_IO_CHAR_CTRL_C:
         handle_char_ctrl_c();
@@ -156,24 +261,55 @@ void pfs_io_handle_input_char(char c) {
         handle_char_enter();
         break;
     case PFS_IO_CHAR_TAB:
-        pfs_autocompletion(&m_input_buffer);
+        pfs_autocompletion(input);
         break;
     case PFS_IO_CHAR_ESACPE:
-        pfs_handle_esacpe_sequence(&m_input_buffer);
+        pfs_handle_esacpe_sequence(input);
+        break;
+#ifdef PFS_WITH_COMMAND_HISTORY
+    case PFS_IO_CHAR_CTRL_R:
+        pfs_history_search_start(input);
         break;
+#endif // PFS_WITH_COMMAND_HISTORY
     default:
         handle_other_characters(c);
         break;
     }
 }
 
+// formatted output is streamed through a small chunk, so the stack used does
+// not depend on the length of the message
+#define PRINTF_CHUNK_SIZE (64U)
+
+typedef struct {
+    char buffer[PRINTF_CHUNK_SIZE + 1];
+    size_t len;
+} printf_chunk_t;
+
+static void flush_chunk(printf_chunk_t *chunk) {
+    if (chunk->len == 0) {
+        return;
+    }
+    chunk->buffer[chunk->len] = '\0';
+    pfs_io_puts_immediately(chunk->buffer);
+    chunk->len = 0;
+}
+
+static void put_chunk_char(char c, void *arg) {
+    printf_chunk_t *chunk = (printf_chunk_t *) arg;
+    if (c == '\0') {
+        return;
+    }
+    chunk->buffer[chunk->len++] = c;
+    if (chunk->len == PRINTF_CHUNK_SIZE) {
+        flush_chunk(chunk);
+    }
+}
+
 void pfs_io_vprintf_immediately(const char *format, va_list va) {
-    // dunno about this buffer size
-    const size_t BUFFER_SIZE = 2048;
-    char out_buffer[BUFFER_SIZE];
-    memset(out_buffer, 0, sizeof(out_buffer));
-    int ret = vsnprintf(out_buffer, BUFFER_SIZE, format, va);
-    pfs_io_puts_immediately(out_buffer);
+    printf_chunk_t chunk = {.len = 0};
+    (void) vfctprintf(put_chunk_char, &chunk, format, va);
+    flush_chunk(&chunk);
 }
 
 void __attribute__((format(printf, 1, 2)))
@@ -185,8 +321,5 @@ pfs_io_printf_immediately(const char *format, ...) {
 }
 
 void PFS_REAL(pfs_io_puts_immediately)(const char *s) {
-    while (*s) {
-        putchar(*s);
-        s++;
-    }
+    write_immediately(s, strlen(s));
 }
@@ -24,6 +24,7 @@
 
 #include <inttypes.h>
 #include <stdarg.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -100,6 +101,7 @@ extern "C" {
 #define PFS_IO_CHAR_BACKSPACE 0x08
 #define PFS_IO_CHAR_TAB 0x09
 #define PFS_IO_CHAR_ENTER 0x0D
+#define PFS_IO_CHAR_CTRL_R 0x12
 #define PFS_IO_CHAR_ESACPE 0x1B
 #define PFS_IO_CHAR_CTRL_H 0x7f
 
@@ -111,7 +113,30 @@ typedef struct {
     uint16_t cursor;
 } pfs_input_buffer_t;
 
+typedef struct {
+    const char *text;
+    size_t len;
+    size_t cursor;
+} pfs_io_line_t;
+
 void pfs_io_handle_input_char(char c);
+/**
+ * Inserts printable text at the cursor position as a single edit. Text that
+ * does not fit into the input buffer is truncated.
+ */
+void pfs_io_insert_text(const char *text, size_t len);
+/**
+ * Replaces the whole input line, redrawing only the part that differs.
+ */
+void pfs_io_replace_input(const pfs_input_buffer_t *value);
+/**
+ * Turns the displayed `old_line` (following `prompt`) into `new_line`,
+ * rewriting only the part that differs. Moving the cursor back is done either
+ * with `PFS_IO_MOVE_LEFT` or by reprinting the prompt, whichever is shorter.
+ */
+void pfs_io_redraw_line(const char *prompt,
+                        const pfs_io_line_t *old_line,
+                        const pfs_io_line_t *new_line);
 void __attribute__((format(printf, 1, 2)))
 pfs_io_printf_immediately(const char *format, ...);
 void pfs_io_vprintf_immediately(const char *format, va_list va);
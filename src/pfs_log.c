@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+#include "pfs_io.h"
+#include "pfs_log.h"
+#include "pfs_utils.h"
+
+void _pfs_append_queue(const char *buffer, uint32_t buffer_size);
+bool _pfs_is_initialized(void);
+
+static const char *const LEVEL_NAMES[] = {"off", "err", "wrn", "inf", "dbg"};
+static const char *const LEVEL_TAGS[] = {"", "ERR", "WRN", "INF", "DBG"};
+
+// modules are only ever pushed to the front, so the list can be walked
+// without a lock
+static pfs_log_module_t *m_modules = NULL;
+
+#ifdef PFS_WITH_TESTS
+void pfs_reset_log_modules(void) {
+    m_modules = NULL;
+}
+#endif // PFS_WITH_TESTS
+
+int pfs_log_module_register(pfs_log_module_t *module) {
+    pfs_log_module_t *head = __atomic_load_n(&m_modules, __ATOMIC_ACQUIRE);
+    do {
+        for (const pfs_log_module_t *it = head; it != NULL; it = it->next) {
+            if (it == module) {
+                return 0;
+            }
+            if (strcmp(it->name, module->name) == 0) {
+                PFS_SHELL_LOG(ERR, "log module '%s' already registered\n",
+                              module->name);
+                return 1;
+            }
+        }
+        module->next = head;
+    } while (!__atomic_compare_exchange_n(&m_modules, &head, module, true,
+                                          __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+    return 0;
+}
+
+void pfs_log(const pfs_log_module_t *module,
+             uint8_t level,
+             const char *format,
+             ...) {
+    if (level >= PFS_ARRAY_SIZE(LEVEL_TAGS)) {
+        level = PFS_LOG_LEVEL_DBG;
+    }
+    // formatted at once and queued as a single message, so it is not
+    // interleaved with the output of other tasks
+    char line[PFS_LOG_LINE_SIZE];
+    int ret = snprintf(line, sizeof(line), "%s %s: ", LEVEL_TAGS[level],
+                       module->name);
+    size_t len = 0;
+    if (ret > 0) {
+        len = (size_t) ret < sizeof(line) ? (size_t) ret : sizeof(line) - 1;
+    }
+    va_list va;
+    va_start(va, format);
+    ret = vsnprintf(&line[len], sizeof(line) - len, format, va);
+    va_end(va);
+    if (ret > 0) {
+        len += (size_t) ret;
+    }
+    if (len >= sizeof(line)) {
+        // truncated, keep the line ended
+        len = sizeof(line) - 1;
+        line[len - 1] = '\n';
+    }
+
+    if (_pfs_is_initialized()) {
+        _pfs_append_queue(line, (uint32_t) len);
+    } else {
+        printf("%s", line);
+    }
+}
+
+uint8_t pfs_log_line_level(const char *line) {
+    for (uint8_t level = PFS_LOG_LEVEL_ERR; level < PFS_ARRAY_SIZE(LEVEL_TAGS);
+         level++) {
+        size_t len = strlen(LEVEL_TAGS[level]);
+        if (strncmp(line, LEVEL_TAGS[level], len) == 0 && line[len] == ' ') {
+            return level;
+        }
+    }
+    return PFS_LOG_LEVEL_OFF;
+}
+
+static pfs_log_module_t *find_module(const char *name) {
+    pfs_log_module_t *it = __atomic_load_n(&m_modules, __ATOMIC_ACQUIRE);
+    for (; it != NULL; it = it->next) {
+        if (strcmp(it->name, name) == 0) {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+int pfs_log_parse_level(const char *name, uint8_t *out_level) {
+    for (size_t i = 0; i < PFS_ARRAY_SIZE(LEVEL_NAMES); i++) {
+        if (strcasecmp(name, LEVEL_NAMES[i]) == 0) {
+            *out_level = (uint8_t) i;
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void print_levels(void) {
+    const pfs_log_module_t *it = __atomic_load_n(&m_modules, __ATOMIC_ACQUIRE);
+    if (it == NULL) {
+        PFS_SHELL_LOG(INF, "no log modules registered\n");
+        return;
+    }
+    for (; it != NULL; it = it->next) {
+        PFS_SHELL_LOG(INF, "%-16s %s\n", it->name, LEVEL_NAMES[it->level]);
+    }
+}
+
+int pfs_log_command(int argc, char **argv) {
+    if (argc == 0) {
+        print_levels();
+        return 0;
+    }
+    uint8_t level;
+    if (argc != 2 || pfs_log_parse_level(argv[1], &level)) {
+        PFS_SHELL_LOG(WRN, "usage: loglevel [<module>|all "
+                           "<off|err|wrn|inf|dbg>]\n");
+        return 1;
+    }
+
+    if (strcmp(argv[0], "all") == 0) {
+        pfs_log_module_t *it = __atomic_load_n(&m_modules, __ATOMIC_ACQUIRE);
+        for (; it != NULL; it = it->next) {
+            it->level = level;
+        }
+    } else {
+        pfs_log_module_t *module = find_module(argv[0]);
+        if (module == NULL) {
+            PFS_SHELL_LOG(WRN, "%s: log module not found\n", argv[0]);
+            PFS_SHELL_LOG(WRN, "type 'loglevel' for a list of log modules\n");
+            return 1;
+        }
+        module->level = level;
+    }
+    if (level > PFS_LOG_LEVEL_MAX) {
+        PFS_SHELL_LOG(WRN, "'%s' messages are not compiled in, see "
+                           "PFS_LOG_LEVEL_MAX\n",
+                      LEVEL_NAMES[level]);
+    }
+    return 0;
+}
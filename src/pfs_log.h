@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <pico_freertos_shell/log.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// longer log messages are truncated, the buffer is on the caller's stack
+#ifndef PFS_LOG_LINE_SIZE
+#define PFS_LOG_LINE_SIZE (128U)
+#endif // PFS_LOG_LINE_SIZE
+
+/**
+ * @brief Parses a level name (`off`, `err`, `wrn`, `inf` or `dbg`).
+ *
+ * @return 0 on success, 1 if the name is not a level
+ */
+int pfs_log_parse_level(const char *name, uint8_t *out_level);
+
+/**
+ * @brief Returns the level of a line printed by `PFS_LOG()`, judging by its
+ *        tag, or `PFS_LOG_LEVEL_OFF` for any other line.
+ */
+uint8_t pfs_log_line_level(const char *line);
+
+/**
+ * @brief Handles the `loglevel` built-in command
+ *        (`loglevel` or `loglevel <module|all> <off|err|wrn|inf|dbg>`).
+ */
+int pfs_log_command(int argc, char **argv);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
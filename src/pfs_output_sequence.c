@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "pfs_output_sequence.h"
+
+#if PFS_OUTPUT_SEQUENCE_PRODUCERS > 255
+#error "PFS_OUTPUT_SEQUENCE_PRODUCERS must fit in 2 hex digits"
+#endif
+
+typedef struct {
+    const void *producer;
+    uint16_t next_sequence;
+} producer_t;
+
+// slot 0 is shared by the producers that don't fit
+static producer_t m_producers[PFS_OUTPUT_SEQUENCE_PRODUCERS + 1];
+
+#ifdef PFS_WITH_TESTS
+void pfs_reset_output_sequence(void) {
+    memset(m_producers, 0, sizeof(m_producers));
+}
+#endif // PFS_WITH_TESTS
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+static void put_hex(char *out, uint32_t value, size_t digits) {
+    for (size_t i = digits; i > 0; i--) {
+        out[i - 1] = HEX_DIGITS[value & 0xf];
+        value >>= 4;
+    }
+}
+
+static int parse_hex(const char *in, size_t digits, uint32_t *out_value) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < digits; i++) {
+        char c = in[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9') {
+            value |= (uint32_t) (c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            value |= (uint32_t) (c - 'a' + 10);
+        } else {
+            return 1;
+        }
+    }
+    *out_value = value;
+    return 0;
+}
+
+static size_t producer_id(const void *producer) {
+    for (size_t id = 1; id <= PFS_OUTPUT_SEQUENCE_PRODUCERS; id++) {
+        if (m_producers[id].producer == producer) {
+            return id;
+        }
+        if (m_producers[id].producer == NULL) {
+            m_producers[id].producer = producer;
+            return id;
+        }
+    }
+    return 0;
+}
+
+void pfs_output_sequence_stamp(const void *producer, char *out_prefix) {
+    size_t id = producer_id(producer);
+    out_prefix[0] = PFS_OUTPUT_SEQUENCE_MARK;
+    put_hex(&out_prefix[1], (uint32_t) id, 2);
+    put_hex(&out_prefix[3], m_producers[id].next_sequence++, 4);
+}
+
+int pfs_output_sequence_parse(const char *prefix,
+                              uint8_t *out_producer,
+                              uint16_t *out_sequence) {
+    uint32_t producer;
+    uint32_t sequence;
+    if (prefix[0] != PFS_OUTPUT_SEQUENCE_MARK
+        || parse_hex(&prefix[1], 2, &producer)
+        || parse_hex(&prefix[3], 4, &sequence)) {
+        return 1;
+    }
+    *out_producer = (uint8_t) producer;
+    *out_sequence = (uint16_t) sequence;
+    return 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#ifndef PFS_OUTPUT_SEQUENCE_PRODUCERS
+#define PFS_OUTPUT_SEQUENCE_PRODUCERS (8U)
+#endif // PFS_OUTPUT_SEQUENCE_PRODUCERS
+
+/**
+ * With PFS_WITH_OUTPUT_SEQUENCE every queued message starts with a prefix:
+ * the mark, the producer ID (2 hex digits) and the sequence number of the
+ * message within the producer (4 hex digits, wrapping), e.g. "\x1e" "01002a".
+ * Producers are numbered from 1 in the order they print for the first time,
+ * producers beyond `PFS_OUTPUT_SEQUENCE_PRODUCERS` share the ID 0.
+ */
+#define PFS_OUTPUT_SEQUENCE_MARK '\x1e'
+#define PFS_OUTPUT_SEQUENCE_PREFIX_LEN (7U)
+
+/**
+ * @brief Writes the prefix of the next message of @p producer (e.g. a task
+ *        handle) to @p out_prefix, not NUL-terminated. Must be called in the
+ *        order the messages are queued in.
+ */
+void pfs_output_sequence_stamp(const void *producer, char *out_prefix);
+
+/**
+ * @brief Parses a prefix written by `pfs_output_sequence_stamp()`.
+ *
+ * @return 0 on success, non-zero if @p prefix is not a valid prefix.
+ */
+int pfs_output_sequence_parse(const char *prefix,
+                              uint8_t *out_producer,
+                              uint16_t *out_sequence);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pfs_io.h"
+#include "pfs_pipe.h"
+
+void pfs_pipe_reset(pfs_pipe_t *pipe) {
+    pipe->stage_count = 0;
+    pipe->line_len = 0;
+    pipe->line_judged = false;
+    pipe->line_passes = false;
+}
+
+static int parse_lines(const char *str, uint32_t *out_lines) {
+    char *end;
+    unsigned long lines = strtoul(str, &end, 10);
+    if (*str < '0' || *str > '9' || *end != '\0' || lines > UINT32_MAX) {
+        return 1;
+    }
+    *out_lines = (uint32_t) lines;
+    return 0;
+}
+
+int pfs_pipe_add_stage(pfs_pipe_t *pipe, int argc, char **argv) {
+    if (argc == 0) {
+        PFS_SHELL_LOG(WRN, "missing filter after '|'\n");
+        return 1;
+    }
+    if (pipe->stage_count >= PFS_PIPE_MAX_STAGES) {
+        PFS_SHELL_LOG(WRN, "too many filters, at most %u are supported\n",
+                      (unsigned) PFS_PIPE_MAX_STAGES);
+        return 1;
+    }
+    pfs_pipe_stage_t *stage = &pipe->stages[pipe->stage_count];
+    memset(stage, 0, sizeof(*stage));
+    if (strcmp(argv[0], "grep") == 0) {
+        if (argc != 2) {
+            PFS_SHELL_LOG(WRN, "usage: grep <text>\n");
+            return 1;
+        }
+        stage->filter = PFS_PIPE_GREP;
+        stage->text = argv[1];
+    } else if (strcmp(argv[0], "head") == 0) {
+        stage->filter = PFS_PIPE_HEAD;
+        stage->limit = PFS_PIPE_HEAD_DEFAULT_LINES;
+        if (argc > 2 || (argc == 2 && parse_lines(argv[1], &stage->limit))) {
+            PFS_SHELL_LOG(WRN, "usage: head [<lines>]\n");
+            return 1;
+        }
+    } else if (strcmp(argv[0], "count") == 0) {
+        if (argc != 1) {
+            PFS_SHELL_LOG(WRN, "usage: count\n");
+            return 1;
+        }
+        stage->filter = PFS_PIPE_COUNT;
+    } else {
+        PFS_SHELL_LOG(WRN, "%s: filter not found, use grep, head or count\n",
+                      argv[0]);
+        return 1;
+    }
+    pipe->stage_count++;
+    return 0;
+}
+
+// runs a line through the filters starting with @p first, returns whether it
+// is passed on by all of them
+static bool judge_line(pfs_pipe_t *pipe, size_t first, const char *line) {
+    for (size_t i = first; i < pipe->stage_count; i++) {
+        pfs_pipe_stage_t *stage = &pipe->stages[i];
+        switch (stage->filter) {
+        case PFS_PIPE_GREP:
+            if (strstr(line, stage->text) == NULL) {
+                return false;
+            }
+            break;
+        case PFS_PIPE_HEAD:
+            if (stage->lines >= stage->limit) {
+                return false;
+            }
+            stage->lines++;
+            break;
+        case PFS_PIPE_COUNT:
+            stage->lines++;
+            return false;
+        }
+    }
+    return true;
+}
+
+static void flush_line(pfs_pipe_t *pipe, pfs_pipe_emit_t emit) {
+    pipe->line[pipe->line_len] = '\0';
+    pipe->line_passes = judge_line(pipe, 0, pipe->line);
+    if (pipe->line_passes) {
+        emit(pipe->line, pipe->line_len);
+    }
+    pipe->line_len = 0;
+}
+
+void pfs_pipe_write(pfs_pipe_t *pipe,
+                    const char *data,
+                    size_t len,
+                    pfs_pipe_emit_t emit) {
+    while (len > 0) {
+        const char *newline = memchr(data, '\n', len);
+        size_t chunk = newline != NULL ? (size_t) (newline - data) + 1 : len;
+        if (pipe->line_judged) {
+            // the rest of a line too long to be buffered
+            if (pipe->line_passes) {
+                emit(data, chunk);
+            }
+            pipe->line_judged = newline == NULL;
+        } else {
+            size_t space = sizeof(pipe->line) - 1 - pipe->line_len;
+            if (chunk > space) {
+                chunk = space;
+                newline = NULL;
+            }
+            memcpy(&pipe->line[pipe->line_len], data, chunk);
+            pipe->line_len += chunk;
+            if (newline != NULL) {
+                flush_line(pipe, emit);
+            } else if (pipe->line_len == sizeof(pipe->line) - 1) {
+                flush_line(pipe, emit);
+                pipe->line_judged = true;
+            }
+        }
+        data += chunk;
+        len -= chunk;
+    }
+}
+
+void pfs_pipe_finish(pfs_pipe_t *pipe, pfs_pipe_emit_t emit) {
+    if (pipe->line_len > 0) {
+        flush_line(pipe, emit);
+    }
+    pipe->line_judged = false;
+    for (size_t i = 0; i < pipe->stage_count; i++) {
+        if (pipe->stages[i].filter != PFS_PIPE_COUNT) {
+            continue;
+        }
+        // the result is a line of output for the following filters
+        char line[16];
+        int len = snprintf(line, sizeof(line), "%lu\n",
+                           (unsigned long) pipe->stages[i].lines);
+        if (judge_line(pipe, i + 1, line)) {
+            emit(line, (size_t) len);
+        }
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// longer lines are judged by their beginning, the rest follows it
+#ifndef PFS_PIPE_LINE_SIZE
+#define PFS_PIPE_LINE_SIZE (128U)
+#endif // PFS_PIPE_LINE_SIZE
+
+#ifndef PFS_PIPE_MAX_STAGES
+#define PFS_PIPE_MAX_STAGES (4U)
+#endif // PFS_PIPE_MAX_STAGES
+
+#define PFS_PIPE_HEAD_DEFAULT_LINES (10U)
+
+typedef enum {
+    PFS_PIPE_GREP,
+    PFS_PIPE_HEAD,
+    PFS_PIPE_COUNT,
+} pfs_pipe_filter_t;
+
+typedef struct {
+    pfs_pipe_filter_t filter;
+    // the text lines are matched against (grep)
+    const char *text;
+    // the number of lines passed on (head)
+    uint32_t limit;
+    // lines passed on (head) or counted (count) so far
+    uint32_t lines;
+} pfs_pipe_stage_t;
+
+/**
+ * Filters the output of a command line by line, e.g. `cmd | grep x | head 5`.
+ * Set up by the shell task, then used by the command handler task only.
+ */
+typedef struct pfs_pipe {
+    pfs_pipe_stage_t stages[PFS_PIPE_MAX_STAGES];
+    size_t stage_count;
+    char line[PFS_PIPE_LINE_SIZE];
+    size_t line_len;
+    // the beginning of a line too long for the buffer has been judged, the
+    // rest of it is passed on (or dropped) the same way
+    bool line_judged;
+    bool line_passes;
+} pfs_pipe_t;
+
+// receives the filtered output
+typedef void (*pfs_pipe_emit_t)(const char *data, size_t len);
+
+void pfs_pipe_reset(pfs_pipe_t *pipe);
+
+/**
+ * @brief Appends a filter (`grep <text>`, `head [<lines>]` or `count`).
+ *
+ * @return 0 on success, 1 if the filter is invalid (a message is printed)
+ */
+int pfs_pipe_add_stage(pfs_pipe_t *pipe, int argc, char **argv);
+
+/**
+ * @brief Passes command output through the filters, complete lines that pass
+ *        all of them are given to @p emit.
+ */
+void pfs_pipe_write(pfs_pipe_t *pipe,
+                    const char *data,
+                    size_t len,
+                    pfs_pipe_emit_t emit);
+
+/**
+ * @brief Passes on an unterminated last line and the results of `count`
+ *        filters, called once the command returns.
+ */
+void pfs_pipe_finish(pfs_pipe_t *pipe, pfs_pipe_emit_t emit);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include <pico_freertos_shell/init.h>
+#include <pico_freertos_shell/transport.h>
+
+#include "pfs_session.h"
+#include "pfs_utils.h"
+
+bool _pfs_is_initialized(void);
+
+static pfs_session_t m_sessions[PFS_MAX_SESSIONS];
+static size_t m_number_of_sessions;
+// the first session is used until the shell task selects one
+static pfs_session_t *m_current = &m_sessions[0];
+
+static void session_init(pfs_session_t *session,
+                         pfs_transport_t *transport) {
+    memset(session, 0, sizeof(*session));
+    session->transport = transport;
+#ifdef PFS_WITH_COMMAND_HISTORY
+    pfs_cmd_history_init(&session->history, session->history_data,
+                         sizeof(session->history_data),
+                         PFS_COMMAND_HISTORY_SIZE);
+#ifdef PFS_WITH_COMMAND_HISTORY_STORAGE
+    // there is a single storage, it keeps the history of the first session
+    if (session == &m_sessions[0]) {
+        session->history.storage = &pfs_history_storage;
+    }
+#endif // PFS_WITH_COMMAND_HISTORY_STORAGE
+#endif // PFS_WITH_COMMAND_HISTORY
+}
+
+int pfs_session_add(pfs_transport_t *transport) {
+    if (transport == NULL || _pfs_is_initialized()) {
+        return 1;
+    }
+    if (m_number_of_sessions == PFS_ARRAY_SIZE(m_sessions)) {
+        return 1;
+    }
+    session_init(&m_sessions[m_number_of_sessions], transport);
+    m_number_of_sessions++;
+    return 0;
+}
+
+void pfs_session_init_default(pfs_transport_t *transport) {
+    if (m_number_of_sessions == 0) {
+        (void) pfs_session_add(transport);
+    }
+}
+
+void pfs_session_init_detached(pfs_session_t *session,
+                               pfs_transport_t *transport) {
+    session_init(session, transport);
+}
+
+pfs_session_t *pfs_session_current(void) {
+    return m_current;
+}
+
+void pfs_session_set_current(pfs_session_t *session) {
+    m_current = session;
+}
+
+pfs_session_t *pfs_session_get(size_t index) {
+    return index < m_number_of_sessions ? &m_sessions[index] : NULL;
+}
+
+size_t pfs_session_count(void) {
+    return m_number_of_sessions;
+}
+
+#ifdef PFS_WITH_COMMAND_HISTORY
+size_t *pfs_cmd_history_get_offset_ptr(void) {
+    return &m_current->history_offset;
+}
+
+pfs_cmd_history_t *pfs_cmd_history_get_buff_ptr(void) {
+    return &m_current->history;
+}
+#endif // PFS_WITH_COMMAND_HISTORY
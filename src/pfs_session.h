@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pfs_escape_sequences.h"
+#include "pfs_handle_shell_input.h"
+#include "pfs_io.h"
+#include "pfs_pipe.h"
+
+#ifdef PFS_WITH_COMMAND_HISTORY
+#include "pfs_cmd_history.h"
+#include "pfs_history_search.h"
+#endif // PFS_WITH_COMMAND_HISTORY
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+struct pfs_transport;
+
+/**
+ * State of a single shell session, i.e. everything the shell keeps per
+ * terminal. All sessions are served by the shell task, which makes the session
+ * it currently handles the current one (see `pfs_session_set_current()`).
+ */
+typedef struct pfs_session {
+    struct pfs_transport *transport;
+    pfs_input_buffer_t input;
+    pfs_escape_state_t escape;
+#ifdef PFS_WITH_COMMAND_HISTORY
+    pfs_cmd_history_t history;
+    size_t history_offset;
+    uint8_t history_data[PFS_COMMAND_HISTORY_BYTES];
+    pfs_history_search_t search;
+#endif // PFS_WITH_COMMAND_HISTORY
+    // tokenized input, the command handler refers to it while executing
+    char tokens[PFS_MAX_INPUT_SIZE];
+    char *argv[PFS_MAX_ARGC];
+    pfs_pipe_t pipe;
+    // managed by the shell task
+    void *output_queue;
+    size_t dropped_messages;
+    bool prompt_removed;
+    bool disconnected;
+    // queued by the shell task and finished by the command handler task, the
+    // output of a session is complete once they are equal
+    uint32_t commands_dispatched;
+    uint32_t commands_finished;
+#ifdef PFS_WITH_MESSAGE_TIMESTAMPS
+    // the last message printed did not end the line
+    bool mid_line;
+    uint64_t last_time_us;
+#endif // PFS_WITH_MESSAGE_TIMESTAMPS
+} pfs_session_t;
+
+pfs_session_t *pfs_session_current(void);
+void pfs_session_set_current(pfs_session_t *session);
+pfs_session_t *pfs_session_get(size_t index);
+size_t pfs_session_count(void);
+// adds a session served on the given transport if none was added
+void pfs_session_init_default(struct pfs_transport *transport);
+// initializes a session the shell task serves on its own (see pfs_execute()),
+// it is not counted by pfs_session_count()
+void pfs_session_init_detached(pfs_session_t *session,
+                               struct pfs_transport *transport);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "pfs_cmd_stats.h"
+#include "pfs_io.h"
+#include "pfs_stats.h"
+
+pfs_stats_t pfs_stats;
+
+static TaskHandle_t m_main_task;
+static size_t m_main_stack_size;
+static TaskHandle_t m_cmd_handler_task;
+static size_t m_cmd_handler_stack_size;
+
+void pfs_stats_set_tasks(void *main_task,
+                         size_t main_stack_size,
+                         void *cmd_handler_task,
+                         size_t cmd_handler_stack_size) {
+    m_main_task = (TaskHandle_t) main_task;
+    m_main_stack_size = main_stack_size;
+    m_cmd_handler_task = (TaskHandle_t) cmd_handler_task;
+    m_cmd_handler_stack_size = cmd_handler_stack_size;
+}
+
+static uint32_t average(uint64_t total, uint32_t count) {
+    return count ? (uint32_t) (total / count) : 0;
+}
+
+static void print_stack_usage(const char *name,
+                              TaskHandle_t task,
+                              size_t stack_size,
+                              size_t peak_words) {
+    if (task == NULL) {
+        return;
+    }
+    // the high-water mark is the minimum number of free words, since the stack
+    // was last painted with the fill byte
+    size_t free_words = (size_t) uxTaskGetStackHighWaterMark(task);
+    size_t used_words = stack_size - free_words;
+    if (peak_words > used_words) {
+        used_words = peak_words;
+    }
+    PFS_SHELL_LOG(INF, PFS_IO_TAB "%s: %u of %u words used\n", name,
+                  (unsigned) used_words, (unsigned) stack_size);
+}
+
+int pfs_stats_command(int argc, char **argv) {
+    if (argc == 1 && strcmp(argv[0], "reset") == 0) {
+        // a concurrent increment may survive the reset, which is harmless
+        memset(&pfs_stats, 0, sizeof(pfs_stats));
+        return 0;
+    }
+    if (argc != 0) {
+        PFS_SHELL_LOG(WRN, "usage: stats [reset]\n");
+        return 1;
+    }
+
+    // other tasks keep enqueueing messages while the counters are printed
+    pfs_stats_t s = pfs_stats;
+    PFS_SHELL_LOG(INF, "Messages:\n");
+    PFS_SHELL_LOG(INF,
+                  PFS_IO_TAB "enqueued: %lu (%lu bytes), emitted: %lu "
+                             "(%lu bytes)\n",
+                  (unsigned long) s.messages_enqueued,
+                  (unsigned long) s.bytes_enqueued,
+                  (unsigned long) s.messages_emitted,
+                  (unsigned long) s.bytes_emitted);
+    PFS_SHELL_LOG(INF, PFS_IO_TAB "queue high-water: %lu of %u\n",
+                  (unsigned long) s.queue_high_water,
+                  (unsigned) PFS_MSG_QUEUE_SIZE);
+    PFS_SHELL_LOG(INF,
+                  PFS_IO_TAB "dropped: %lu queue full, %lu out of memory, "
+                             "%lu disconnected\n",
+                  (unsigned long) s.drops_queue_full,
+                  (unsigned long) s.drops_no_memory,
+                  (unsigned long) s.drops_disconnected);
+    PFS_SHELL_LOG(INF,
+                  PFS_IO_TAB "drain cycles: %lu, avg %lu us, max %lu us\n",
+                  (unsigned long) s.drain_cycles,
+                  (unsigned long) average(s.drain_time_total_us,
+                                          s.drain_cycles),
+                  (unsigned long) s.drain_time_max_us);
+    PFS_SHELL_LOG(INF, "Input:\n");
+    PFS_SHELL_LOG(INF,
+                  PFS_IO_TAB "keystrokes: %lu, echo latency avg %lu us, "
+                             "max %lu us\n",
+                  (unsigned long) s.keystrokes,
+                  (unsigned long) average(s.echo_latency_total_us,
+                                          s.echo_chunks),
+                  (unsigned long) s.echo_latency_max_us);
+    PFS_SHELL_LOG(INF, "Commands:\n");
+    PFS_SHELL_LOG(INF,
+                  PFS_IO_TAB "dispatched: %lu, built-in: %lu, not found: "
+                             "%lu, invalid: %lu, queue failures: %lu\n",
+                  (unsigned long) s.commands_dispatched,
+                  (unsigned long) s.commands_builtin,
+                  (unsigned long) s.commands_not_found,
+                  (unsigned long) s.commands_invalid,
+                  (unsigned long) s.commands_queue_failures);
+    PFS_SHELL_LOG(INF, "Stack:\n");
+    print_stack_usage("PfsMainTask", m_main_task, m_main_stack_size, 0);
+    // repainted before every command, see pfs_core.c
+    print_stack_usage("PfsCmdHandlerTask", m_cmd_handler_task,
+                      m_cmd_handler_stack_size,
+                      pfs_cmd_stats_max_stack_words());
+    return 0;
+}
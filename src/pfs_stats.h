@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#ifdef PFS_WITH_STATS
+
+/**
+ * Counters of the shell pipeline, printed by the `stats` built-in command.
+ * Every counter has a single writer (the shell task, or a task holding the
+ * message mutex), so they are updated with plain increments.
+ */
+typedef struct {
+    // _pfs_append_queue(), with the message mutex taken
+    uint32_t messages_enqueued;
+    uint32_t bytes_enqueued;
+    uint32_t queue_high_water;
+    uint32_t drops_queue_full;
+    uint32_t drops_no_memory;
+    uint32_t drops_disconnected;
+    // the shell task
+    uint32_t messages_emitted;
+    uint32_t bytes_emitted;
+    uint32_t drain_cycles;
+    uint32_t drain_time_max_us;
+    uint64_t drain_time_total_us;
+    uint32_t keystrokes;
+    uint32_t echo_chunks;
+    uint32_t echo_latency_max_us;
+    uint64_t echo_latency_total_us;
+    uint32_t commands_dispatched;
+    uint32_t commands_builtin;
+    uint32_t commands_not_found;
+    uint32_t commands_invalid;
+    uint32_t commands_queue_failures;
+} pfs_stats_t;
+
+extern pfs_stats_t pfs_stats;
+
+#define PFS_STATS_ADD(Counter, Value) (pfs_stats.Counter += (Value))
+#define PFS_STATS_MAX(Counter, Value)       \
+    do {                                    \
+        uint32_t value_ = (Value);          \
+        if (value_ > pfs_stats.Counter) {   \
+            pfs_stats.Counter = value_;     \
+        }                                   \
+    } while (0)
+
+/**
+ * @brief Registers the shell tasks, whose stack high-water marks are reported.
+ */
+void pfs_stats_set_tasks(void *main_task,
+                         size_t main_stack_size,
+                         void *cmd_handler_task,
+                         size_t cmd_handler_stack_size);
+
+/**
+ * @brief Handles the `stats` built-in command (`stats [reset]`).
+ */
+int pfs_stats_command(int argc, char **argv);
+
+#else // PFS_WITH_STATS
+
+#define PFS_STATS_ADD(Counter, Value) ((void) 0)
+#define PFS_STATS_MAX(Counter, Value) ((void) 0)
+
+#endif // PFS_WITH_STATS
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// posix_openpt(), ptsname_r() and cfmakeraw()
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <pico_freertos_shell/transport_linux.h>
+
+// a peer that does not read its input for this long loses the output
+#define PFS_LINUX_TRANSPORT_WRITE_TIMEOUT_MS 100
+
+static void disconnect(pfs_linux_transport_t *linux_transport) {
+    // a pty stays open, the next client just opens its slave side again
+    if (linux_transport->listen_fd < 0) {
+        return;
+    }
+    close(linux_transport->fd);
+    linux_transport->fd = -1;
+}
+
+static int get_peer(pfs_linux_transport_t *linux_transport) {
+    if (linux_transport->fd < 0 && linux_transport->listen_fd >= 0) {
+        linux_transport->fd = accept4(linux_transport->listen_fd, NULL, NULL,
+                                      SOCK_NONBLOCK | SOCK_CLOEXEC);
+    }
+    return linux_transport->fd;
+}
+
+static int write_all(pfs_linux_transport_t *linux_transport,
+                     const char *data,
+                     size_t len) {
+    int fd = get_peer(linux_transport);
+    if (fd < 0) {
+        return 1;
+    }
+    while (len > 0) {
+        ssize_t written = linux_transport->listen_fd >= 0
+                                  ? send(fd, data, len, MSG_NOSIGNAL)
+                                  : write(fd, data, len);
+        if (written >= 0) {
+            data += written;
+            len -= (size_t) written;
+            continue;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            disconnect(linux_transport);
+            return 1;
+        }
+        struct pollfd pfd = {.fd = fd, .events = POLLOUT};
+        if (poll(&pfd, 1, PFS_LINUX_TRANSPORT_WRITE_TIMEOUT_MS) <= 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int linux_transport_write(pfs_transport_t *transport,
+                                 const char *data,
+                                 size_t len,
+                                 pfs_transport_write_done_t done,
+                                 void *arg) {
+    int ret = write_all((pfs_linux_transport_t *) transport, data, len);
+    if (done != NULL) {
+        done(arg);
+    }
+    return ret;
+}
+
+static size_t
+linux_transport_read(pfs_transport_t *transport, char *buffer, size_t size) {
+    pfs_linux_transport_t *linux_transport =
+            (pfs_linux_transport_t *) transport;
+    int fd = get_peer(linux_transport);
+    if (fd < 0) {
+        return 0;
+    }
+    ssize_t len = read(fd, buffer, size);
+    if (len > 0) {
+        return (size_t) len;
+    }
+    // EIO is returned by a pty master while its slave side is not open
+    if (len == 0
+        || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        disconnect(linux_transport);
+    }
+    return 0;
+}
+
+static void linux_transport_flush(pfs_transport_t *transport) {
+    // everything is handed over to the kernel by write
+    (void) transport;
+}
+
+static bool linux_transport_is_connected(pfs_transport_t *transport) {
+    // a pty always is, its slave side may be opened at any time
+    return get_peer((pfs_linux_transport_t *) transport) >= 0;
+}
+
+static const pfs_transport_vtable_t LINUX_TRANSPORT_VTABLE = {
+        .write = linux_transport_write,
+        .read = linux_transport_read,
+        .flush = linux_transport_flush,
+        .set_rx_callback = NULL,
+        .is_connected = linux_transport_is_connected,
+};
+
+static void transport_init(pfs_linux_transport_t *transport) {
+    transport->base.vtable = &LINUX_TRANSPORT_VTABLE;
+    transport->fd = -1;
+    transport->listen_fd = -1;
+}
+
+static int set_raw_mode(const char *slave_name) {
+    int slave = open(slave_name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (slave < 0) {
+        return 1;
+    }
+    struct termios attributes;
+    int ret = tcgetattr(slave, &attributes);
+    if (ret == 0) {
+        cfmakeraw(&attributes);
+        ret = tcsetattr(slave, TCSANOW, &attributes);
+    }
+    close(slave);
+    return ret != 0;
+}
+
+int pfs_linux_transport_open_pty(pfs_linux_transport_t *transport,
+                                 char *out_name,
+                                 size_t name_size) {
+    transport_init(transport);
+    int fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        return 1;
+    }
+    if (grantpt(fd) || unlockpt(fd) || ptsname_r(fd, out_name, name_size)
+        || set_raw_mode(out_name)) {
+        close(fd);
+        return 1;
+    }
+    transport->fd = fd;
+    return 0;
+}
+
+int pfs_linux_transport_open_socket(pfs_linux_transport_t *transport,
+                                    const char *path) {
+    transport_init(transport);
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        return 1;
+    }
+    strcpy(address.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return 1;
+    }
+    (void) unlink(path);
+    if (bind(fd, (const struct sockaddr *) &address, sizeof(address))
+        || listen(fd, 1)) {
+        close(fd);
+        return 1;
+    }
+    transport->listen_fd = fd;
+    return 0;
+}
+
+void pfs_linux_transport_close(pfs_linux_transport_t *transport) {
+    if (transport->fd >= 0) {
+        close(transport->fd);
+    }
+    if (transport->listen_fd >= 0) {
+        close(transport->listen_fd);
+    }
+    transport->fd = -1;
+    transport->listen_fd = -1;
+}
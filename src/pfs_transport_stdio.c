@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+
+#include <pico/stdio/driver.h>
+#include <pico/stdlib.h>
+#if LIB_PICO_STDIO_USB
+#include <pico/stdio_usb.h>
+#endif // LIB_PICO_STDIO_USB
+
+#include <pico_freertos_shell/transport.h>
+
+// USB CDC is the only stdio driver linked in
+#if LIB_PICO_STDIO_USB && !LIB_PICO_STDIO_UART && !LIB_PICO_STDIO_RTT \
+        && !LIB_PICO_STDIO_SEMIHOSTING
+#define PFS_STDIO_USB_ONLY
+#endif // LIB_PICO_STDIO_USB
+
+// written to the driver directly, switching the global stdio filter would
+// send the output of other tasks to this driver only
+static void driver_write(stdio_driver_t *driver, const char *data, size_t len) {
+#if PICO_STDIO_ENABLE_CRLF_SUPPORT
+    // the newline translation of the stdio core, bypassed here
+    if (driver->crlf_enabled) {
+        size_t start = 0;
+        for (size_t i = 0; i < len; i++) {
+            if (data[i] == '\n' && (i == 0 || data[i - 1] != '\r')) {
+                driver->out_chars(&data[start], (int) (i - start));
+                driver->out_chars("\r", 1);
+                start = i;
+            }
+        }
+        data += start;
+        len -= start;
+    }
+#endif // PICO_STDIO_ENABLE_CRLF_SUPPORT
+    driver->out_chars(data, (int) len);
+}
+
+static int stdio_transport_write(pfs_transport_t *transport,
+                                 const char *data,
+                                 size_t len,
+                                 pfs_transport_write_done_t done,
+                                 void *arg) {
+    pfs_stdio_transport_t *stdio_transport =
+            (pfs_stdio_transport_t *) transport;
+    stdio_driver_t *driver = stdio_transport->driver;
+    if (driver != NULL) {
+        driver_write(driver, data, len);
+    } else {
+        // putchar() is not queued by the wrapped stdio, unlike printf() and
+        // puts()
+        for (size_t i = 0; i < len; i++) {
+            putchar(data[i]);
+        }
+    }
+    if (done != NULL) {
+        done(arg);
+    }
+    return 0;
+}
+
+static size_t
+stdio_transport_read(pfs_transport_t *transport, char *buffer, size_t size) {
+    pfs_stdio_transport_t *stdio_transport =
+            (pfs_stdio_transport_t *) transport;
+    stdio_driver_t *driver = stdio_transport->driver;
+    if (driver != NULL) {
+        if (driver->in_chars == NULL) {
+            return 0;
+        }
+        int ret = driver->in_chars(buffer, (int) size);
+        return ret > 0 ? (size_t) ret : 0;
+    }
+    size_t len = 0;
+    while (len < size) {
+        int c = getchar_timeout_us(0);
+        if (c < 0) {
+            break;
+        }
+        buffer[len++] = (char) c;
+    }
+    return len;
+}
+
+static void stdio_transport_flush(pfs_transport_t *transport) {
+    (void) transport;
+    stdio_flush();
+}
+
+static void
+stdio_transport_set_rx_callback(pfs_transport_t *transport,
+                                pfs_transport_rx_callback_t callback,
+                                void *arg) {
+    pfs_stdio_transport_t *stdio_transport =
+            (pfs_stdio_transport_t *) transport;
+    stdio_driver_t *driver = stdio_transport->driver;
+    if (driver == NULL) {
+        stdio_set_chars_available_callback(callback, arg);
+    } else if (driver->set_chars_available_callback != NULL) {
+        driver->set_chars_available_callback(callback, arg);
+    }
+}
+
+static bool stdio_transport_is_connected(pfs_transport_t *transport) {
+#if LIB_PICO_STDIO_USB
+    // only USB CDC knows whether the host has opened the port
+    stdio_driver_t *driver = ((pfs_stdio_transport_t *) transport)->driver;
+    if (driver == &stdio_usb) {
+        return stdio_usb_connected();
+    }
+#ifdef PFS_STDIO_USB_ONLY
+    if (driver == NULL) {
+        return stdio_usb_connected();
+    }
+#endif // PFS_STDIO_USB_ONLY
+#endif // LIB_PICO_STDIO_USB
+    (void) transport;
+    return true;
+}
+
+static const pfs_transport_vtable_t STDIO_TRANSPORT_VTABLE = {
+        .write = stdio_transport_write,
+        .read = stdio_transport_read,
+        .flush = stdio_transport_flush,
+        .set_rx_callback = stdio_transport_set_rx_callback,
+        .is_connected = stdio_transport_is_connected,
+};
+
+void pfs_stdio_transport_init(pfs_stdio_transport_t *transport,
+                              struct stdio_driver *driver) {
+    transport->base.vtable = &STDIO_TRANSPORT_VTABLE;
+    transport->driver = driver;
+}
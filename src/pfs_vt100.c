@@ -29,11 +29,10 @@
 
 #include "pfs_escape_sequences.h"
 #include "pfs_io.h"
+#include "pfs_session.h"
 #include "pfs_utils.h"
 
 #ifdef PFS_TERMINAL_TYPE_VT100
-static char m_buffer[sizeof("[[<v>;<h>H")];
-
 static const pfs_escape_sequence_t const ESCAPE_SEQUENCES[] = {
         {.str = "[D", .handler = pfs_esc_seq_arrow_left},
         {.str = "[C", .handler = pfs_esc_seq_arrow_right},
@@ -48,74 +47,89 @@ static const pfs_escape_sequence_t const ESCAPE_SEQUENCES[] = {
         {.str = "[F", .handler = pfs_esc_seq_end},
 };
 
-static int find_longest_escape_sequence(void) {
-    static int m_longest_escape_sequence = -1;
-    if (m_longest_escape_sequence >= 0) {
-        return m_longest_escape_sequence;
-    }
-    int longest = 0;
-    for (size_t i = 0; i < PFS_ARRAY_SIZE(ESCAPE_SEQUENCES); i++) {
-        int len = strlen(ESCAPE_SEQUENCES[i].str);
-        if (len > longest) {
-            longest = len;
-        }
-    }
+uint32_t _pfs_time_us(void);
 
-    return longest;
+static pfs_escape_state_t *get_state(void) {
+    return &pfs_session_current()->escape;
+}
+
+static void reset_state(pfs_escape_state_t *state) {
+    memset(state, 0, sizeof(*state));
 }
 
 void pfs_handle_esacpe_sequence(pfs_input_buffer_t *input_buffer) {
-    memset(m_buffer, 0, sizeof(m_buffer));
-    int longest = find_longest_escape_sequence();
+    (void) input_buffer;
+    pfs_escape_state_t *state = get_state();
+    reset_state(state);
+    state->active = true;
+    state->last_us = _pfs_time_us();
+}
 
-    for (int i = 0; i < longest; i++) {
-        // assume the whole sequence is sent at once (should be...)
-        char c = getchar_timeout_us(1);
-        if (c < 0 || c > 127) {
-            break;
-        }
-        m_buffer[i] = c;
+void pfs_escape_sequence_flush(pfs_input_buffer_t *input_buffer) {
+    (void) input_buffer;
+    pfs_escape_state_t *state = get_state();
+    if (!state->active) {
+        return;
+    }
+    char buffer[sizeof(state->buffer)];
+    size_t len = state->len;
+    memcpy(buffer, state->buffer, sizeof(buffer));
+    reset_state(state);
+
+    // a lone escape character is ignored
+    if (len == 0) {
+        return;
+    }
+    pfs_io_handle_input_char('\\');
+    pfs_io_handle_input_char('0');
+    pfs_io_handle_input_char('3');
+    pfs_io_handle_input_char('3');
+    for (size_t i = 0; i < len; i++) {
+        pfs_io_handle_input_char(buffer[i]);
     }
+}
 
-    bool found = false;
+void pfs_escape_sequence_expire(pfs_input_buffer_t *input_buffer,
+                                uint32_t now_us) {
+    pfs_escape_state_t *state = get_state();
+    if (state->active
+        && now_us - state->last_us >= PFS_ESCAPE_SEQUENCE_TIMEOUT_US) {
+        pfs_escape_sequence_flush(input_buffer);
+    }
+}
 
-    size_t input_len = strlen(m_buffer);
+bool pfs_escape_sequence_handle_char(pfs_input_buffer_t *input_buffer,
+                                     char c) {
+    pfs_escape_state_t *state = get_state();
+    if (!state->active) {
+        return false;
+    }
+    if (c < 0 || c > 127) {
+        // not a part of any sequence, end the current one
+        pfs_escape_sequence_flush(input_buffer);
+        return false;
+    }
+    state->buffer[state->len++] = c;
+    state->last_us = _pfs_time_us();
 
+    bool is_prefix = false;
     for (size_t i = 0; i < PFS_ARRAY_SIZE(ESCAPE_SEQUENCES); i++) {
-        size_t len = strlen(ESCAPE_SEQUENCES[i].str);
-        bool differ = false;
-        for (size_t j = 0; j < len; j++) {
-            if (m_buffer[j] != ESCAPE_SEQUENCES[i].str[j]) {
-                differ = true;
-                break;
-            }
-        }
-        if (differ) {
+        const char *str = ESCAPE_SEQUENCES[i].str;
+        if (strncmp(str, state->buffer, state->len) != 0) {
             continue;
         }
-        found = true;
-        ESCAPE_SEQUENCES[i].handler(input_buffer);
-        for (size_t j = strlen(ESCAPE_SEQUENCES[i].str); j < input_len; j++) {
-            pfs_io_handle_input_char(m_buffer[j]);
+        if (str[state->len] == '\0') {
+            reset_state(state);
+            ESCAPE_SEQUENCES[i].handler(input_buffer);
+            return true;
         }
-        break;
+        is_prefix = true;
     }
 
-    if (found) {
-        return;
-    }
-
-    if (input_len == 0) {
-        return;
-    }
-
-    pfs_io_handle_input_char('\\');
-    pfs_io_handle_input_char('0');
-    pfs_io_handle_input_char('3');
-    pfs_io_handle_input_char('3');
-    for (size_t i = 0; i < input_len; i++) {
-        pfs_io_handle_input_char(m_buffer[i]);
+    if (!is_prefix || state->len == PFS_ESCAPE_SEQUENCE_MAX_LEN) {
+        pfs_escape_sequence_flush(input_buffer);
     }
+    return true;
 }
 
 #endif // PFS_TERMINAL_TYPE_VT100
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <test_utils.h>
+
+#include <pico_freertos_shell/commands.h>
+
+#include <pfs_autocompletion.h>
+#include <pfs_session.h>
+#include <pfs_utils.h>
+
+#include "benchmark_utils.h"
+
+static void dummy_cmd_handler(int argc, char **argv) {
+    (void) argc;
+    (void) argv;
+}
+
+static void set_input(pfs_input_buffer_t *input, const char *line) {
+    input->len = strlen(line);
+    input->cursor = input->len;
+    memcpy(input->buffer, line, input->len + 1);
+}
+
+static void benchmark_autocompletion(const char *shape,
+                                     size_t number_of_leaves,
+                                     size_t fanout) {
+    size_t len;
+    pfs_command_t *commands = benchmark_generate_commands(
+            number_of_leaves, fanout, dummy_cmd_handler, &len);
+    if (pfs_commands_add(commands, len)) {
+        fprintf(stderr, "%s\n", utils_get_out_string_immediately_buffer());
+        exit(1);
+    }
+    // the last word has a single candidate, so a space is appended to it
+    char line[PFS_MAX_INPUT_SIZE];
+    size_t line_len =
+            benchmark_last_command_path(commands, len, line, sizeof(line));
+
+    pfs_input_buffer_t *input = &pfs_session_current()->input;
+    const size_t iterations = 1000000;
+    benchmark_t benchmark = {0};
+    for (size_t i = 0; i < iterations; i++) {
+        set_input(input, line);
+        utils_reset_out_string_immediately_buffer();
+        benchmark_begin(&benchmark);
+        pfs_autocompletion(input);
+        benchmark_end(&benchmark);
+        if (input->len != line_len + 1) {
+            fprintf(stderr, "'%s' not completed\n", line);
+            exit(1);
+        }
+    }
+
+    benchmark_report(&benchmark, "autocompletion",
+                     "\"shape\": \"%s\", \"commands\": %zu, \"line\": \"%s\"",
+                     shape, number_of_leaves, line);
+
+    set_input(input, "");
+    pfs_commands_remove(commands, len);
+    benchmark_free_commands(commands, len);
+}
+
+int main(int argc, char **argv) {
+    const size_t defaults[] = {10, 1000, 10000};
+    size_t sizes[16];
+    size_t number_of_sizes = benchmark_sizes(
+            argc, argv, defaults, PFS_ARRAY_SIZE(defaults), sizes, 16);
+
+    for (size_t i = 0; i < number_of_sizes; i++) {
+        benchmark_autocompletion("flat", sizes[i], 0);
+        benchmark_autocompletion("tree", sizes[i], 10);
+    }
+
+    return 0;
+}
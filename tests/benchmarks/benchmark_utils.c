@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "benchmark_utils.h"
+
+static size_t m_allocations;
+static size_t m_name_counter;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t number, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    m_allocations++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t number, size_t size) {
+    m_allocations++;
+    return __real_calloc(number, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    m_allocations++;
+    return __real_realloc(ptr, size);
+}
+
+size_t benchmark_allocations(void) {
+    return m_allocations;
+}
+
+uint64_t benchmark_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+void benchmark_begin(benchmark_t *benchmark) {
+    benchmark->start_allocations = m_allocations;
+    benchmark->start_ns = benchmark_now_ns();
+}
+
+void benchmark_end(benchmark_t *benchmark) {
+    benchmark->elapsed_ns += benchmark_now_ns() - benchmark->start_ns;
+    benchmark->allocations += m_allocations - benchmark->start_allocations;
+    benchmark->iterations++;
+}
+
+void benchmark_report(const benchmark_t *benchmark,
+                      const char *name,
+                      const char *params_format,
+                      ...) {
+    size_t iterations = benchmark->iterations ? benchmark->iterations : 1;
+    printf("{\"benchmark\": \"%s\", ", name);
+    va_list va;
+    va_start(va, params_format);
+    vprintf(params_format, va);
+    va_end(va);
+    printf(", \"iterations\": %zu, \"ns_per_op\": %.1f, "
+           "\"allocs_per_op\": %.2f}\n",
+           benchmark->iterations,
+           (double) benchmark->elapsed_ns / (double) iterations,
+           (double) benchmark->allocations / (double) iterations);
+}
+
+size_t benchmark_sizes(int argc,
+                       char **argv,
+                       const size_t *defaults,
+                       size_t number_of_defaults,
+                       size_t *out_sizes,
+                       size_t max_sizes) {
+    size_t len = 0;
+    for (int i = 1; i < argc && len < max_sizes; i++) {
+        out_sizes[len++] = strtoul(argv[i], NULL, 10);
+    }
+    if (len > 0) {
+        return len;
+    }
+    for (; len < number_of_defaults && len < max_sizes; len++) {
+        out_sizes[len] = defaults[len];
+    }
+    return len;
+}
+
+static const char *next_name(void) {
+    char *name = malloc(16);
+    snprintf(name, 16, "cmd%zu", m_name_counter++);
+    return name;
+}
+
+pfs_command_t *benchmark_generate_commands(size_t number_of_leaves,
+                                           size_t fanout,
+                                           pfs_command_handler_t handler,
+                                           size_t *out_len) {
+    bool flat = fanout == 0 || number_of_leaves <= fanout;
+    size_t len = flat ? number_of_leaves : fanout;
+    pfs_command_t *commands = malloc(len * sizeof(pfs_command_t));
+
+    for (size_t i = 0; i < len; i++) {
+        if (flat) {
+            pfs_command_t command = {
+                    .description = {.name = next_name(), .help = "help"},
+                    .handler = handler};
+            memcpy(&commands[i], &command, sizeof(command));
+            continue;
+        }
+        size_t leaves = number_of_leaves / fanout
+                        + (i == len - 1 ? number_of_leaves % fanout : 0);
+        size_t subcommands_len;
+        pfs_command_t *subcommands = benchmark_generate_commands(
+                leaves, fanout, handler, &subcommands_len);
+        pfs_command_t command = {
+                .description = {.name = next_name(), .help = "help"},
+                .subcommands = subcommands,
+                .number_of_subcommands = subcommands_len};
+        memcpy(&commands[i], &command, sizeof(command));
+    }
+
+    *out_len = len;
+    return commands;
+}
+
+void benchmark_free_commands(pfs_command_t *commands, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        free((void *) commands[i].description.name);
+        benchmark_free_commands((pfs_command_t *) commands[i].subcommands,
+                                commands[i].number_of_subcommands);
+    }
+    free(commands);
+    m_name_counter = 0;
+}
+
+size_t benchmark_last_command_path(const pfs_command_t *commands,
+                                   size_t len,
+                                   char *out,
+                                   size_t size) {
+    size_t path_len = 0;
+    out[0] = '\0';
+    while (len > 0) {
+        const pfs_command_t *last = &commands[len - 1];
+        path_len += snprintf(out + path_len, size - path_len, "%s%s",
+                             path_len ? " " : "", last->description.name);
+        commands = last->subcommands;
+        len = last->number_of_subcommands;
+    }
+    return path_len;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <pico_freertos_shell/commands.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+/**
+ * Measurement of a single benchmark case. Every `benchmark_begin()` /
+ * `benchmark_end()` pair is one operation, only the time and the heap
+ * allocations (malloc/calloc/realloc, counted by wrapping them) in between are
+ * accounted.
+ */
+typedef struct {
+    size_t iterations;
+    uint64_t elapsed_ns;
+    size_t allocations;
+    uint64_t start_ns;
+    size_t start_allocations;
+} benchmark_t;
+
+void benchmark_begin(benchmark_t *benchmark);
+void benchmark_end(benchmark_t *benchmark);
+/**
+ * Prints a single JSON line with the benchmark name, the parameters (a JSON
+ * fragment formatted with `params_format`), ns/op and allocations/op.
+ */
+void benchmark_report(const benchmark_t *benchmark,
+                      const char *name,
+                      const char *params_format,
+                      ...) __attribute__((format(printf, 3, 4)));
+
+uint64_t benchmark_now_ns(void);
+size_t benchmark_allocations(void);
+
+/**
+ * Reads the sizes to benchmark from the command line, or uses the defaults if
+ * none are given. Returns the number of sizes.
+ */
+size_t benchmark_sizes(int argc,
+                       char **argv,
+                       const size_t *defaults,
+                       size_t number_of_defaults,
+                       size_t *out_sizes,
+                       size_t max_sizes);
+
+/**
+ * Generates a tree with `number_of_leaves` leaf commands (named `cmd<N>`),
+ * where every level has at most `fanout` commands. `fanout == 0` generates a
+ * flat list. The last command of every level has the greatest number among its
+ * siblings, so its name is not a prefix of any of them.
+ */
+pfs_command_t *benchmark_generate_commands(size_t number_of_leaves,
+                                           size_t fanout,
+                                           pfs_command_handler_t handler,
+                                           size_t *out_len);
+void benchmark_free_commands(pfs_command_t *commands, size_t len);
+
+/**
+ * Writes the names along the path of the last commands of every level (down
+ * to a leaf) separated with spaces. Returns the length of the path.
+ */
+size_t benchmark_last_command_path(const pfs_command_t *commands,
+                                   size_t len,
+                                   char *out,
+                                   size_t size);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <pfs_cmd_history.h>
+#include <pfs_utils.h>
+
+#include "benchmark_utils.h"
+
+// the arena is sized at runtime, use the default CMake configuration rather
+// than the tiny limits the module suites are built with
+#define HISTORY_SIZE 10
+#define HISTORY_BYTES 512
+
+static uint8_t m_history_data[HISTORY_BYTES];
+static pfs_cmd_history_t m_history;
+
+static void set_line(pfs_input_buffer_t *value, size_t line_size, size_t i) {
+    memset(value->buffer, 'a' + i % 26, line_size);
+    value->buffer[line_size] = '\0';
+    value->len = line_size;
+    value->cursor = line_size;
+}
+
+static void fill_history(size_t line_size) {
+    pfs_cmd_history_init(&m_history, m_history_data, sizeof(m_history_data),
+                         HISTORY_SIZE);
+    pfs_input_buffer_t value;
+    for (size_t i = 0; i < HISTORY_SIZE; i++) {
+        set_line(&value, line_size, i);
+        (void) pfs_cmd_history_append(&m_history, &value);
+    }
+}
+
+static void benchmark_append(size_t line_size) {
+    fill_history(line_size);
+    pfs_input_buffer_t value;
+    const size_t iterations = 2000000;
+    benchmark_t benchmark = {0};
+    for (size_t i = 0; i < iterations; i++) {
+        set_line(&value, line_size, i);
+        // the history is full, so every append evicts the oldest entries
+        benchmark_begin(&benchmark);
+        (void) pfs_cmd_history_append(&m_history, &value);
+        benchmark_end(&benchmark);
+    }
+    benchmark_report(&benchmark, "history_append",
+                     "\"line_size\": %zu, \"entries\": %zu", line_size,
+                     m_history.occupancy);
+}
+
+static void benchmark_get_oldest(size_t line_size) {
+    fill_history(line_size);
+    pfs_input_buffer_t value;
+    const size_t iterations = 2000000;
+    benchmark_t benchmark = {0};
+    for (size_t i = 0; i < iterations; i++) {
+        benchmark_begin(&benchmark);
+        int ret = pfs_cmd_history_get(&m_history, m_history.occupancy, &value);
+        benchmark_end(&benchmark);
+        if (ret != 0) {
+            fprintf(stderr, "history_get failed\n");
+            exit(1);
+        }
+    }
+    benchmark_report(&benchmark, "history_get_oldest",
+                     "\"line_size\": %zu, \"entries\": %zu", line_size,
+                     m_history.occupancy);
+}
+
+static void benchmark_find_missing(size_t line_size) {
+    fill_history(line_size);
+    size_t offset;
+    const size_t iterations = 2000000;
+    benchmark_t benchmark = {0};
+    for (size_t i = 0; i < iterations; i++) {
+        // no entry matches, so all of them are compared
+        benchmark_begin(&benchmark);
+        int ret = pfs_cmd_history_find(&m_history, 0, true, "z?", 2, false,
+                                       &offset);
+        benchmark_end(&benchmark);
+        if (ret == 0) {
+            fprintf(stderr, "history_find matched\n");
+            exit(1);
+        }
+    }
+    benchmark_report(&benchmark, "history_find_missing",
+                     "\"line_size\": %zu, \"entries\": %zu", line_size,
+                     m_history.occupancy);
+}
+
+int main(int argc, char **argv) {
+    const size_t defaults[] = {8, 32, 63};
+    size_t sizes[16];
+    size_t number_of_sizes = benchmark_sizes(
+            argc, argv, defaults, PFS_ARRAY_SIZE(defaults), sizes, 16);
+
+    for (size_t i = 0; i < number_of_sizes; i++) {
+        if (sizes[i] >= PFS_MAX_INPUT_SIZE) {
+            sizes[i] = PFS_MAX_INPUT_SIZE - 1;
+        }
+        benchmark_append(sizes[i]);
+        benchmark_get_oldest(sizes[i]);
+        benchmark_find_missing(sizes[i]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <test_utils.h>
+
+#include <pico_freertos_shell/commands.h>
+
+#include <pfs_command_index.h>
+#include <pfs_utils.h>
+
+#include "benchmark_utils.h"
+
+static void dummy_cmd_handler(int argc, char **argv) {
+    (void) argc;
+    (void) argv;
+}
+
+/**
+ * Resolves the words of the path the same way the shell does when looking for
+ * a command handler: one binary search per level of the command index.
+ */
+static const pfs_command_t *find_command(const pfs_command_index_t *index,
+                                         const char *path) {
+    const pfs_command_index_node_t *node = NULL;
+    while (*path != '\0') {
+        const char *end = strchr(path, ' ');
+        size_t len = end ? (size_t) (end - path) : strlen(path);
+        size_t number_of_nodes;
+        const pfs_command_index_node_t *nodes =
+                pfs_command_index_children(index, node, &number_of_nodes);
+        node = pfs_command_index_find(nodes, number_of_nodes, path, len);
+        if (node == NULL) {
+            return NULL;
+        }
+        path += end ? len + 1 : len;
+    }
+    return node ? node->command : NULL;
+}
+
+static void benchmark_command_lookup(const char *shape,
+                                     size_t number_of_leaves,
+                                     size_t fanout) {
+    size_t len;
+    pfs_command_t *commands = benchmark_generate_commands(
+            number_of_leaves, fanout, dummy_cmd_handler, &len);
+    if (pfs_commands_add(commands, len)) {
+        fprintf(stderr, "%s\n", utils_get_out_string_immediately_buffer());
+        exit(1);
+    }
+    char path[PFS_MAX_INPUT_SIZE];
+    benchmark_last_command_path(commands, len, path, sizeof(path));
+
+    const size_t iterations = 2000000;
+    benchmark_t benchmark = {0};
+    for (size_t i = 0; i < iterations; i++) {
+        benchmark_begin(&benchmark);
+        const pfs_command_t *command =
+                find_command(pfs_command_index_get(), path);
+        benchmark_end(&benchmark);
+        if (command == NULL || command->handler != dummy_cmd_handler) {
+            fprintf(stderr, "'%s' not found\n", path);
+            exit(1);
+        }
+    }
+
+    benchmark_report(&benchmark, "command_lookup",
+                     "\"shape\": \"%s\", \"commands\": %zu, \"path\": \"%s\"",
+                     shape, number_of_leaves, path);
+
+    pfs_commands_remove(commands, len);
+    benchmark_free_commands(commands, len);
+}
+
+int main(int argc, char **argv) {
+    const size_t defaults[] = {10, 1000, 10000};
+    size_t sizes[16];
+    size_t number_of_sizes = benchmark_sizes(
+            argc, argv, defaults, PFS_ARRAY_SIZE(defaults), sizes, 16);
+
+    for (size_t i = 0; i < number_of_sizes; i++) {
+        benchmark_command_lookup("flat", sizes[i], 0);
+        benchmark_command_lookup("tree", sizes[i], 10);
+    }
+
+    return 0;
+}
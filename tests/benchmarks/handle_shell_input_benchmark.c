@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <test_utils.h>
+
+#include <pico_freertos_shell/commands.h>
+
+#include <pfs_handle_shell_input.h>
+#include <pfs_utils.h>
+
+#include "benchmark_utils.h"
+
+static size_t m_calls;
+
+static void counting_cmd_handler(int argc, char **argv) {
+    (void) argc;
+    (void) argv;
+    m_calls++;
+}
+
+static void benchmark_handle_shell_input(const char *shape,
+                                         size_t number_of_leaves,
+                                         size_t fanout,
+                                         bool with_arguments) {
+    size_t len;
+    pfs_command_t *commands = benchmark_generate_commands(
+            number_of_leaves, fanout, counting_cmd_handler, &len);
+    if (pfs_commands_add(commands, len)) {
+        fprintf(stderr, "%s\n", utils_get_out_string_immediately_buffer());
+        exit(1);
+    }
+    char line[PFS_MAX_INPUT_SIZE];
+    size_t line_len =
+            benchmark_last_command_path(commands, len, line, sizeof(line));
+    size_t argc = 1;
+    for (size_t i = 0; i < line_len; i++) {
+        argc += line[i] == ' ';
+    }
+    // fill the rest of the line with as many arguments as the shell accepts
+    while (with_arguments && line_len + 4 < sizeof(line) &&
+           argc < PFS_MAX_ARGC) {
+        memcpy(&line[line_len], " arg", 5);
+        line_len += 4;
+        argc++;
+    }
+
+    const size_t iterations = 1000000;
+    benchmark_t benchmark = {0};
+    m_calls = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        benchmark_begin(&benchmark);
+        (void) pfs_handle_shell_input(line);
+        benchmark_end(&benchmark);
+    }
+    if (m_calls != iterations) {
+        fprintf(stderr, "%s\n", utils_get_out_string_immediately_buffer());
+        exit(1);
+    }
+
+    benchmark_report(&benchmark, "handle_shell_input",
+                     "\"shape\": \"%s\", \"commands\": %zu, "
+                     "\"line_size\": %zu, \"argc\": %zu",
+                     shape, number_of_leaves, line_len, argc);
+
+    pfs_commands_remove(commands, len);
+    benchmark_free_commands(commands, len);
+}
+
+int main(int argc, char **argv) {
+    const size_t defaults[] = {10, 1000, 10000};
+    size_t sizes[16];
+    size_t number_of_sizes = benchmark_sizes(
+            argc, argv, defaults, PFS_ARRAY_SIZE(defaults), sizes, 16);
+
+    for (size_t i = 0; i < number_of_sizes; i++) {
+        benchmark_handle_shell_input("flat", sizes[i], 0, false);
+        benchmark_handle_shell_input("flat", sizes[i], 0, true);
+        benchmark_handle_shell_input("tree", sizes[i], 10, false);
+        benchmark_handle_shell_input("tree", sizes[i], 10, true);
+    }
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <pfs_handle_shell_input.h>
+#include <pfs_utils.h>
+
+#include "benchmark_utils.h"
+
+/**
+ * Generates a line of `size` characters made of short words, every fourth of
+ * them quoted together with the next one.
+ */
+static void generate_line(char *line, size_t size) {
+    static const char *const WORDS[] = {"set ", "\"a b\" ", "0x1f ", "-v "};
+    size_t len = 0;
+    for (size_t i = 0; len < size; i++) {
+        const char *word = WORDS[i % PFS_ARRAY_SIZE(WORDS)];
+        size_t word_len = strlen(word);
+        if (len + word_len > size) {
+            break;
+        }
+        memcpy(&line[len], word, word_len);
+        len += word_len;
+    }
+    memset(&line[len], 'x', size - len);
+    line[size] = '\0';
+}
+
+static void benchmark_tokenizer(size_t line_size) {
+    char *line = malloc(line_size + 1);
+    char *input = malloc(line_size + 1);
+    size_t max_argc = line_size / 2 + 1;
+    char **argv = malloc(max_argc * sizeof(char *));
+    generate_line(line, line_size);
+
+    size_t iterations = 20000000 / (line_size + 1) + 1;
+    benchmark_t benchmark = {0};
+    int argc = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        // the tokenizer works in place
+        memcpy(input, line, line_size + 1);
+        benchmark_begin(&benchmark);
+        int ret = pfs_custom_tokenizer(input, argv, max_argc, &argc);
+        benchmark_end(&benchmark);
+        if (ret != 0) {
+            fprintf(stderr, "tokenizer failed: %d\n", ret);
+            exit(1);
+        }
+    }
+
+    benchmark_report(&benchmark, "tokenizer",
+                     "\"line_size\": %zu, \"argc\": %d", line_size, argc);
+
+    free(argv);
+    free(input);
+    free(line);
+}
+
+int main(int argc, char **argv) {
+    const size_t defaults[] = {16, 64, 256, 4096};
+    size_t sizes[16];
+    size_t number_of_sizes = benchmark_sizes(
+            argc, argv, defaults, PFS_ARRAY_SIZE(defaults), sizes, 16);
+
+    for (size_t i = 0; i < number_of_sizes; i++) {
+        benchmark_tokenizer(sizes[i]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <pthread.h>
+
+#include <FreeRTOS.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#define tskIDLE_PRIORITY ((UBaseType_t) 0U)
+
+typedef void (*TaskFunction_t)(void *parameters);
+
+typedef struct tskTaskControlBlock {
+    pthread_t thread;
+    TaskFunction_t function;
+    void *parameters;
+    uint32_t notifications;
+} StaticTask_t;
+
+typedef struct tskTaskControlBlock *TaskHandle_t;
+
+typedef struct {
+    TickType_t start;
+} TimeOut_t;
+
+// the stack is left unused, the task runs on the stack of its thread
+TaskHandle_t xTaskCreateStatic(TaskFunction_t function,
+                               const char *name,
+                               uint32_t stack_depth,
+                               void *parameters,
+                               UBaseType_t priority,
+                               StackType_t *stack,
+                               StaticTask_t *buffer);
+// NULL in threads other than the tasks (e.g. the one running the tests)
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+TickType_t xTaskGetTickCount(void);
+void vTaskDelay(TickType_t ticks);
+// the stack of the thread is not painted, nothing is reported as free
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t timeout);
+
+void vTaskSetTimeOutState(TimeOut_t *time_out);
+BaseType_t xTaskCheckForTimeOut(TimeOut_t *time_out, TickType_t *remaining);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <test_utils.h>
+
+#include <pico_freertos_shell/commands.h>
+
+#include <pfs_escape_sequences.h>
+#include <pfs_io.h>
+#include <pfs_session.h>
+#include <pfs_utils.h>
+
+// Replays an input trace (see pfs_host_shell --record) through the input path
+// and reports the output bytes emitted per input byte and the CPU time per
+// keystroke as a JSON line. Fails if the output per input byte exceeds the
+// `max_output_per_input` threshold of the trace, or if the line left after the
+// last chunk differs from the `expect_line` of the trace.
+//
+// Trace format, one chunk of input bytes (e.g. a key or an escape sequence)
+// per line:
+//   # comment, `# max_output_per_input <threshold>` or `# expect_line <text>`
+//   <microseconds since the previous chunk> <bytes as hex>
+
+#define MAX_CHUNK_SIZE (256U)
+#define MAX_CHUNKS (4096U)
+#define DEFAULT_REPEAT (100U)
+#define EXPECT_LINE "# expect_line "
+
+typedef struct {
+    uint32_t delay_us;
+    char bytes[MAX_CHUNK_SIZE];
+    size_t len;
+} chunk_t;
+
+static chunk_t m_chunks[MAX_CHUNKS];
+static size_t m_number_of_chunks;
+static double m_max_output_per_input;
+static char m_expected_line[PFS_MAX_INPUT_SIZE];
+static bool m_check_line;
+static uint32_t m_time_us;
+
+static void dummy_cmd_handler(int argc, char **argv) {
+    (void) argc;
+    (void) argv;
+}
+
+// a small command set, so that the traces can complete and run commands
+static pfs_command_t m_sensor_commands[] = {
+        PFS_COMMAND_INITIALIZER(read,
+                                "read the sensor",
+                                PFS_COMMAND_HANDLER(dummy_cmd_handler)),
+        PFS_COMMAND_INITIALIZER(reset,
+                                "reset the sensor",
+                                PFS_COMMAND_HANDLER(dummy_cmd_handler)),
+        PFS_COMMAND_INITIALIZER(write,
+                                "write the sensor",
+                                PFS_COMMAND_HANDLER(dummy_cmd_handler)),
+};
+
+static pfs_command_t m_commands[] = {
+        PFS_COMMAND_INITIALIZER(echo,
+                                "print the arguments",
+                                PFS_COMMAND_HANDLER(dummy_cmd_handler)),
+        PFS_COMMAND_INITIALIZER(sensor,
+                                "sensor commands",
+                                PFS_SUBCOMMANDS(m_sensor_commands,
+                                                PFS_ARRAY_SIZE(
+                                                        m_sensor_commands))),
+};
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+static int parse_chunk(const char *line, chunk_t *chunk) {
+    uint64_t delay_us;
+    int offset;
+    if (sscanf(line, "%" SCNu64 " %n", &delay_us, &offset) != 1) {
+        return 1;
+    }
+    // the replay does not wait, the delays only move the shell clock
+    chunk->delay_us = (uint32_t) delay_us;
+    const char *hex = &line[offset];
+    chunk->len = 0;
+    while (hex_value(hex[0]) >= 0 && hex_value(hex[1]) >= 0) {
+        if (chunk->len == MAX_CHUNK_SIZE) {
+            return 1;
+        }
+        chunk->bytes[chunk->len++] =
+                (char) (hex_value(hex[0]) << 4 | hex_value(hex[1]));
+        hex += 2;
+    }
+    return chunk->len == 0 || (*hex != '\0' && *hex != '\n');
+}
+
+static int load_trace(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "cannot open %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    char line[2 * MAX_CHUNK_SIZE + 32];
+    size_t line_number = 0;
+    int ret = 0;
+    while (ret == 0 && fgets(line, sizeof(line), file) != NULL) {
+        line_number++;
+        if (strncmp(line, EXPECT_LINE, strlen(EXPECT_LINE)) == 0) {
+            const char *text = &line[strlen(EXPECT_LINE)];
+            snprintf(m_expected_line, sizeof(m_expected_line), "%.*s",
+                     (int) strcspn(text, "\n"), text);
+            m_check_line = true;
+            continue;
+        }
+        if (line[0] == '#') {
+            (void) sscanf(line, "# max_output_per_input %lf",
+                          &m_max_output_per_input);
+            continue;
+        }
+        if (line[0] == '\n') {
+            continue;
+        }
+        if (m_number_of_chunks == MAX_CHUNKS
+            || parse_chunk(line, &m_chunks[m_number_of_chunks])) {
+            fprintf(stderr, "%s:%zu: invalid chunk\n", path, line_number);
+            ret = 1;
+        }
+        m_number_of_chunks++;
+    }
+    fclose(file);
+    return ret;
+}
+
+static uint64_t cpu_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+// as the shell task does: it wakes up in time to end an escape sequence whose
+// rest does not come, otherwise the sequence continues with the next chunk
+static void feed_chunk(const chunk_t *chunk) {
+    pfs_input_buffer_t *input = &pfs_session_current()->input;
+    uint32_t arrival_us = m_time_us + chunk->delay_us;
+    if (chunk->delay_us >= PFS_ESCAPE_SEQUENCE_TIMEOUT_US) {
+        m_time_us += PFS_ESCAPE_SEQUENCE_TIMEOUT_US;
+        utils_set_time_us(m_time_us);
+        pfs_escape_sequence_expire(input, m_time_us);
+    }
+    m_time_us = arrival_us;
+    utils_set_time_us(m_time_us);
+    for (size_t i = 0; i < chunk->len; i++) {
+        pfs_io_handle_input_char(chunk->bytes[i]);
+    }
+    pfs_escape_sequence_expire(input, m_time_us);
+}
+
+static size_t take_output(void) {
+    size_t len = strlen(utils_get_out_string_immediately_buffer());
+    utils_reset_out_string_immediately_buffer();
+    return len;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "usage: %s TRACE [REPEAT]\n", argv[0]);
+        return 1;
+    }
+    size_t repeat = argc == 3 ? strtoul(argv[2], NULL, 0) : DEFAULT_REPEAT;
+    if (load_trace(argv[1]) || repeat == 0) {
+        return 1;
+    }
+    if (pfs_commands_add(m_commands, PFS_ARRAY_SIZE(m_commands))) {
+        fprintf(stderr, "failed to add the commands\n");
+        return 1;
+    }
+
+    size_t input_bytes = 0;
+    size_t output_bytes = 0;
+    size_t max_output = 0;
+    uint64_t cpu_ns = 0;
+    for (size_t r = 0; r < repeat; r++) {
+        for (size_t i = 0; i < m_number_of_chunks; i++) {
+            uint64_t start = cpu_time_ns();
+            feed_chunk(&m_chunks[i]);
+            cpu_ns += cpu_time_ns() - start;
+            size_t len = take_output();
+            // the output is the same for every repetition
+            if (r == 0) {
+                input_bytes += m_chunks[i].len;
+                output_bytes += len;
+                max_output = len > max_output ? len : max_output;
+            }
+        }
+        const pfs_input_buffer_t *input = &pfs_session_current()->input;
+        if (r == 0 && m_check_line
+            && (input->len != strlen(m_expected_line)
+                || memcmp(input->buffer, m_expected_line, input->len) != 0)) {
+            fprintf(stderr, "line \"%.*s\", expected \"%s\"\n",
+                    (int) input->len, input->buffer, m_expected_line);
+            return 1;
+        }
+        // start the next repetition with an empty line
+        pfs_io_handle_input_char(PFS_IO_CHAR_CTRL_C);
+        (void) take_output();
+    }
+
+    const char *name = strrchr(argv[1], '/');
+    name = name != NULL ? name + 1 : argv[1];
+    double output_per_input = input_bytes > 0 ? (double) output_bytes
+                                                        / (double) input_bytes
+                                              : 0.0;
+    printf("{\"trace\": \"%s\", \"keystrokes\": %zu, \"input_bytes\": %zu, "
+           "\"output_bytes\": %zu, \"output_per_input\": %.2f, "
+           "\"max_output_per_keystroke\": %zu, "
+           "\"cpu_ns_per_keystroke\": %.1f, "
+           "\"max_output_per_input\": %.2f}\n",
+           name, m_number_of_chunks, input_bytes, output_bytes,
+           output_per_input, max_output,
+           (double) cpu_ns / (double) (repeat * m_number_of_chunks),
+           m_max_output_per_input);
+
+    if (m_max_output_per_input > 0.0
+        && output_per_input > m_max_output_per_input) {
+        fprintf(stderr, "output per input byte %.2f exceeds %.2f\n",
+                output_per_input, m_max_output_per_input);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <unity.h>
+
+#include <pfs_cmd_history.h>
+#include <pfs_history_storage.h>
+
+static uint8_t m_history_data[PFS_COMMAND_HISTORY_BYTES];
+static pfs_cmd_history_t m_history_buff;
+static pfs_cmd_history_t *m_history = &m_history_buff;
+
+static void restart(void) {
+    pfs_cmd_history_reset(m_history);
+    TEST_ASSERT_EQUAL_INT(0, pfs_cmd_history_load(m_history));
+}
+
+void setUp(void) {
+    pfs_cmd_history_init(m_history, m_history_data, sizeof(m_history_data),
+                         PFS_COMMAND_HISTORY_SIZE);
+    m_history->storage = &pfs_history_storage;
+    remove(PFS_COMMAND_HISTORY_FILE);
+    restart();
+}
+
+void tearDown(void) {
+    remove(PFS_COMMAND_HISTORY_FILE);
+}
+
+static void append(const char *line) {
+    pfs_input_buffer_t value = {0};
+    strcpy(value.buffer, line);
+    value.len = strlen(line);
+    value.cursor = value.len;
+    TEST_ASSERT_EQUAL_INT(0, pfs_cmd_history_append(m_history, &value));
+}
+
+static void assert_entry(size_t offset, const char *expected) {
+    pfs_input_buffer_t value;
+    TEST_ASSERT_EQUAL_INT(0, pfs_cmd_history_get(m_history, offset, &value));
+    TEST_ASSERT_EQUAL_STRING(expected, value.buffer);
+}
+
+static long file_size(void) {
+    FILE *file = fopen(PFS_COMMAND_HISTORY_FILE, "rb");
+    TEST_ASSERT_NOT_NULL(file);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+void LoadAfterRestart(void) {
+    // all three fit in the 16 bytes of the RAM history
+    append("ls");
+    append("cd");
+    long size = file_size();
+    append("sensor");
+    // appended as a single record, not rewritten
+    TEST_ASSERT_EQUAL_INT(size + 2 + 6, file_size());
+
+    restart();
+    TEST_ASSERT_EQUAL_INT(3, m_history->occupancy);
+    assert_entry(1, "sensor");
+    assert_entry(2, "cd");
+    assert_entry(3, "ls");
+}
+
+void CompactWhenFull(void) {
+    char line[] = "cmd00";
+    for (int i = 0; i < 30; i++) {
+        line[3] = '0' + i / 10;
+        line[4] = '0' + i % 10;
+        append(line);
+        TEST_ASSERT_TRUE(file_size() <= PFS_COMMAND_HISTORY_STORAGE_SIZE);
+    }
+
+    restart();
+    TEST_ASSERT_EQUAL_INT(2, m_history->occupancy);
+    assert_entry(1, "cmd29");
+    assert_entry(2, "cmd28");
+}
+
+void RecoverFromCorruptedFile(void) {
+    FILE *file = fopen(PFS_COMMAND_HISTORY_FILE, "wb");
+    TEST_ASSERT_NOT_NULL(file);
+    fputs("definitely not a history log", file);
+    fclose(file);
+
+    pfs_cmd_history_reset(m_history);
+    TEST_ASSERT_NOT_EQUAL(0, pfs_cmd_history_load(m_history));
+    TEST_ASSERT_EQUAL_INT(0, m_history->occupancy);
+
+    append("ls");
+    restart();
+    TEST_ASSERT_EQUAL_INT(1, m_history->occupancy);
+    assert_entry(1, "ls");
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(LoadAfterRestart);
+    RUN_TEST(CompactWhenFull);
+    RUN_TEST(RecoverFromCorruptedFile);
+
+    return UNITY_END();
+}
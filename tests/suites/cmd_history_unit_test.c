@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+
+#include <unity.h>
+
+#include <pfs_cmd_history.h>
+
+static uint8_t m_history_data[PFS_COMMAND_HISTORY_BYTES];
+static pfs_cmd_history_t m_history_buff;
+static pfs_cmd_history_t *m_history = &m_history_buff;
+
+void setUp(void) {
+    pfs_cmd_history_init(m_history, m_history_data, sizeof(m_history_data),
+                         PFS_COMMAND_HISTORY_SIZE);
+}
+
+void tearDown(void) {}
+
+static void append(const char *line) {
+    pfs_input_buffer_t value = {0};
+    strcpy(value.buffer, line);
+    value.len = strlen(line);
+    value.cursor = value.len;
+    TEST_ASSERT_EQUAL_INT(0, pfs_cmd_history_append(m_history, &value));
+}
+
+static void assert_entry(size_t offset, const char *expected) {
+    pfs_input_buffer_t value;
+    memset(&value, 'x', sizeof(value));
+    TEST_ASSERT_EQUAL_INT(0, pfs_cmd_history_get(m_history, offset, &value));
+    TEST_ASSERT_EQUAL_STRING(expected, value.buffer);
+    TEST_ASSERT_EQUAL_INT(strlen(expected), value.len);
+}
+
+void GetEntries(void) {
+    pfs_input_buffer_t value;
+    TEST_ASSERT_NOT_EQUAL(0, pfs_cmd_history_get(m_history, 1, &value));
+
+    append("ls");
+    append("help");
+    assert_entry(1, "help");
+    assert_entry(2, "ls");
+    TEST_ASSERT_NOT_EQUAL(0, pfs_cmd_history_get(m_history, 3, &value));
+}
+
+void EvictOldestByCount(void) {
+    append("a");
+    append("b");
+    append("c");
+    append("d");
+    TEST_ASSERT_EQUAL_INT(3, m_history->occupancy);
+    assert_entry(1, "d");
+    assert_entry(3, "b");
+}
+
+void EvictOldestByBytesAndWrap(void) {
+    append("12345");
+    append("67890");
+    // does not fit in the remaining 2 bytes, "12345" is evicted and the entry
+    // wraps around the end of the arena
+    append("abcdef");
+    TEST_ASSERT_EQUAL_INT(2, m_history->occupancy);
+    TEST_ASSERT_EQUAL_INT(15, m_history->used);
+    assert_entry(1, "abcdef");
+    assert_entry(2, "67890");
+
+    append("xyz");
+    TEST_ASSERT_EQUAL_INT(2, m_history->occupancy);
+    assert_entry(1, "xyz");
+    assert_entry(2, "abcdef");
+}
+
+void RejectTooLongEntry(void) {
+    pfs_input_buffer_t value = {0};
+    memset(value.buffer, 'a', 16);
+    value.len = 16;
+    TEST_ASSERT_NOT_EQUAL(0, pfs_cmd_history_append(m_history, &value));
+    TEST_ASSERT_EQUAL_INT(0, m_history->occupancy);
+}
+
+void KeepNewest(void) {
+    append("ls");
+
+    pfs_input_buffer_t value = {0};
+    strcpy(value.buffer, "hel");
+    value.len = 3;
+    value.cursor = 1;
+    TEST_ASSERT_EQUAL_INT(0, pfs_cmd_history_update_newest(m_history, &value));
+
+    memset(&value, 'x', sizeof(value));
+    TEST_ASSERT_EQUAL_INT(0, pfs_cmd_history_get(m_history, 0, &value));
+    TEST_ASSERT_EQUAL_STRING("hel", value.buffer);
+    TEST_ASSERT_EQUAL_INT(1, value.cursor);
+}
+
+void FindEntries(void) {
+    append("sr");
+    append("ls");
+    append("sw");
+    size_t found;
+
+    // prefix, from the newest to the oldest
+    TEST_ASSERT_EQUAL_INT(
+            0, pfs_cmd_history_find(m_history, 0, true, "s", 1, true, &found));
+    TEST_ASSERT_EQUAL_INT(1, found);
+    TEST_ASSERT_EQUAL_INT(
+            0, pfs_cmd_history_find(m_history, 1, true, "s", 1, true, &found));
+    TEST_ASSERT_EQUAL_INT(3, found);
+    TEST_ASSERT_NOT_EQUAL(
+            0, pfs_cmd_history_find(m_history, 3, true, "s", 1, true, &found));
+
+    // and back
+    TEST_ASSERT_EQUAL_INT(
+            0, pfs_cmd_history_find(m_history, 3, false, "s", 1, true, &found));
+    TEST_ASSERT_EQUAL_INT(1, found);
+    TEST_ASSERT_NOT_EQUAL(
+            0, pfs_cmd_history_find(m_history, 1, false, "s", 1, true, &found));
+
+    // substring
+    TEST_ASSERT_NOT_EQUAL(
+            0, pfs_cmd_history_find(m_history, 0, true, "r", 1, true, &found));
+    TEST_ASSERT_EQUAL_INT(
+            0, pfs_cmd_history_find(m_history, 0, true, "r", 1, false, &found));
+    TEST_ASSERT_EQUAL_INT(3, found);
+}
+
+void FindWrappedEntry(void) {
+    append("12345");
+    append("67890");
+    append("abcdef");
+    size_t found;
+
+    TEST_ASSERT_EQUAL_INT(0, pfs_cmd_history_find(m_history, 0, true, "cde", 3,
+                                                  false, &found));
+    TEST_ASSERT_EQUAL_INT(1, found);
+}
+
+void FindOlderFromEntry(void) {
+    append("sr");
+    append("ls");
+    append("sw");
+    pfs_cmd_history_entry_t entry = {0};
+    pfs_input_buffer_t value;
+
+    TEST_ASSERT_EQUAL_INT(0, pfs_cmd_history_find_older(m_history, &entry, "s",
+                                                        1, false, &entry));
+    TEST_ASSERT_EQUAL_INT(1, entry.offset);
+    TEST_ASSERT_EQUAL_INT(0, pfs_cmd_history_read(m_history, &entry, &value));
+    TEST_ASSERT_EQUAL_STRING("sw", value.buffer);
+
+    // resumed from the previous match
+    TEST_ASSERT_EQUAL_INT(0, pfs_cmd_history_find_older(m_history, &entry, "s",
+                                                        1, false, &entry));
+    TEST_ASSERT_EQUAL_INT(2, entry.offset);
+    TEST_ASSERT_EQUAL_INT(0, pfs_cmd_history_read(m_history, &entry, &value));
+    TEST_ASSERT_EQUAL_STRING("ls", value.buffer);
+
+    TEST_ASSERT_EQUAL_INT(0, pfs_cmd_history_find_older(m_history, &entry, "s",
+                                                        1, true, &entry));
+    TEST_ASSERT_EQUAL_INT(3, entry.offset);
+    TEST_ASSERT_EQUAL_INT(0, pfs_cmd_history_read(m_history, &entry, &value));
+    TEST_ASSERT_EQUAL_STRING("sr", value.buffer);
+    TEST_ASSERT_NOT_EQUAL(0, pfs_cmd_history_find_older(m_history, &entry, "s",
+                                                        1, false, &entry));
+}
+
+void FindOlderAcrossWrap(void) {
+    append("12345");
+    append("67890");
+    append("abcdef");
+    append("xyz");
+    pfs_cmd_history_entry_t entry = {0};
+    pfs_input_buffer_t value;
+
+    // "abcdef" wraps around the end of the arena, its length too
+    TEST_ASSERT_EQUAL_INT(0, pfs_cmd_history_find_older(m_history, &entry, "f",
+                                                        1, false, &entry));
+    TEST_ASSERT_EQUAL_INT(2, entry.offset);
+    TEST_ASSERT_EQUAL_INT(0, pfs_cmd_history_read(m_history, &entry, &value));
+    TEST_ASSERT_EQUAL_STRING("abcdef", value.buffer);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(GetEntries);
+    RUN_TEST(EvictOldestByCount);
+    RUN_TEST(EvictOldestByBytesAndWrap);
+    RUN_TEST(RejectTooLongEntry);
+    RUN_TEST(KeepNewest);
+    RUN_TEST(FindEntries);
+    RUN_TEST(FindWrappedEntry);
+    RUN_TEST(FindOlderFromEntry);
+    RUN_TEST(FindOlderAcrossWrap);
+
+    return UNITY_END();
+}
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+
+#include <unity.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <test_utils.h>
+
+#include <pico_freertos_shell/commands.h>
+
+#include <pfs_cmd_stats.h>
+#include <pfs_command_index.h>
+#include <pfs_handle_shell_input.h>
+#include <pfs_stats.h>
+#include <pfs_utils.h>
+
+// pfs_stats.c is built against the FreeRTOS stand-in headers, no tasks are
+// registered in this suite, so the stack usage is never asked for
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    (void) task;
+    return 0;
+}
+
+static void Handler(int argc, char **argv) {
+    (void) argc;
+    (void) argv;
+}
+
+static const pfs_command_t sensor_subcommands[] = {
+        PFS_COMMAND_INITIALIZER(read, "read help",
+                                PFS_COMMAND_HANDLER(Handler)),
+        PFS_COMMAND_INITIALIZER(reset, "reset help",
+                                PFS_COMMAND_HANDLER(Handler)),
+};
+
+static const pfs_command_t commands[] = {
+        PFS_COMMAND_INITIALIZER(echo, "echo help",
+                                PFS_COMMAND_HANDLER(Handler)),
+        PFS_COMMAND_INITIALIZER(sensor, "sensor help",
+                                PFS_SUBCOMMANDS(sensor_subcommands,
+                                                PFS_ARRAY_SIZE(
+                                                        sensor_subcommands))),
+        PFS_COMMAND_INITIALIZER(reboot, "reboot help",
+                                PFS_COMMAND_HANDLER(Handler)),
+};
+
+#define ECHO (&commands[0])
+#define SENSOR_READ (&sensor_subcommands[0])
+#define SENSOR_RESET (&sensor_subcommands[1])
+#define REBOOT (&commands[2])
+
+void setUp(void) {
+    utils_reset_out_string_immediately_buffer();
+    pfs_reset_commands();
+    pfs_cmd_stats_reset();
+    memset(&pfs_stats, 0, sizeof(pfs_stats));
+    TEST_ASSERT_EQUAL_INT(
+            0, pfs_commands_register(commands, PFS_ARRAY_SIZE(commands)));
+}
+
+void tearDown(void) {}
+
+static int run(const char *line) {
+    char buffer[PFS_MAX_INPUT_SIZE];
+    char *argv[PFS_MAX_ARGC];
+    int argc = 0;
+    strcpy(buffer, line);
+    for (char *token = strtok(buffer, " "); token;
+         token = strtok(NULL, " ")) {
+        argv[argc++] = token;
+    }
+    utils_reset_out_string_immediately_buffer();
+    return pfs_cmd_stats_command(argc, argv);
+}
+
+void RecordAccumulates(void) {
+    TEST_ASSERT_NULL(pfs_cmd_stats_find(ECHO));
+
+    pfs_cmd_stats_record(ECHO, 10, 40);
+    pfs_cmd_stats_record(ECHO, 30, 20);
+    pfs_cmd_stats_record(ECHO, 20, 30);
+
+    const pfs_cmd_stats_entry_t *entry = pfs_cmd_stats_find(ECHO);
+    TEST_ASSERT_NOT_NULL(entry);
+    TEST_ASSERT_EQUAL_PTR(ECHO, entry->command);
+    TEST_ASSERT_EQUAL_UINT(3, entry->calls);
+    TEST_ASSERT_EQUAL_UINT(20, entry->last_us);
+    TEST_ASSERT_EQUAL_UINT(30, entry->max_us);
+    TEST_ASSERT_EQUAL_UINT(60, (unsigned) entry->total_us);
+    TEST_ASSERT_EQUAL_UINT(40, entry->max_stack_words);
+    TEST_ASSERT_NULL(pfs_cmd_stats_find(REBOOT));
+}
+
+void UntrackedCallsBeyondCapacity(void) {
+    pfs_cmd_stats_record(ECHO, 1, 0);
+    pfs_cmd_stats_record(SENSOR_READ, 1, 0);
+    pfs_cmd_stats_record(SENSOR_RESET, 1, 0);
+    pfs_cmd_stats_record(REBOOT, 1, 0);
+    pfs_cmd_stats_record(REBOOT, 1, 0);
+
+    TEST_ASSERT_NOT_NULL(pfs_cmd_stats_find(ECHO));
+    TEST_ASSERT_NOT_NULL(pfs_cmd_stats_find(SENSOR_READ));
+    TEST_ASSERT_NOT_NULL(pfs_cmd_stats_find(SENSOR_RESET));
+    TEST_ASSERT_NULL(pfs_cmd_stats_find(REBOOT));
+    TEST_ASSERT_EQUAL_UINT(2, pfs_cmd_stats_untracked_calls());
+
+    TEST_ASSERT_EQUAL_INT(0, run(""));
+    TEST_ASSERT_NOT_NULL(strstr(utils_get_out_string_immediately_buffer(),
+                                "2 calls not tracked"));
+}
+
+void PrintSortedByKey(void) {
+    pfs_cmd_stats_record(ECHO, 100, 0);
+    pfs_cmd_stats_record(SENSOR_READ, 10, 0);
+    pfs_cmd_stats_record(SENSOR_READ, 10, 0);
+    pfs_cmd_stats_record(SENSOR_READ, 10, 0);
+
+    // total: echo 100 > sensor read 30
+    TEST_ASSERT_EQUAL_INT(0, run(""));
+    const char *out = utils_get_out_string_immediately_buffer();
+    const char *echo = strstr(out, "echo ");
+    const char *sensor_read = strstr(out, "sensor read ");
+    TEST_ASSERT_NOT_NULL(echo);
+    TEST_ASSERT_NOT_NULL(sensor_read);
+    TEST_ASSERT_TRUE(echo < sensor_read);
+    // uncalled commands are not printed
+    TEST_ASSERT_NULL(strstr(out, "sensor reset"));
+    TEST_ASSERT_NULL(strstr(out, "reboot"));
+    TEST_ASSERT_NULL(strstr(out, "not tracked"));
+
+    TEST_ASSERT_EQUAL_INT(0, run("calls"));
+    out = utils_get_out_string_immediately_buffer();
+    TEST_ASSERT_TRUE(strstr(out, "sensor read ") < strstr(out, "echo "));
+}
+
+void InvalidArgumentsAndReset(void) {
+    pfs_cmd_stats_record(ECHO, 1, 0);
+
+    TEST_ASSERT_NOT_EQUAL(0, run("bogus"));
+    TEST_ASSERT_NOT_NULL(
+            strstr(utils_get_out_string_immediately_buffer(), "usage"));
+    TEST_ASSERT_NOT_EQUAL(0, run("calls max"));
+
+    TEST_ASSERT_EQUAL_INT(0, run("reset"));
+    TEST_ASSERT_NULL(pfs_cmd_stats_find(ECHO));
+    TEST_ASSERT_EQUAL_INT(0, run(""));
+    TEST_ASSERT_NULL(
+            strstr(utils_get_out_string_immediately_buffer(), "echo"));
+}
+
+void StackPeakSurvivesReset(void) {
+    pfs_cmd_stats_record(ECHO, 1, 5000);
+    pfs_cmd_stats_record(REBOOT, 1, 10);
+    TEST_ASSERT_EQUAL_UINT(5000, pfs_cmd_stats_max_stack_words());
+
+    TEST_ASSERT_EQUAL_INT(0, run("reset"));
+    pfs_cmd_stats_record(ECHO, 1, 20);
+    TEST_ASSERT_EQUAL_UINT(20, pfs_cmd_stats_find(ECHO)->max_stack_words);
+    TEST_ASSERT_EQUAL_UINT(5000, pfs_cmd_stats_max_stack_words());
+}
+
+static const pfs_command_t removable[] = {
+        PFS_COMMAND_INITIALIZER(plugin, "plugin help",
+                                PFS_COMMAND_HANDLER(Handler)),
+};
+
+void PurgeRemovedCommands(void) {
+    TEST_ASSERT_EQUAL_INT(0, pfs_commands_add(removable, 1));
+    pfs_cmd_stats_record(&removable[0], 5, 0);
+    pfs_cmd_stats_record(ECHO, 10, 0);
+    pfs_cmd_stats_record(SENSOR_READ, 20, 0);
+
+    TEST_ASSERT_EQUAL_INT(0, pfs_commands_remove(removable, 1));
+    pfs_cmd_stats_purge(pfs_command_index_get());
+
+    // the rest is still found, wherever it was probed to
+    TEST_ASSERT_NULL(pfs_cmd_stats_find(&removable[0]));
+    TEST_ASSERT_EQUAL_UINT(10, pfs_cmd_stats_find(ECHO)->total_us);
+    TEST_ASSERT_EQUAL_UINT(20, pfs_cmd_stats_find(SENSOR_READ)->total_us);
+    pfs_cmd_stats_record(REBOOT, 1, 0);
+    TEST_ASSERT_NOT_NULL(pfs_cmd_stats_find(REBOOT));
+    TEST_ASSERT_EQUAL_UINT(0, pfs_cmd_stats_untracked_calls());
+}
+
+void StatsResetZeroesCounters(void) {
+    memset(&pfs_stats, 0xff, sizeof(pfs_stats));
+
+    TEST_ASSERT_EQUAL_INT(0, pfs_handle_shell_input("stats reset"));
+    // the reset itself is counted once the built-in returns
+    TEST_ASSERT_EQUAL_UINT(1, pfs_stats.commands_builtin);
+    pfs_stats.commands_builtin = 0;
+    pfs_stats_t zero;
+    memset(&zero, 0, sizeof(zero));
+    TEST_ASSERT_EQUAL_MEMORY(&zero, &pfs_stats, sizeof(pfs_stats));
+}
+
+void StatsInvalidArguments(void) {
+    TEST_ASSERT_EQUAL_INT(1, pfs_handle_shell_input("stats foo"));
+    TEST_ASSERT_EQUAL_STRING(PFS_IO_SHELL_MESSAGE_WRN_BEGIN
+                             "usage: stats [reset]\n",
+                             utils_get_out_string_immediately_buffer());
+    TEST_ASSERT_EQUAL_INT(1, pfs_handle_shell_input("stats reset now"));
+}
+
+void StatsCountShellInput(void) {
+    TEST_ASSERT_EQUAL_INT(0, pfs_handle_shell_input("echo"));
+    TEST_ASSERT_EQUAL_INT(0, pfs_handle_shell_input("sensor read"));
+    TEST_ASSERT_EQUAL_UINT(2, pfs_stats.commands_dispatched);
+    TEST_ASSERT_EQUAL_UINT(0, pfs_stats.commands_not_found);
+    TEST_ASSERT_EQUAL_UINT(0, pfs_stats.commands_builtin);
+
+    TEST_ASSERT_EQUAL_INT(1, pfs_handle_shell_input("bogus"));
+    TEST_ASSERT_EQUAL_INT(1, pfs_handle_shell_input("sensor bogus"));
+    TEST_ASSERT_EQUAL_UINT(2, pfs_stats.commands_not_found);
+
+    TEST_ASSERT_EQUAL_INT(0, pfs_handle_shell_input("help"));
+    TEST_ASSERT_EQUAL_INT(0, pfs_handle_shell_input("stats"));
+    TEST_ASSERT_EQUAL_UINT(2, pfs_stats.commands_builtin);
+    TEST_ASSERT_NOT_NULL(strstr(utils_get_out_string_immediately_buffer(),
+                                "dispatched: 2, built-in: 1, not found: 2"));
+    TEST_ASSERT_EQUAL_UINT(2, pfs_stats.commands_dispatched);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(RecordAccumulates);
+    RUN_TEST(UntrackedCallsBeyondCapacity);
+    RUN_TEST(PrintSortedByKey);
+    RUN_TEST(InvalidArgumentsAndReset);
+    RUN_TEST(StackPeakSurvivesReset);
+    RUN_TEST(PurgeRemovedCommands);
+    RUN_TEST(StatsResetZeroesCounters);
+    RUN_TEST(StatsInvalidArguments);
+    RUN_TEST(StatsCountShellInput);
+
+    return UNITY_END();
+}
@@ -20,6 +20,8 @@
  * SOFTWARE.
  */
 
+#include <string.h>
+
 #include <unity.h>
 
 #include <test_utils.h>
@@ -27,6 +29,7 @@
 #include <pico_freertos_shell/commands.h>
 
 #include <pfs_handle_shell_input.h>
+#include <pfs_io.h>
 #include <pfs_utils.h>
 
 static void dummy_cmd_handler(int argc, char **argv) {
@@ -198,12 +201,82 @@ void AddFewCommands(void) {
     TEST_ASSERT_EQUAL_INT(0, pfs_commands_register(commands_1_OK, 3));
 }
 
+static size_t count_errors(const char *output) {
+    size_t errors = 0;
+    const char *error = output;
+    while ((error = strstr(error, PFS_IO_SHELL_MESSAGE_ERR_BEGIN)) != NULL) {
+        errors++;
+        error++;
+    }
+    return errors;
+}
+
+void ReportAllErrors(void) {
+    utils_reset_out_string_immediately_buffer();
+    TEST_ASSERT_EQUAL_INT(1, pfs_commands_register(commands_2_NOT_OK, 3));
+    TEST_ASSERT_EQUAL_INT(
+            2, count_errors(utils_get_out_string_immediately_buffer()));
+
+    utils_reset_out_string_immediately_buffer();
+    TEST_ASSERT_EQUAL_INT(1, pfs_commands_register(commands_3_NOT_OK, 2));
+    TEST_ASSERT_EQUAL_INT(
+            2, count_errors(utils_get_out_string_immediately_buffer()));
+}
+
+void ValidateWithoutRegistering(void) {
+    TEST_ASSERT_EQUAL_INT(1, pfs_commands_validate(NULL, 0));
+    TEST_ASSERT_EQUAL_INT(1, pfs_commands_validate(commands_2_NOT_OK, 3));
+    TEST_ASSERT_EQUAL_INT(0, pfs_commands_validate(commands_1_OK, 3));
+    TEST_ASSERT_EQUAL_INT(0, pfs_commands_register(commands_1_OK, 3));
+}
+
+static const pfs_command_t commands_6_NOT_OK[] = {
+        PFS_COMMAND_INITIALIZER(help,
+                                "help description",
+                                PFS_COMMAND_HANDLER(dummy_cmd_handler)),
+};
+
+void AddCommandsAtRuntime(void) {
+    TEST_ASSERT_EQUAL_INT(1, pfs_commands_add(NULL, 0));
+    TEST_ASSERT_EQUAL_INT(1, pfs_commands_add(commands_5_NOT_OK, 1));
+    TEST_ASSERT_EQUAL_INT(1, pfs_commands_add(commands_6_NOT_OK, 1));
+    TEST_ASSERT_EQUAL_INT(0, pfs_commands_register(commands_0_OK, 1));
+    TEST_ASSERT_EQUAL_INT(1, pfs_handle_shell_input("command40 subcommand001"));
+    TEST_ASSERT_EQUAL_INT(0, pfs_commands_add(commands_4_OK, 1));
+    TEST_ASSERT_EQUAL_INT(0, pfs_handle_shell_input("command40 subcommand001"));
+    TEST_ASSERT_EQUAL_INT(0, pfs_handle_shell_input("command00"));
+    TEST_ASSERT_EQUAL_INT(1, pfs_commands_add(commands_4_OK, 1));
+    TEST_ASSERT_EQUAL_INT(1, pfs_commands_add(commands_2_NOT_OK, 3));
+    TEST_ASSERT_EQUAL_INT(0, pfs_commands_add(commands_1_OK, 3));
+    TEST_ASSERT_EQUAL_INT(0, pfs_handle_shell_input("command12 subcommand001"));
+}
+
+void RemoveCommands(void) {
+    TEST_ASSERT_EQUAL_INT(1, pfs_commands_remove(commands_0_OK, 1));
+    TEST_ASSERT_EQUAL_INT(0, pfs_commands_add(commands_0_OK, 1));
+    TEST_ASSERT_EQUAL_INT(0, pfs_commands_add(commands_1_OK, 3));
+    TEST_ASSERT_EQUAL_INT(1, pfs_commands_remove(commands_4_OK, 1));
+    TEST_ASSERT_EQUAL_INT(1, pfs_commands_remove(NULL, 1));
+    TEST_ASSERT_EQUAL_INT(0, pfs_commands_remove(commands_1_OK, 3));
+    TEST_ASSERT_EQUAL_INT(1, pfs_commands_remove(commands_1_OK, 3));
+    TEST_ASSERT_EQUAL_INT(1, pfs_handle_shell_input("command10"));
+    TEST_ASSERT_EQUAL_INT(0, pfs_handle_shell_input("command00"));
+    TEST_ASSERT_EQUAL_INT(0, pfs_handle_shell_input("help"));
+    TEST_ASSERT_EQUAL_INT(0, pfs_commands_remove(commands_0_OK, 1));
+    TEST_ASSERT_EQUAL_INT(1, pfs_handle_shell_input("command00"));
+    TEST_ASSERT_EQUAL_INT(0, pfs_commands_register(commands_1_OK, 3));
+}
+
 int main(void) {
     UNITY_BEGIN();
 
     RUN_TEST(AddZeroCommands);
     RUN_TEST(AddOneCommand);
     RUN_TEST(AddFewCommands);
+    RUN_TEST(ReportAllErrors);
+    RUN_TEST(ValidateWithoutRegistering);
+    RUN_TEST(AddCommandsAtRuntime);
+    RUN_TEST(RemoveCommands);
 
     return UNITY_END();
 }
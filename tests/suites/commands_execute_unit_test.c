@@ -20,6 +20,8 @@
  * SOFTWARE.
  */
 
+#include <string.h>
+
 #include <unity.h>
 
 #include <test_utils.h>
@@ -353,7 +355,9 @@ void HandleHelpCommand(void) {
             PFS_IO_SHELL_MESSAGE_INF_BEGIN PFS_IO_TAB PFS_IO_BOLD_ON "command0" PFS_IO_BOLD_OFF " - command0 description\n"
             PFS_IO_SHELL_MESSAGE_INF_BEGIN PFS_IO_TAB PFS_IO_BOLD_ON "command1" PFS_IO_BOLD_OFF " - command1 description\n"
             PFS_IO_SHELL_MESSAGE_INF_BEGIN PFS_IO_TAB PFS_IO_BOLD_ON "help" PFS_IO_BOLD_OFF " - display help message for a specified command\n"
-            PFS_IO_SHELL_MESSAGE_INF_BEGIN PFS_IO_TAB PFS_IO_BOLD_ON "helptree" PFS_IO_BOLD_OFF " - display help message tree for a specified command\n",
+            PFS_IO_SHELL_MESSAGE_INF_BEGIN PFS_IO_TAB PFS_IO_BOLD_ON "helptree" PFS_IO_BOLD_OFF " - display help message tree for a specified command\n"
+            PFS_IO_SHELL_MESSAGE_INF_BEGIN PFS_IO_TAB PFS_IO_BOLD_ON "loglevel" PFS_IO_BOLD_OFF " - display or set log levels, e.g. 'loglevel sensor dbg' or 'loglevel all off'\n"
+            PFS_IO_SHELL_MESSAGE_INF_BEGIN PFS_IO_TAB PFS_IO_BOLD_ON "time" PFS_IO_BOLD_OFF " - run a command and display its lookup, queue and run times and output size\n",
             utils_get_out_string_immediately_buffer());
 
     utils_reset_out_string_immediately_buffer();
@@ -419,7 +423,9 @@ void HandleHeltreepCommand(void) {
             PFS_IO_SHELL_MESSAGE_INF_BEGIN PFS_IO_TAB PFS_IO_TAB PFS_IO_TAB PFS_IO_BOLD_ON "subcommand01" PFS_IO_BOLD_OFF " - subcommand01 description\n"
             PFS_IO_SHELL_MESSAGE_INF_BEGIN PFS_IO_TAB PFS_IO_TAB PFS_IO_TAB PFS_IO_TAB PFS_IO_BOLD_ON "subcommand" PFS_IO_BOLD_OFF " - subcommand description\n"
             PFS_IO_SHELL_MESSAGE_INF_BEGIN PFS_IO_TAB PFS_IO_BOLD_ON "help" PFS_IO_BOLD_OFF " - display help message for a specified command\n"
-            PFS_IO_SHELL_MESSAGE_INF_BEGIN PFS_IO_TAB PFS_IO_BOLD_ON "helptree" PFS_IO_BOLD_OFF " - display help message tree for a specified command\n",
+            PFS_IO_SHELL_MESSAGE_INF_BEGIN PFS_IO_TAB PFS_IO_BOLD_ON "helptree" PFS_IO_BOLD_OFF " - display help message tree for a specified command\n"
+            PFS_IO_SHELL_MESSAGE_INF_BEGIN PFS_IO_TAB PFS_IO_BOLD_ON "loglevel" PFS_IO_BOLD_OFF " - display or set log levels, e.g. 'loglevel sensor dbg' or 'loglevel all off'\n"
+            PFS_IO_SHELL_MESSAGE_INF_BEGIN PFS_IO_TAB PFS_IO_BOLD_ON "time" PFS_IO_BOLD_OFF " - run a command and display its lookup, queue and run times and output size\n",
             utils_get_out_string_immediately_buffer());
 
     utils_reset_out_string_immediately_buffer();
@@ -468,6 +474,62 @@ void HandleHeltreepCommand(void) {
 }
 // clang-format on
 
+static int time_prefix_calls = 0;
+static void HandleTimePrefixCmdHandler(int argc, char **argv) {
+    time_prefix_calls++;
+    TEST_ASSERT_EQUAL_INT(1, argc);
+    TEST_ASSERT_EQUAL_STRING("arg1", argv[0]);
+}
+
+static const pfs_command_t timedcommand[] = {
+        PFS_COMMAND_INITIALIZER(timedcommand,
+                                "timedcommand description",
+                                PFS_COMMAND_HANDLER(
+                                        HandleTimePrefixCmdHandler)),
+};
+
+void HandleTimePrefix(void) {
+    TEST_ASSERT_EQUAL_INT(0, pfs_commands_register(timedcommand, 1));
+
+    time_prefix_calls = 0;
+    TEST_ASSERT_EQUAL_INT(0, pfs_handle_shell_input("time timedcommand arg1"));
+    TEST_ASSERT_EQUAL_INT(0,
+                          pfs_handle_shell_input(" time  timedcommand arg1"));
+    TEST_ASSERT_EQUAL_INT(2, time_prefix_calls);
+
+    utils_reset_out_string_immediately_buffer();
+    TEST_ASSERT_EQUAL_INT(1, pfs_handle_shell_input("time"));
+    TEST_ASSERT_EQUAL_STRING(PFS_IO_SHELL_MESSAGE_WRN_BEGIN
+                             "usage: time <command...>\n",
+                             utils_get_out_string_immediately_buffer());
+
+    utils_reset_out_string_immediately_buffer();
+    TEST_ASSERT_EQUAL_INT(1, pfs_handle_shell_input("time time timedcommand"));
+    TEST_ASSERT_EQUAL_STRING(PFS_IO_SHELL_MESSAGE_WRN_BEGIN
+                             "usage: time <command...>\n",
+                             utils_get_out_string_immediately_buffer());
+
+    // built-ins are timed in the shell task
+    utils_set_time_us(1000);
+    utils_reset_out_string_immediately_buffer();
+    TEST_ASSERT_EQUAL_INT(0, pfs_handle_shell_input("time loglevel"));
+    const char *output = utils_get_out_string_immediately_buffer();
+    const char *timing = PFS_IO_SHELL_MESSAGE_INF_BEGIN
+            "time: lookup 0 us, run 0 us (built-in)\n";
+    TEST_ASSERT_TRUE(strlen(output) > strlen(timing));
+    TEST_ASSERT_EQUAL_STRING(timing, output + strlen(output) - strlen(timing));
+    utils_set_time_us(0);
+
+    utils_reset_out_string_immediately_buffer();
+    TEST_ASSERT_EQUAL_INT(1, pfs_handle_shell_input("time command2"));
+    TEST_ASSERT_EQUAL_STRING(
+            PFS_IO_SHELL_MESSAGE_WRN_BEGIN
+            "command2: command not found\n" PFS_IO_SHELL_MESSAGE_WRN_BEGIN
+            "type 'help' for a list of available commands\n",
+            utils_get_out_string_immediately_buffer());
+    TEST_ASSERT_EQUAL_INT(2, time_prefix_calls);
+}
+
 int main(void) {
     UNITY_BEGIN();
 
@@ -475,6 +537,7 @@ int main(void) {
     RUN_TEST(HandleInputMultipleCommand);
     RUN_TEST(HandleHelpCommand);
     RUN_TEST(HandleHeltreepCommand);
+    RUN_TEST(HandleTimePrefix);
 
     return UNITY_END();
 }
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+
+#include <unity.h>
+
+#include <test_utils.h>
+
+#include <pico_freertos_shell/commands.h>
+
+#include <pfs_handle_shell_input.h>
+#include <pfs_utils.h>
+
+void _pfs_append_queue(const char *buffer, uint32_t buffer_size);
+
+static void print(const char *str) {
+    _pfs_append_queue(str, (uint32_t) strlen(str));
+}
+
+static void LinesHandler(int argc, char **argv) {
+    (void) argc;
+    (void) argv;
+    print("alpha 1\nbe");
+    print("ta 2\n");
+    print("alpha 3\ngamma 4\n");
+}
+
+static void LongLineHandler(int argc, char **argv) {
+    (void) argc;
+    (void) argv;
+    char line[PFS_PIPE_LINE_SIZE * 2];
+    memset(line, 'x', sizeof(line));
+    line[sizeof(line) - 1] = '\0';
+    print("match ");
+    print(line);
+    print("\n");
+    print(line);
+    print(" match\n");
+}
+
+static void UnterminatedHandler(int argc, char **argv) {
+    (void) argc;
+    (void) argv;
+    print("alpha\nbeta");
+}
+
+static int m_args_argc;
+static const char *m_args_argv0;
+
+static void ArgsHandler(int argc, char **argv) {
+    m_args_argc = argc;
+    m_args_argv0 = argc > 0 ? argv[0] : NULL;
+    print("args\n");
+}
+
+static const pfs_command_t commands[] = {
+        PFS_COMMAND_INITIALIZER(lines, "lines description",
+                                PFS_COMMAND_HANDLER(LinesHandler)),
+        PFS_COMMAND_INITIALIZER(longline, "longline description",
+                                PFS_COMMAND_HANDLER(LongLineHandler)),
+        PFS_COMMAND_INITIALIZER(unterminated, "unterminated description",
+                                PFS_COMMAND_HANDLER(UnterminatedHandler)),
+        PFS_COMMAND_INITIALIZER(args, "args description",
+                                PFS_COMMAND_HANDLER(ArgsHandler)),
+};
+
+void setUp(void) {
+    utils_reset_out_string_immediately_buffer();
+    pfs_reset_commands();
+    TEST_ASSERT_EQUAL_INT(0, pfs_commands_register(commands,
+                                                   PFS_ARRAY_SIZE(commands)));
+}
+
+void tearDown(void) {}
+
+static void assert_output(const char *input, const char *expected) {
+    utils_reset_out_string_immediately_buffer();
+    TEST_ASSERT_EQUAL_INT(0, pfs_handle_shell_input(input));
+    TEST_ASSERT_EQUAL_STRING(expected,
+                             utils_get_out_string_immediately_buffer());
+}
+
+static void assert_rejected(const char *input, const char *message) {
+    utils_reset_out_string_immediately_buffer();
+    TEST_ASSERT_NOT_EQUAL(0, pfs_handle_shell_input(input));
+    TEST_ASSERT_NOT_NULL(
+            strstr(utils_get_out_string_immediately_buffer(), message));
+}
+
+void NotPiped(void) {
+    assert_output("lines", "alpha 1\nbeta 2\nalpha 3\ngamma 4\n");
+}
+
+void Grep(void) {
+    assert_output("lines | grep alpha", "alpha 1\nalpha 3\n");
+    assert_output("lines | grep \"a 2\"", "beta 2\n");
+    assert_output("lines | grep delta", "");
+}
+
+void Head(void) {
+    assert_output("lines | head 2", "alpha 1\nbeta 2\n");
+    assert_output("lines | head 0", "");
+    assert_output("lines | head", "alpha 1\nbeta 2\nalpha 3\ngamma 4\n");
+}
+
+void Count(void) {
+    assert_output("lines | count", "4\n");
+    assert_output("lines | grep alpha | count", "2\n");
+    assert_output("lines | count | grep 4", "4\n");
+    assert_output("lines | count | count", "1\n");
+}
+
+void Chained(void) {
+    assert_output("lines | grep a | head 3 | grep 3", "alpha 3\n");
+}
+
+void NoSpacesAroundSeparator(void) {
+    assert_output("lines|grep gamma", "gamma 4\n");
+    assert_output("args \"a\"|head 1", "args\n");
+    TEST_ASSERT_EQUAL_INT(1, m_args_argc);
+    TEST_ASSERT_EQUAL_STRING("a", m_args_argv0);
+}
+
+void QuotedSeparatorIsArgument(void) {
+    assert_output("args \"|\"", "args\n");
+    TEST_ASSERT_EQUAL_INT(1, m_args_argc);
+    TEST_ASSERT_EQUAL_STRING("|", m_args_argv0);
+}
+
+void LongLineJudgedByBeginning(void) {
+    utils_reset_out_string_immediately_buffer();
+    TEST_ASSERT_EQUAL_INT(0, pfs_handle_shell_input("longline | grep match"));
+    const char *out = utils_get_out_string_immediately_buffer();
+    TEST_ASSERT_EQUAL_INT(0, strncmp(out, "match x", 7));
+    TEST_ASSERT_EQUAL_INT(strlen("match ") + PFS_PIPE_LINE_SIZE * 2,
+                          strlen(out));
+    // the second line matches past the buffer only
+    TEST_ASSERT_EQUAL_PTR(&out[strlen(out) - 1], strchr(out, '\n'));
+}
+
+void UnterminatedLastLine(void) {
+    assert_output("unterminated | grep beta", "beta");
+}
+
+void InvalidPipelines(void) {
+    assert_rejected("lines |", "missing filter");
+    assert_rejected("lines | | count", "missing filter");
+    assert_rejected("| grep a", "missing command");
+    assert_rejected("lines | sort", "filter not found");
+    assert_rejected("lines | grep", "usage: grep");
+    assert_rejected("lines | grep a b", "usage: grep");
+    assert_rejected("lines | head x", "usage: head");
+    assert_rejected("lines | head -1", "usage: head");
+    assert_rejected("lines | count 1", "usage: count");
+    assert_rejected("lines | count | count | count | count | count",
+                    "too many filters");
+    assert_rejected("help | grep lines", "can't be piped");
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(NotPiped);
+    RUN_TEST(Grep);
+    RUN_TEST(Head);
+    RUN_TEST(Count);
+    RUN_TEST(Chained);
+    RUN_TEST(NoSpacesAroundSeparator);
+    RUN_TEST(QuotedSeparatorIsArgument);
+    RUN_TEST(LongLineJudgedByBeginning);
+    RUN_TEST(UnterminatedLastLine);
+    RUN_TEST(InvalidPipelines);
+
+    return UNITY_END();
+}
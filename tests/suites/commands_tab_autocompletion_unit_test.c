@@ -35,6 +35,7 @@
 void setUp(void) {
     utils_reset_out_string_immediately_buffer();
     pfs_reset_commands();
+    pfs_completion_invalidate();
 }
 
 void tearDown(void) {}
@@ -80,6 +81,39 @@ static const pfs_command_t multiplecommands[] = {
                                                 PFS_ARRAY_SIZE(subcommands1))),
 };
 
+static int m_completion_calls;
+
+static void device_completion(int argc,
+                              char **argv,
+                              pfs_completion_candidates_t *candidates) {
+    m_completion_calls++;
+    if (argc == 0) {
+        pfs_completion_add_candidate(candidates, "eeprom0");
+        pfs_completion_add_candidate(candidates, "eeprom1");
+        pfs_completion_add_candidate(candidates, "flash");
+    } else if (argc == 1 && strcmp(argv[0], "flash") == 0) {
+        pfs_completion_add_candidate(candidates, "sector");
+    } else if (argc == 1 && strcmp(argv[0], "liquid") == 0) {
+        pfs_completion_add_candidate(candidates, "level");
+    }
+}
+
+static const pfs_command_t device_subcommands[] = {
+        PFS_COMMAND_INITIALIZER(
+                read,
+                "read description",
+                PFS_COMMAND_HANDLER_WITH_COMPLETION(dummy_cmd_handler,
+                                                    device_completion)),
+};
+
+static const pfs_command_t completioncommands[] = {
+        PFS_COMMAND_INITIALIZER(device,
+                                "device description",
+                                PFS_SUBCOMMANDS(device_subcommands,
+                                                PFS_ARRAY_SIZE(
+                                                        device_subcommands))),
+};
+
 #define TEST_PREPARE(BeginningString)                       \
     pfs_io_handle_input_char(PFS_IO_CHAR_CTRL_C);           \
     pfs_io_handle_input_char(PFS_IO_CHAR_ENTER);            \
@@ -112,7 +146,7 @@ void HandleTabInputCharacter(void) {
     TEST_PREPARE("");
     TEST_ASSERT_OUTPUT_EQUAL(
         "\n"
-        PFS_IO_SHELL_MESSAGE_INF_BEGIN PFS_IO_BOLD_ON "command" PFS_IO_TAB "command1" PFS_IO_TAB "help" PFS_IO_TAB "helptree" PFS_IO_TAB PFS_IO_BOLD_OFF "\n"
+        PFS_IO_SHELL_MESSAGE_INF_BEGIN PFS_IO_BOLD_ON "command" PFS_IO_TAB "command1" PFS_IO_TAB "help" PFS_IO_TAB "helptree" PFS_IO_TAB "loglevel" PFS_IO_TAB "time" PFS_IO_TAB PFS_IO_BOLD_OFF "\n"
         PFS_IO_SHELL_PROMPT "%s", beginning);
 
     TEST_PREPARE("helpt");
@@ -171,10 +205,88 @@ void HandleTabInputCharacter(void) {
     // clang-format on
 }
 
+void HandleTabArgumentCompletion(void) {
+    TEST_ASSERT_EQUAL_INT(0, pfs_commands_register(completioncommands, 1));
+
+    char beginning[PFS_MAX_INPUT_SIZE];
+    memset(beginning, 0, sizeof(beginning));
+    char output[1024];
+    memset(output, 0, sizeof(output));
+    m_completion_calls = 0;
+
+    // clang-format off
+    TEST_PREPARE("device read ");
+    TEST_ASSERT_OUTPUT_EQUAL(
+        "\n"
+        PFS_IO_SHELL_MESSAGE_INF_BEGIN PFS_IO_BOLD_ON "eeprom0" PFS_IO_TAB "eeprom1" PFS_IO_TAB "flash" PFS_IO_TAB PFS_IO_BOLD_OFF "\n"
+        PFS_IO_SHELL_PROMPT "%s", beginning);
+
+    TEST_PREPARE("device read e");
+    TEST_ASSERT_OUTPUT_EQUAL("eprom");
+
+    TEST_PREPARE("device read eeprom");
+    TEST_ASSERT_OUTPUT_EQUAL(
+        "\n"
+        PFS_IO_SHELL_MESSAGE_INF_BEGIN PFS_IO_BOLD_ON "eeprom0" PFS_IO_TAB "eeprom1" PFS_IO_TAB PFS_IO_BOLD_OFF "\n"
+        PFS_IO_SHELL_PROMPT "%s", beginning);
+
+    TEST_PREPARE("device read f");
+    TEST_ASSERT_OUTPUT_EQUAL("lash ");
+
+    TEST_PREPARE("device read x");
+    TEST_ASSERT_OUTPUT_EMPTY();
+
+    // the candidates are enumerated once for the same preceding arguments
+    TEST_ASSERT_EQUAL_INT(1, m_completion_calls);
+
+    TEST_PREPARE("device read flash ");
+    TEST_ASSERT_OUTPUT_EQUAL("sector ");
+
+    TEST_PREPARE("device read eeprom0 ");
+    TEST_ASSERT_OUTPUT_EMPTY();
+    TEST_ASSERT_EQUAL_INT(3, m_completion_calls);
+
+    TEST_PREPARE("device read eeprom0 ");
+    TEST_ASSERT_EQUAL_INT(3, m_completion_calls);
+
+    pfs_completion_invalidate();
+    TEST_PREPARE("device read eeprom0 ");
+    TEST_ASSERT_EQUAL_INT(4, m_completion_calls);
+
+    TEST_PREPARE("device read \"unterminated ");
+    TEST_ASSERT_OUTPUT_EMPTY();
+    TEST_ASSERT_EQUAL_INT(4, m_completion_calls);
+
+    // "costarring " and "liquid " have the same FNV-1a hash
+    TEST_PREPARE("device read costarring ");
+    TEST_ASSERT_OUTPUT_EMPTY();
+    TEST_PREPARE("device read liquid ");
+    TEST_ASSERT_OUTPUT_EQUAL("level ");
+    TEST_ASSERT_EQUAL_INT(6, m_completion_calls);
+    // clang-format on
+}
+
+void AddCandidatesToFullBuffer(void) {
+    char buffer[8];
+    pfs_completion_candidates_t candidates = {
+            .buffer = buffer,
+            .size = sizeof(buffer),
+            .len = 0,
+    };
+
+    TEST_ASSERT_EQUAL_INT(0, pfs_completion_add_candidate(&candidates, "abc"));
+    TEST_ASSERT_EQUAL_INT(0, pfs_completion_add_candidate(&candidates, "def"));
+    TEST_ASSERT_NOT_EQUAL(0, pfs_completion_add_candidate(&candidates, "g"));
+    TEST_ASSERT_EQUAL_INT(8, candidates.len);
+    TEST_ASSERT_EQUAL_MEMORY("abc\0def", buffer, 8);
+}
+
 int main(void) {
     UNITY_BEGIN();
 
     RUN_TEST(HandleTabInputCharacter);
+    RUN_TEST(HandleTabArgumentCompletion);
+    RUN_TEST(AddCandidatesToFullBuffer);
 
     return UNITY_END();
 }
@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unity.h>
+
+#include <test_utils.h>
+
+#include <pico_freertos_shell/commands.h>
+
+#include <pfs_command_index.h>
+#include <pfs_io.h>
+#include <pfs_utils.h>
+
+// the suite is linked with --wrap for the allocation functions
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t number, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+static bool m_count_allocations;
+static size_t m_allocations;
+
+void *__wrap_malloc(size_t size) {
+    m_allocations += m_count_allocations;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t number, size_t size) {
+    m_allocations += m_count_allocations;
+    return __real_calloc(number, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    m_allocations += m_count_allocations;
+    return __real_realloc(ptr, size);
+}
+
+void setUp(void) {
+    utils_reset_out_string_immediately_buffer();
+    pfs_reset_commands();
+    pfs_completion_invalidate();
+    m_count_allocations = false;
+    m_allocations = 0;
+}
+
+void tearDown(void) {
+    m_count_allocations = false;
+}
+
+static void dummy_cmd_handler(int argc, char **argv) {
+    (void) argc;
+    (void) argv;
+}
+
+static void value_completion(int argc,
+                             char **argv,
+                             pfs_completion_candidates_t *candidates) {
+    (void) argc;
+    (void) argv;
+    pfs_completion_add_candidate(candidates, "alpha");
+    pfs_completion_add_candidate(candidates, "alps");
+    pfs_completion_add_candidate(candidates, "beta");
+}
+
+static const pfs_command_t leaf[] = {
+        PFS_COMMAND_INITIALIZER(longestsubcommand,
+                                "longestsubcommand description",
+                                PFS_COMMAND_HANDLER_WITH_COMPLETION(
+                                        dummy_cmd_handler, value_completion)),
+};
+
+static const pfs_command_t subcommands0[] = {
+        PFS_COMMAND_INITIALIZER(subcommand01,
+                                "subcommand01 description",
+                                PFS_SUBCOMMANDS(leaf, PFS_ARRAY_SIZE(leaf))),
+        PFS_COMMAND_INITIALIZER(subcommand00,
+                                "subcommand00 description",
+                                PFS_COMMAND_HANDLER(dummy_cmd_handler)),
+};
+
+static const pfs_command_t subcommands1[] = {
+        PFS_COMMAND_INITIALIZER(subcommand11,
+                                "subcommand11 description",
+                                PFS_SUBCOMMANDS(subcommands0,
+                                                PFS_ARRAY_SIZE(subcommands0))),
+        PFS_COMMAND_INITIALIZER(subcommand10,
+                                "subcommand10 description",
+                                PFS_COMMAND_HANDLER(dummy_cmd_handler)),
+        PFS_COMMAND_INITIALIZER(other,
+                                "other description",
+                                PFS_COMMAND_HANDLER(dummy_cmd_handler)),
+};
+
+static const pfs_command_t commands[] = {
+        PFS_COMMAND_INITIALIZER(command1,
+                                "command1 description",
+                                PFS_SUBCOMMANDS(subcommands1,
+                                                PFS_ARRAY_SIZE(subcommands1))),
+        PFS_COMMAND_INITIALIZER(command,
+                                "command description",
+                                PFS_COMMAND_HANDLER(dummy_cmd_handler)),
+        PFS_COMMAND_INITIALIZER(zeta,
+                                "zeta description",
+                                PFS_COMMAND_HANDLER(dummy_cmd_handler)),
+};
+
+// returns the names of the matching nodes separated with spaces
+static const char *find_prefix(const pfs_command_index_node_t *nodes,
+                               size_t len,
+                               const char *prefix) {
+    static char names[256];
+    const pfs_command_index_node_t *first;
+    size_t count = pfs_command_index_find_prefix(nodes, len, prefix,
+                                                 strlen(prefix), &first);
+    names[0] = '\0';
+    if (count == 0) {
+        TEST_ASSERT_NULL(first);
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) {
+            strcat(names, " ");
+        }
+        strcat(names, first[i].command->description.name);
+    }
+    return names;
+}
+
+static const pfs_command_index_node_t *
+child(const pfs_command_index_node_t *nodes, size_t len, const char *name) {
+    const pfs_command_index_node_t *node =
+            pfs_command_index_find(nodes, len, name, strlen(name));
+    TEST_ASSERT_NOT_NULL(node);
+    return node;
+}
+
+void PrefixRangeTopLevel(void) {
+    TEST_ASSERT_EQUAL_INT(0, pfs_commands_register(commands, 3));
+    const pfs_command_index_t *index = pfs_command_index_get();
+    size_t len;
+    const pfs_command_index_node_t *nodes =
+            pfs_command_index_children(index, NULL, &len);
+
+    TEST_ASSERT_EQUAL_STRING("command command1 help helptree loglevel time "
+                             "zeta",
+                             find_prefix(nodes, len, ""));
+    TEST_ASSERT_EQUAL_STRING("command command1",
+                             find_prefix(nodes, len, "c"));
+    TEST_ASSERT_EQUAL_STRING("command command1",
+                             find_prefix(nodes, len, "command"));
+    TEST_ASSERT_EQUAL_STRING("command1", find_prefix(nodes, len, "command1"));
+    TEST_ASSERT_EQUAL_STRING("", find_prefix(nodes, len, "command10"));
+    TEST_ASSERT_EQUAL_STRING("help helptree", find_prefix(nodes, len, "he"));
+    TEST_ASSERT_EQUAL_STRING("helptree", find_prefix(nodes, len, "helpt"));
+    // before the first and after the last name
+    TEST_ASSERT_EQUAL_STRING("", find_prefix(nodes, len, "a"));
+    TEST_ASSERT_EQUAL_STRING("zeta", find_prefix(nodes, len, "z"));
+    TEST_ASSERT_EQUAL_STRING("", find_prefix(nodes, len, "zz"));
+    TEST_ASSERT_EQUAL_STRING("", find_prefix(NULL, 0, "c"));
+}
+
+void PrefixRangeNested(void) {
+    TEST_ASSERT_EQUAL_INT(0, pfs_commands_register(commands, 3));
+    const pfs_command_index_t *index = pfs_command_index_get();
+    size_t len;
+    const pfs_command_index_node_t *nodes =
+            pfs_command_index_children(index, NULL, &len);
+
+    // depth 1
+    nodes = pfs_command_index_children(index, child(nodes, len, "command1"),
+                                       &len);
+    TEST_ASSERT_EQUAL_INT(3, len);
+    TEST_ASSERT_EQUAL_STRING("other subcommand10 subcommand11",
+                             find_prefix(nodes, len, ""));
+    TEST_ASSERT_EQUAL_STRING("subcommand10 subcommand11",
+                             find_prefix(nodes, len, "subcommand1"));
+    TEST_ASSERT_EQUAL_STRING("subcommand11",
+                             find_prefix(nodes, len, "subcommand11"));
+    TEST_ASSERT_EQUAL_STRING("other", find_prefix(nodes, len, "o"));
+    TEST_ASSERT_EQUAL_STRING("", find_prefix(nodes, len, "subcommand2"));
+
+    // depth 2
+    nodes = pfs_command_index_children(
+            index, child(nodes, len, "subcommand11"), &len);
+    TEST_ASSERT_EQUAL_INT(2, len);
+    TEST_ASSERT_EQUAL_STRING("subcommand00 subcommand01",
+                             find_prefix(nodes, len, "subcommand0"));
+    TEST_ASSERT_EQUAL_STRING("subcommand01",
+                             find_prefix(nodes, len, "subcommand01"));
+    TEST_ASSERT_EQUAL_STRING("", find_prefix(nodes, len, "subcommand1"));
+
+    // depth 3
+    nodes = pfs_command_index_children(
+            index, child(nodes, len, "subcommand01"), &len);
+    TEST_ASSERT_EQUAL_INT(1, len);
+    TEST_ASSERT_EQUAL_STRING("longestsubcommand",
+                             find_prefix(nodes, len, "l"));
+    TEST_ASSERT_EQUAL_STRING("", find_prefix(nodes, len, "m"));
+}
+
+static void press_tab(const char *line) {
+    pfs_io_handle_input_char(PFS_IO_CHAR_CTRL_C);
+    pfs_io_handle_input_char(PFS_IO_CHAR_ENTER);
+    for (const char *c = line; *c != '\0'; c++) {
+        pfs_io_handle_input_char(*c);
+    }
+    pfs_io_handle_input_char(PFS_IO_CHAR_TAB);
+}
+
+void CompletionDoesNotAllocate(void) {
+    TEST_ASSERT_EQUAL_INT(0, pfs_commands_register(commands, 3));
+    const char *lines[] = {
+            "",
+            "c",
+            "command",
+            "he",
+            "command1 ",
+            "command1 sub",
+            "command1 subcommand11 subcommand0",
+            "command1 subcommand11 subcommand01 ",
+            "command1 subcommand11 subcommand01 l",
+            "command1 subcommand11 subcommand01 longestsubcommand ",
+            "command1 subcommand11 subcommand01 longestsubcommand al",
+            "command1 subcommand11 subcommand01 longestsubcommand b",
+            "unknown ",
+    };
+
+    m_count_allocations = true;
+    // every line twice, the second time argument candidates come from cache
+    for (size_t pass = 0; pass < 2; pass++) {
+        for (size_t i = 0; i < PFS_ARRAY_SIZE(lines); i++) {
+            press_tab(lines[i]);
+            TEST_ASSERT_EQUAL_UINT(0, m_allocations);
+        }
+    }
+    m_count_allocations = false;
+
+    // the wrappers do see the allocations made elsewhere
+    void *ptr = malloc(1);
+    free(ptr);
+    TEST_ASSERT_EQUAL_UINT(0, m_allocations);
+    m_count_allocations = true;
+    ptr = malloc(1);
+    m_count_allocations = false;
+    free(ptr);
+    TEST_ASSERT_EQUAL_UINT(1, m_allocations);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(PrefixRangeTopLevel);
+    RUN_TEST(PrefixRangeNested);
+    RUN_TEST(CompletionDoesNotAllocate);
+
+    return UNITY_END();
+}
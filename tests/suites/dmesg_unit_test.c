@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+
+#include <unity.h>
+
+#include <test_utils.h>
+
+#include <pfs_dmesg.h>
+#include <pfs_handle_shell_input.h>
+
+static void write_str(const char *str) {
+    pfs_dmesg_write(str, strlen(str));
+}
+
+static int run(const char *line) {
+    char buffer[PFS_MAX_INPUT_SIZE];
+    char *argv[PFS_MAX_ARGC];
+    int argc = 0;
+    strcpy(buffer, line);
+    for (char *token = strtok(buffer, " "); token;
+         token = strtok(NULL, " ")) {
+        argv[argc++] = token;
+    }
+    utils_reset_out_string_immediately_buffer();
+    return pfs_dmesg_command(argc, argv);
+}
+
+void setUp(void) {
+    pfs_dmesg_clear();
+}
+
+void tearDown(void) {}
+
+void DumpsWrittenLines(void) {
+    write_str("one\ntw");
+    write_str("o\n");
+    TEST_ASSERT_EQUAL_INT(0, run(""));
+    TEST_ASSERT_EQUAL_STRING("one\ntwo\n",
+                             utils_get_out_string_immediately_buffer());
+}
+
+void UnterminatedLineIsEnded(void) {
+    write_str("one\ntwo");
+    TEST_ASSERT_EQUAL_INT(0, run(""));
+    TEST_ASSERT_EQUAL_STRING("one\ntwo\n",
+                             utils_get_out_string_immediately_buffer());
+}
+
+void LongLinesArePrintedInParts(void) {
+    write_str("0123456789abcdef\n");
+    TEST_ASSERT_EQUAL_INT(0, run(""));
+    TEST_ASSERT_EQUAL_STRING("0123456789abcdef\n",
+                             utils_get_out_string_immediately_buffer());
+}
+
+void OverwrittenLineIsSkipped(void) {
+    write_str("first line\n");
+    write_str("second line\n");
+    write_str("third line\n");
+    write_str("fourth line\n");
+    // "second line" has lost its beginning
+    TEST_ASSERT_EQUAL_INT(0, run(""));
+    TEST_ASSERT_EQUAL_STRING("third line\nfourth line\n",
+                             utils_get_out_string_immediately_buffer());
+}
+
+void WriteLargerThanRing(void) {
+    write_str("0123456789012345678901234567890123456789\nend\n");
+    TEST_ASSERT_EQUAL_INT(0, run(""));
+    TEST_ASSERT_EQUAL_STRING("end\n",
+                             utils_get_out_string_immediately_buffer());
+}
+
+void FilterByLevel(void) {
+    write_str("ERR a: x\n");
+    write_str("INF a: y\n");
+    write_str("p\n");
+    write_str("WRN b: z\n");
+    TEST_ASSERT_EQUAL_INT(0, run("-l wrn"));
+    TEST_ASSERT_EQUAL_STRING("ERR a: x\nWRN b: z\n",
+                             utils_get_out_string_immediately_buffer());
+    TEST_ASSERT_EQUAL_INT(0, run("-l err"));
+    TEST_ASSERT_EQUAL_STRING("ERR a: x\n",
+                             utils_get_out_string_immediately_buffer());
+}
+
+void FilterByText(void) {
+    write_str("alpha\n");
+    write_str("beta\n");
+    write_str("alpine\n");
+    TEST_ASSERT_EQUAL_INT(0, run("al"));
+    TEST_ASSERT_EQUAL_STRING("alpha\nalpine\n",
+                             utils_get_out_string_immediately_buffer());
+    TEST_ASSERT_EQUAL_INT(0, run("-l inf al"));
+    TEST_ASSERT_EQUAL_STRING("", utils_get_out_string_immediately_buffer());
+}
+
+void FilterByTextMatchesWholeLine(void) {
+    // parts of 7 characters: "0123456", "789abcd", "ef\n"
+    write_str("0123456789abcdef\n");
+    write_str("short\n");
+    TEST_ASSERT_EQUAL_INT(0, run("cd"));
+    TEST_ASSERT_EQUAL_STRING("0123456789abcdef\n",
+                             utils_get_out_string_immediately_buffer());
+    TEST_ASSERT_EQUAL_INT(0, run("5678"));
+    TEST_ASSERT_EQUAL_STRING("0123456789abcdef\n",
+                             utils_get_out_string_immediately_buffer());
+    TEST_ASSERT_EQUAL_INT(0, run("def"));
+    TEST_ASSERT_EQUAL_STRING("0123456789abcdef\n",
+                             utils_get_out_string_immediately_buffer());
+    TEST_ASSERT_EQUAL_INT(0, run("6s"));
+    TEST_ASSERT_EQUAL_STRING("", utils_get_out_string_immediately_buffer());
+}
+
+void Clear(void) {
+    write_str("old\n");
+    TEST_ASSERT_EQUAL_INT(0, run("-c"));
+    write_str("new\n");
+    TEST_ASSERT_EQUAL_INT(0, run(""));
+    TEST_ASSERT_EQUAL_STRING("new\n",
+                             utils_get_out_string_immediately_buffer());
+}
+
+void InvalidArguments(void) {
+    TEST_ASSERT_NOT_EQUAL(0, run("-l"));
+    TEST_ASSERT_NOT_NULL(
+            strstr(utils_get_out_string_immediately_buffer(), "usage"));
+    TEST_ASSERT_NOT_EQUAL(0, run("-l off"));
+    TEST_ASSERT_NOT_EQUAL(0, run("-l verbose"));
+    TEST_ASSERT_NOT_EQUAL(0, run("one two"));
+    TEST_ASSERT_NOT_EQUAL(0, run("-l err one two"));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(DumpsWrittenLines);
+    RUN_TEST(UnterminatedLineIsEnded);
+    RUN_TEST(LongLinesArePrintedInParts);
+    RUN_TEST(OverwrittenLineIsSkipped);
+    RUN_TEST(WriteLargerThanRing);
+    RUN_TEST(FilterByLevel);
+    RUN_TEST(FilterByText);
+    RUN_TEST(FilterByTextMatchesWholeLine);
+    RUN_TEST(Clear);
+    RUN_TEST(InvalidArguments);
+
+    return UNITY_END();
+}
@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <unity.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <pico_freertos_shell/commands.h>
+#include <pico_freertos_shell/execute.h>
+#include <pico_freertos_shell/init.h>
+#include <pico_freertos_shell/transport.h>
+
+#include <pfs_utils.h>
+
+// the shell tasks run on the FreeRTOS stand-in, this thread is the caller
+#define EXECUTE_TIMEOUT pdMS_TO_TICKS(1000)
+
+bool _pfs_is_initialized(void);
+
+static bool m_released;
+
+static void hello_handler(int argc, char **argv) {
+    (void) argc;
+    (void) argv;
+    printf("hello\n");
+}
+
+static void digits_handler(int argc, char **argv) {
+    (void) argc;
+    (void) argv;
+    printf("0123456789\n");
+}
+
+static void block_handler(int argc, char **argv) {
+    (void) argc;
+    (void) argv;
+    printf("blocked\n");
+    while (!__atomic_load_n(&m_released, __ATOMIC_ACQUIRE)) {
+        vTaskDelay(1);
+    }
+    printf("released\n");
+}
+
+static const pfs_command_t m_commands[] = {
+        PFS_COMMAND_INITIALIZER(hello, "prints hello",
+                                PFS_COMMAND_HANDLER(hello_handler)),
+        PFS_COMMAND_INITIALIZER(digits, "prints the digits",
+                                PFS_COMMAND_HANDLER(digits_handler)),
+        PFS_COMMAND_INITIALIZER(block, "waits until released",
+                                PFS_COMMAND_HANDLER(block_handler)),
+};
+
+// nobody is connected to the terminal session, its output is dropped
+static int terminal_write(pfs_transport_t *transport,
+                          const char *data,
+                          size_t len,
+                          pfs_transport_write_done_t done,
+                          void *arg) {
+    (void) transport;
+    (void) data;
+    (void) len;
+    if (done != NULL) {
+        done(arg);
+    }
+    return 0;
+}
+
+static size_t
+terminal_read(pfs_transport_t *transport, char *buffer, size_t size) {
+    (void) transport;
+    (void) buffer;
+    (void) size;
+    return 0;
+}
+
+static void terminal_flush(pfs_transport_t *transport) {
+    (void) transport;
+}
+
+static const pfs_transport_vtable_t TERMINAL_VTABLE = {
+        .write = terminal_write,
+        .read = terminal_read,
+        .flush = terminal_flush,
+};
+
+static pfs_transport_t m_terminal = {
+        .vtable = &TERMINAL_VTABLE,
+};
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void OutputToBuffer(void) {
+    char buffer[32];
+    pfs_output_sink_t sink = {.buffer = buffer, .size = sizeof(buffer)};
+    TEST_ASSERT_EQUAL_INT(PFS_EXECUTE_OK,
+                          pfs_execute("hello", &sink, EXECUTE_TIMEOUT));
+    TEST_ASSERT_EQUAL_STRING("hello\n", buffer);
+    TEST_ASSERT_EQUAL_UINT(6, sink.len);
+    TEST_ASSERT_FALSE(sink.truncated);
+
+    // the next command starts with an empty buffer
+    TEST_ASSERT_EQUAL_INT(PFS_EXECUTE_OK,
+                          pfs_execute("digits", &sink, EXECUTE_TIMEOUT));
+    TEST_ASSERT_EQUAL_STRING("0123456789\n", buffer);
+}
+
+void OutputIsTruncated(void) {
+    char buffer[8];
+    pfs_output_sink_t sink = {.buffer = buffer, .size = sizeof(buffer)};
+    TEST_ASSERT_EQUAL_INT(PFS_EXECUTE_OK,
+                          pfs_execute("digits", &sink, EXECUTE_TIMEOUT));
+    TEST_ASSERT_EQUAL_STRING("0123456", buffer);
+    TEST_ASSERT_EQUAL_UINT(7, sink.len);
+    TEST_ASSERT_TRUE(sink.truncated);
+}
+
+void InvalidInputFails(void) {
+    char buffer[128];
+    pfs_output_sink_t sink = {.buffer = buffer, .size = sizeof(buffer)};
+    TEST_ASSERT_EQUAL_INT(PFS_EXECUTE_FAILED,
+                          pfs_execute("nosuch", &sink, EXECUTE_TIMEOUT));
+    TEST_ASSERT_NOT_NULL(strstr(buffer, "nosuch: command not found"));
+    TEST_ASSERT_EQUAL_INT(PFS_EXECUTE_FAILED,
+                          pfs_execute("\"unclosed", &sink, EXECUTE_TIMEOUT));
+    TEST_ASSERT_NOT_NULL(strstr(buffer, "unclosed quote"));
+    TEST_ASSERT_EQUAL_INT(PFS_EXECUTE_FAILED,
+                          pfs_execute(NULL, &sink, EXECUTE_TIMEOUT));
+}
+
+void BuiltinRunsInCaptureSession(void) {
+    char buffer[1024];
+    pfs_output_sink_t sink = {.buffer = buffer, .size = sizeof(buffer)};
+    TEST_ASSERT_EQUAL_INT(PFS_EXECUTE_OK,
+                          pfs_execute("help", &sink, EXECUTE_TIMEOUT));
+    TEST_ASSERT_NOT_NULL(strstr(buffer, "Available commands:"));
+    TEST_ASSERT_NOT_NULL(strstr(buffer, "prints hello"));
+    TEST_ASSERT_NOT_NULL(strstr(buffer, "waits until released"));
+    TEST_ASSERT_FALSE(sink.truncated);
+}
+
+void TimeoutThenBusyUntilFinished(void) {
+    char blocked[32];
+    pfs_output_sink_t blocked_sink = {.buffer = blocked,
+                                      .size = sizeof(blocked)};
+    TEST_ASSERT_EQUAL_INT(PFS_EXECUTE_TIMEOUT,
+                          pfs_execute("block", &blocked_sink,
+                                      pdMS_TO_TICKS(100)));
+
+    // the command is still running, nothing else is started meanwhile
+    char buffer[32];
+    pfs_output_sink_t sink = {.buffer = buffer, .size = sizeof(buffer)};
+    TEST_ASSERT_EQUAL_INT(PFS_EXECUTE_BUSY,
+                          pfs_execute("hello", &sink, EXECUTE_TIMEOUT));
+    TEST_ASSERT_EQUAL_INT(PFS_EXECUTE_BUSY,
+                          pfs_execute("help", &sink, EXECUTE_TIMEOUT));
+
+    __atomic_store_n(&m_released, true, __ATOMIC_RELEASE);
+    int ret = PFS_EXECUTE_BUSY;
+    for (int i = 0; i < 1000 && ret == PFS_EXECUTE_BUSY; i++) {
+        vTaskDelay(1);
+        ret = pfs_execute("hello", &sink, EXECUTE_TIMEOUT);
+    }
+    TEST_ASSERT_EQUAL_INT(PFS_EXECUTE_OK, ret);
+    TEST_ASSERT_EQUAL_STRING("hello\n", buffer);
+    // the rest of the timed out command's output was discarded
+    TEST_ASSERT_NULL(strstr(blocked, "released"));
+}
+
+int main(void) {
+    if (pfs_commands_register(m_commands, PFS_ARRAY_SIZE(m_commands))
+        || pfs_session_add(&m_terminal)) {
+        return 1;
+    }
+    pfs_init();
+    // the shell task marks the shell initialized once it runs
+    while (!_pfs_is_initialized()) {
+        vTaskDelay(1);
+    }
+
+    UNITY_BEGIN();
+
+    RUN_TEST(OutputToBuffer);
+    RUN_TEST(OutputIsTruncated);
+    RUN_TEST(InvalidInputFails);
+    RUN_TEST(BuiltinRunsInCaptureSession);
+    RUN_TEST(TimeoutThenBusyUntilFinished);
+
+    return UNITY_END();
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+
+#include <unity.h>
+
+#include <test_utils.h>
+
+#include <pfs_io.h>
+
+void setUp(void) {
+    utils_reset_out_string_immediately_buffer();
+}
+
+void tearDown(void) {}
+
+#define PROMPT "shell:~$ "
+
+static void redraw(const char *old_text,
+                   size_t old_cursor,
+                   const char *new_text,
+                   size_t new_cursor) {
+    pfs_io_line_t old_line = {
+            .text = old_text,
+            .len = strlen(old_text),
+            .cursor = old_cursor,
+    };
+    pfs_io_line_t new_line = {
+            .text = new_text,
+            .len = strlen(new_text),
+            .cursor = new_cursor,
+    };
+    pfs_io_redraw_line(PROMPT, &old_line, &new_line);
+}
+
+void RedrawOnlyTheDifference(void) {
+    // clang-format off
+    redraw("sensor read", 11, "sensor write", 12);
+    TEST_ASSERT_EQUAL_STRING(
+        PFS_IO_MOVE_LEFT PFS_IO_MOVE_LEFT PFS_IO_MOVE_LEFT PFS_IO_MOVE_LEFT
+        "write",
+        utils_get_out_string_immediately_buffer());
+
+    utils_reset_out_string_immediately_buffer();
+    redraw("sensor wr", 9, "sensor", 6);
+    TEST_ASSERT_EQUAL_STRING(
+        PFS_IO_MOVE_LEFT PFS_IO_MOVE_LEFT PFS_IO_MOVE_LEFT
+        PFS_IO_ERASE_LINE_RIGHT,
+        utils_get_out_string_immediately_buffer());
+
+    utils_reset_out_string_immediately_buffer();
+    redraw("ls", 0, "ls -l", 2);
+    TEST_ASSERT_EQUAL_STRING(
+        "ls -l" PFS_IO_MOVE_LEFT PFS_IO_MOVE_LEFT PFS_IO_MOVE_LEFT,
+        utils_get_out_string_immediately_buffer());
+
+    utils_reset_out_string_immediately_buffer();
+    redraw("same", 4, "same", 4);
+    TEST_ASSERT_EQUAL_STRING("", utils_get_out_string_immediately_buffer());
+    // clang-format on
+}
+
+void RedrawFromPromptIfShorter(void) {
+    // clang-format off
+    redraw("abcdefghij", 10, "xyz", 3);
+    TEST_ASSERT_EQUAL_STRING(
+        "\r" PROMPT "xyz" PFS_IO_ERASE_LINE_RIGHT,
+        utils_get_out_string_immediately_buffer());
+    // clang-format on
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(RedrawOnlyTheDifference);
+    RUN_TEST(RedrawFromPromptIfShorter);
+
+    return UNITY_END();
+}
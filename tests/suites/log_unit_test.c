@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <unity.h>
+
+#include <test_utils.h>
+
+#include <pico_freertos_shell/log.h>
+
+#include <pfs_handle_shell_input.h>
+#include <pfs_log.h>
+
+static PFS_LOG_MODULE_DEFINE(sensor, INF);
+static PFS_LOG_MODULE_DEFINE(wifi, ERR);
+
+void setUp(void) {
+    utils_reset_out_string_immediately_buffer();
+    pfs_reset_commands();
+    pfs_reset_log_modules();
+    PFS_LOG_MODULE(sensor)->level = PFS_LOG_LEVEL_INF;
+    PFS_LOG_MODULE(wifi)->level = PFS_LOG_LEVEL_ERR;
+    TEST_ASSERT_EQUAL_INT(0, pfs_log_module_register(PFS_LOG_MODULE(sensor)));
+    TEST_ASSERT_EQUAL_INT(0, pfs_log_module_register(PFS_LOG_MODULE(wifi)));
+}
+
+void tearDown(void) {}
+
+static int m_evaluated;
+
+static int evaluate(void) {
+    return ++m_evaluated;
+}
+
+void ThresholdCheckedBeforeArguments(void) {
+    m_evaluated = 0;
+    PFS_LOG(sensor, DBG, "reading %d\n", evaluate());
+    PFS_LOG(wifi, WRN, "reading %d\n", evaluate());
+    TEST_ASSERT_EQUAL_INT(0, m_evaluated);
+
+    PFS_LOG(sensor, INF, "reading %d\n", evaluate());
+    PFS_LOG(wifi, ERR, "reading %d\n", evaluate());
+    TEST_ASSERT_EQUAL_INT(2, m_evaluated);
+}
+
+// everything above the floor is compiled out, regardless of the threshold
+#undef PFS_LOG_LEVEL_MAX
+#define PFS_LOG_LEVEL_MAX PFS_LOG_LEVEL_WRN
+
+static void log_above_floor(void) {
+    PFS_LOG(sensor, INF, "reading %d\n", evaluate());
+    PFS_LOG(sensor, DBG, "reading %d\n", evaluate());
+}
+
+#undef PFS_LOG_LEVEL_MAX
+#define PFS_LOG_LEVEL_MAX PFS_LOG_LEVEL_DBG
+
+void CompileTimeFloor(void) {
+    m_evaluated = 0;
+    PFS_LOG_MODULE(sensor)->level = PFS_LOG_LEVEL_DBG;
+    log_above_floor();
+    TEST_ASSERT_EQUAL_INT(0, m_evaluated);
+}
+
+void RegisterModules(void) {
+    // again is fine, another module of the same name is not
+    TEST_ASSERT_EQUAL_INT(0, pfs_log_module_register(PFS_LOG_MODULE(sensor)));
+
+    static pfs_log_module_t other_sensor = {.name = "sensor"};
+    utils_reset_out_string_immediately_buffer();
+    TEST_ASSERT_NOT_EQUAL(0, pfs_log_module_register(&other_sensor));
+    TEST_ASSERT_EQUAL_STRING(PFS_IO_SHELL_MESSAGE_ERR_BEGIN
+                             "log module 'sensor' already registered\n",
+                             utils_get_out_string_immediately_buffer());
+}
+
+// clang-format off
+void LoglevelCommand(void) {
+    TEST_ASSERT_EQUAL_INT(0, pfs_handle_shell_input("loglevel"));
+    TEST_ASSERT_EQUAL_STRING(
+            PFS_IO_SHELL_MESSAGE_INF_BEGIN "wifi             err\n"
+            PFS_IO_SHELL_MESSAGE_INF_BEGIN "sensor           inf\n",
+            utils_get_out_string_immediately_buffer());
+
+    TEST_ASSERT_EQUAL_INT(0, pfs_handle_shell_input("loglevel sensor dbg"));
+    TEST_ASSERT_EQUAL_INT(PFS_LOG_LEVEL_DBG, PFS_LOG_MODULE(sensor)->level);
+    TEST_ASSERT_EQUAL_INT(PFS_LOG_LEVEL_ERR, PFS_LOG_MODULE(wifi)->level);
+
+    TEST_ASSERT_EQUAL_INT(0, pfs_handle_shell_input("loglevel all OFF"));
+    TEST_ASSERT_EQUAL_INT(PFS_LOG_LEVEL_OFF, PFS_LOG_MODULE(sensor)->level);
+    TEST_ASSERT_EQUAL_INT(PFS_LOG_LEVEL_OFF, PFS_LOG_MODULE(wifi)->level);
+
+    utils_reset_out_string_immediately_buffer();
+    TEST_ASSERT_EQUAL_INT(1, pfs_handle_shell_input("loglevel gps dbg"));
+    TEST_ASSERT_EQUAL_STRING(
+            PFS_IO_SHELL_MESSAGE_WRN_BEGIN "gps: log module not found\n"
+            PFS_IO_SHELL_MESSAGE_WRN_BEGIN "type 'loglevel' for a list of log modules\n",
+            utils_get_out_string_immediately_buffer());
+
+    utils_reset_out_string_immediately_buffer();
+    TEST_ASSERT_EQUAL_INT(1, pfs_handle_shell_input("loglevel sensor verbose"));
+    TEST_ASSERT_EQUAL_INT(1, pfs_handle_shell_input("loglevel sensor"));
+    TEST_ASSERT_EQUAL_STRING(
+            PFS_IO_SHELL_MESSAGE_WRN_BEGIN "usage: loglevel [<module>|all <off|err|wrn|inf|dbg>]\n"
+            PFS_IO_SHELL_MESSAGE_WRN_BEGIN "usage: loglevel [<module>|all <off|err|wrn|inf|dbg>]\n",
+            utils_get_out_string_immediately_buffer());
+    TEST_ASSERT_EQUAL_INT(PFS_LOG_LEVEL_OFF, PFS_LOG_MODULE(sensor)->level);
+}
+// clang-format on
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(ThresholdCheckedBeforeArguments);
+    RUN_TEST(CompileTimeFloor);
+    RUN_TEST(RegisterModules);
+    RUN_TEST(LoglevelCommand);
+
+    return UNITY_END();
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <unity.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include <pico_freertos_shell/init.h>
+#include <pico_freertos_shell/transport.h>
+
+#include <test_utils.h>
+
+// built in both modes, the messages are queued by this thread and printed
+// by the shell task (running on the FreeRTOS stand-in) with their timestamps
+
+bool _pfs_is_initialized(void);
+void _pfs_append_queue(const char *buffer, uint32_t buffer_size);
+
+static pthread_mutex_t m_output_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char m_output[4096];
+static size_t m_output_len;
+
+static int terminal_write(pfs_transport_t *transport,
+                          const char *data,
+                          size_t len,
+                          pfs_transport_write_done_t done,
+                          void *arg) {
+    (void) transport;
+    pthread_mutex_lock(&m_output_mutex);
+    if (len > sizeof(m_output) - 1 - m_output_len) {
+        len = sizeof(m_output) - 1 - m_output_len;
+    }
+    memcpy(&m_output[m_output_len], data, len);
+    m_output_len += len;
+    m_output[m_output_len] = '\0';
+    pthread_mutex_unlock(&m_output_mutex);
+    if (done != NULL) {
+        done(arg);
+    }
+    return 0;
+}
+
+static size_t
+terminal_read(pfs_transport_t *transport, char *buffer, size_t size) {
+    (void) transport;
+    (void) buffer;
+    (void) size;
+    return 0;
+}
+
+static void terminal_flush(pfs_transport_t *transport) {
+    (void) transport;
+}
+
+static const pfs_transport_vtable_t TERMINAL_VTABLE = {
+        .write = terminal_write,
+        .read = terminal_read,
+        .flush = terminal_flush,
+};
+
+static pfs_transport_t m_terminal = {
+        .vtable = &TERMINAL_VTABLE,
+};
+
+static void queue_at(uint32_t time_us, const char *text) {
+    utils_set_time_us(time_us);
+    _pfs_append_queue(text, strlen(text));
+}
+
+// the output is compared once it ends with `last`, the prompt is printed
+// around the messages as well
+static void assert_output(const char *expected, const char *last) {
+    char output[sizeof(m_output)];
+    for (int i = 0; i < 1000; i++) {
+        pthread_mutex_lock(&m_output_mutex);
+        memcpy(output, m_output, sizeof(output));
+        pthread_mutex_unlock(&m_output_mutex);
+        if (strstr(output, last) != NULL) {
+            break;
+        }
+        vTaskDelay(1);
+    }
+    TEST_ASSERT_NOT_NULL(strstr(output, expected));
+}
+
+static bool output_contains(const char *text) {
+    pthread_mutex_lock(&m_output_mutex);
+    bool contains = strstr(m_output, text) != NULL;
+    pthread_mutex_unlock(&m_output_mutex);
+    return contains;
+}
+
+void setUp(void) {
+    pthread_mutex_lock(&m_output_mutex);
+    m_output_len = 0;
+    m_output[0] = '\0';
+    pthread_mutex_unlock(&m_output_mutex);
+}
+
+void tearDown(void) {}
+
+#ifdef PFS_MESSAGE_TIMESTAMPS_RELATIVE
+void RelativeToPreviousLine(void) {
+    // the first line has nothing to be relative to
+    queue_at(5000000, "first\n");
+    queue_at(5250000, "second\n");
+    queue_at(7250001, "third\n");
+    assert_output("[+0.000000] first\n", "third\n");
+    TEST_ASSERT_TRUE(output_contains("[+0.250000] second\n"));
+    TEST_ASSERT_TRUE(output_contains("[+2.000001] third\n"));
+}
+
+void OutOfOrderIsClampedToZero(void) {
+    queue_at(9000000, "later\n");
+    queue_at(8000000, "earlier\n");
+    assert_output("[+0.000000] earlier\n", "earlier\n");
+}
+
+void ContinuationIsNotStamped(void) {
+    queue_at(10000000, "par");
+    queue_at(10500000, "tial\n");
+    queue_at(11000000, "next\n");
+    assert_output("tial\n", "next\n");
+    TEST_ASSERT_TRUE(output_contains("] par"));
+    TEST_ASSERT_FALSE(output_contains("] tial"));
+    // relative to the beginning of the line before
+    TEST_ASSERT_TRUE(output_contains("[+1.000000] next\n"));
+}
+#else // PFS_MESSAGE_TIMESTAMPS_RELATIVE
+void AbsoluteTime(void) {
+    queue_at(1234567, "one\n");
+    queue_at(123000000, "two\n");
+    assert_output("[    1.234567] one\n", "two\n");
+    TEST_ASSERT_TRUE(output_contains("[  123.000000] two\n"));
+}
+
+void ContinuationIsNotStamped(void) {
+    queue_at(2000000, "par");
+    queue_at(3000000, "tial\n");
+    queue_at(4000000, "next\n");
+    assert_output("[    2.000000] par", "next\n");
+    TEST_ASSERT_FALSE(output_contains("[    3.000000]"));
+    TEST_ASSERT_TRUE(output_contains("tial\n"));
+    TEST_ASSERT_TRUE(output_contains("[    4.000000] next\n"));
+}
+#endif // PFS_MESSAGE_TIMESTAMPS_RELATIVE
+
+int main(void) {
+    if (pfs_session_add(&m_terminal)) {
+        return 1;
+    }
+    pfs_init();
+    // the shell task marks the shell initialized once it runs
+    while (!_pfs_is_initialized()) {
+        vTaskDelay(1);
+    }
+
+    UNITY_BEGIN();
+
+#ifdef PFS_MESSAGE_TIMESTAMPS_RELATIVE
+    RUN_TEST(RelativeToPreviousLine);
+    RUN_TEST(OutOfOrderIsClampedToZero);
+    RUN_TEST(ContinuationIsNotStamped);
+#else // PFS_MESSAGE_TIMESTAMPS_RELATIVE
+    RUN_TEST(AbsoluteTime);
+    RUN_TEST(ContinuationIsNotStamped);
+#endif // PFS_MESSAGE_TIMESTAMPS_RELATIVE
+
+    return UNITY_END();
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+
+#include <unity.h>
+
+#include <test_utils.h>
+
+#include <pfs_output_sequence.h>
+
+static const int m_producer_a;
+static const int m_producer_b;
+static const int m_producer_c;
+
+void setUp(void) {
+    pfs_reset_output_sequence();
+}
+
+void tearDown(void) {}
+
+static void assert_stamp(const void *producer, const char *expected) {
+    char prefix[PFS_OUTPUT_SEQUENCE_PREFIX_LEN + 1] = {0};
+    pfs_output_sequence_stamp(producer, prefix);
+    TEST_ASSERT_EQUAL_STRING(expected, prefix);
+}
+
+void StampPerProducer(void) {
+    assert_stamp(&m_producer_a, "\x1e" "010000");
+    assert_stamp(&m_producer_b, "\x1e" "020000");
+    assert_stamp(&m_producer_a, "\x1e" "010001");
+    assert_stamp(&m_producer_a, "\x1e" "010002");
+    assert_stamp(&m_producer_b, "\x1e" "020001");
+}
+
+void ProducersBeyondTableShareIdZero(void) {
+    assert_stamp(&m_producer_a, "\x1e" "010000");
+    assert_stamp(&m_producer_b, "\x1e" "020000");
+    assert_stamp(&m_producer_c, "\x1e" "000000");
+    assert_stamp(NULL, "\x1e" "000001");
+}
+
+void SequenceWraps(void) {
+    char prefix[PFS_OUTPUT_SEQUENCE_PREFIX_LEN];
+    for (uint32_t i = 0; i < 0xffff; i++) {
+        pfs_output_sequence_stamp(&m_producer_a, prefix);
+    }
+    assert_stamp(&m_producer_a, "\x1e" "01ffff");
+    assert_stamp(&m_producer_a, "\x1e" "010000");
+}
+
+void ParsePrefix(void) {
+    uint8_t producer;
+    uint16_t sequence;
+    TEST_ASSERT_EQUAL_INT(0, pfs_output_sequence_parse("\x1e" "2a10ff",
+                                                       &producer, &sequence));
+    TEST_ASSERT_EQUAL_INT(0x2a, producer);
+    TEST_ASSERT_EQUAL_INT(0x10ff, sequence);
+
+    TEST_ASSERT_NOT_EQUAL(0, pfs_output_sequence_parse("x2a10ff", &producer,
+                                                       &sequence));
+    TEST_ASSERT_NOT_EQUAL(0, pfs_output_sequence_parse("\x1e" "2A10ff",
+                                                       &producer, &sequence));
+    TEST_ASSERT_NOT_EQUAL(0, pfs_output_sequence_parse("\x1e" "2a10\n",
+                                                       &producer, &sequence));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(StampPerProducer);
+    RUN_TEST(ProducersBeyondTableShareIdZero);
+    RUN_TEST(SequenceWraps);
+    RUN_TEST(ParsePrefix);
+
+    return UNITY_END();
+}
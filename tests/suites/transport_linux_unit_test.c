@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <unity.h>
+
+#include <pico_freertos_shell/transport_linux.h>
+
+#define SOCKET_PATH "transport_linux_unit_test.sock"
+
+static pfs_linux_transport_t m_transport;
+static pfs_transport_t *m_base = &m_transport.base;
+static size_t m_done_calls;
+
+void setUp(void) {
+    m_done_calls = 0;
+}
+
+void tearDown(void) {
+    pfs_linux_transport_close(&m_transport);
+    unlink(SOCKET_PATH);
+}
+
+static void write_done(void *arg) {
+    TEST_ASSERT_EQUAL_PTR(&m_done_calls, arg);
+    m_done_calls++;
+}
+
+static int connect_client(void) {
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    strcpy(address.sun_path, SOCKET_PATH);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    TEST_ASSERT_NOT_EQUAL(-1, fd);
+    TEST_ASSERT_EQUAL_INT(0, connect(fd, (const struct sockaddr *) &address,
+                                     sizeof(address)));
+    return fd;
+}
+
+static void assert_read(int fd, const char *expected) {
+    char buffer[32] = {0};
+    size_t len = strlen(expected);
+    TEST_ASSERT_EQUAL_INT(len, read(fd, buffer, len));
+    TEST_ASSERT_EQUAL_STRING(expected, buffer);
+}
+
+void SocketExchangesData(void) {
+    TEST_ASSERT_EQUAL_INT(
+            0, pfs_linux_transport_open_socket(&m_transport, SOCKET_PATH));
+    int client = connect_client();
+
+    TEST_ASSERT_EQUAL_INT(0, m_base->vtable->write(m_base, "hello", 5,
+                                                   write_done, &m_done_calls));
+    TEST_ASSERT_EQUAL_INT(1, m_done_calls);
+    assert_read(client, "hello");
+
+    char buffer[8];
+    TEST_ASSERT_EQUAL_INT(0, m_base->vtable->read(m_base, buffer, 8));
+    TEST_ASSERT_EQUAL_INT(3, write(client, "ls\r", 3));
+    TEST_ASSERT_EQUAL_INT(3, m_base->vtable->read(m_base, buffer, 8));
+    TEST_ASSERT_EQUAL_MEMORY("ls\r", buffer, 3);
+
+    close(client);
+}
+
+void SocketAcceptsNextClient(void) {
+    TEST_ASSERT_EQUAL_INT(
+            0, pfs_linux_transport_open_socket(&m_transport, SOCKET_PATH));
+
+    // output is dropped without a client, but still completed
+    TEST_ASSERT_NOT_EQUAL(0, m_base->vtable->write(m_base, "lost", 4,
+                                                   write_done, &m_done_calls));
+    TEST_ASSERT_EQUAL_INT(1, m_done_calls);
+
+    int client = connect_client();
+    TEST_ASSERT_EQUAL_INT(0, m_base->vtable->write(m_base, "first", 5, NULL,
+                                                   NULL));
+    assert_read(client, "first");
+    close(client);
+
+    char buffer[8];
+    TEST_ASSERT_EQUAL_INT(0, m_base->vtable->read(m_base, buffer, 8));
+    TEST_ASSERT_EQUAL_INT(-1, m_transport.fd);
+
+    client = connect_client();
+    TEST_ASSERT_EQUAL_INT(0, m_base->vtable->write(m_base, "second", 6, NULL,
+                                                   NULL));
+    assert_read(client, "second");
+    close(client);
+}
+
+void PtyExchangesData(void) {
+    char name[64];
+    TEST_ASSERT_EQUAL_INT(0, pfs_linux_transport_open_pty(&m_transport, name,
+                                                          sizeof(name)));
+    int slave = open(name, O_RDWR | O_NOCTTY);
+    TEST_ASSERT_NOT_EQUAL(-1, slave);
+
+    TEST_ASSERT_EQUAL_INT(0, m_base->vtable->write(m_base, "a\nb", 3, NULL,
+                                                   NULL));
+    // raw mode, no newline translation
+    assert_read(slave, "a\nb");
+
+    TEST_ASSERT_EQUAL_INT(2, write(slave, "x\r", 2));
+    char buffer[8];
+    size_t len = 0;
+    for (int i = 0; i < 100 && len == 0; i++) {
+        len = m_base->vtable->read(m_base, buffer, sizeof(buffer));
+        usleep(1000);
+    }
+    TEST_ASSERT_EQUAL_INT(2, len);
+    TEST_ASSERT_EQUAL_MEMORY("x\r", buffer, 2);
+
+    close(slave);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(SocketExchangesData);
+    RUN_TEST(SocketAcceptsNextClient);
+    RUN_TEST(PtyExchangesData);
+
+    return UNITY_END();
+}
@@ -20,8 +20,10 @@
  * SOFTWARE.
  */
 
+#include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <pico_freertos_shell/init.h>
@@ -29,6 +31,7 @@
 #include <pfs_io.h>
 #include <pfs_utils.h>
 #include <pfs_handle_shell_input.h>
+#include <pfs_pipe.h>
 
 static char m_buffer[4096];
 
@@ -44,6 +47,72 @@ bool _pfs_is_initialized(void) {
     return false;
 }
 
+// pico_printf is not linked, format with the C library (on the stack unless
+// the output is long, pico_printf does not allocate either)
+int vfctprintf(void (*out)(char character, void *arg),
+               void *arg,
+               const char *format,
+               va_list va) {
+    char local[256];
+    va_list copy;
+    va_copy(copy, va);
+    int len = vsnprintf(local, sizeof(local), format, copy);
+    va_end(copy);
+    char *buffer = local;
+    if (len >= (int) sizeof(local)) {
+        buffer = malloc((size_t) len + 1);
+        if (buffer == NULL) {
+            return len;
+        }
+        vsnprintf(buffer, (size_t) len + 1, format, va);
+    }
+    for (int i = 0; i < len; i++) {
+        out(buffer[i], arg);
+    }
+    if (buffer != local) {
+        free(buffer);
+    }
+    return len;
+}
+
+// filters of the command being executed, as in the command handler task
+static pfs_pipe_t *m_pipe;
+
+static void append_buffer(const char *data, size_t len) {
+    strncat(m_buffer, data, len);
+}
+
+void _pfs_append_queue(const char *buffer, uint32_t buffer_size) {
+    if (m_pipe != NULL) {
+        pfs_pipe_write(m_pipe, buffer, buffer_size, append_buffer);
+    } else {
+        append_buffer(buffer, buffer_size);
+    }
+}
+
+// stands still unless a test moves it
+static uint32_t m_time_us;
+
+void utils_set_time_us(uint32_t time_us) {
+    m_time_us = time_us;
+}
+
+uint32_t _pfs_time_us(void) {
+    return m_time_us;
+}
+
+void _pfs_output_lock(void) {}
+
+void _pfs_output_unlock(void) {}
+
+void _pfs_commands_lock(void) {}
+
+void _pfs_commands_unlock(void) {}
+
+void _pfs_commands_synchronize(void) {}
+
+void _pfs_commands_drain(void) {}
+
 void PFS_WRAPPED(pfs_io_puts_immediately)(const char *s) {
     strcat(m_buffer, s);
 }
@@ -53,15 +122,16 @@ void PFS_WRAPPED(pfs_io_putchar_immediately)(char c) {
     PFS_WRAPPED(pfs_io_puts_immediately)(buf);
 }
 
-void pfs_handle_esacpe_sequence(pfs_input_buffer_t *input_buffer) {
-    (void) input_buffer;
-}
-
 int pfs_cmd_queue_is_in_handler(void) {
     return 0;
 }
 
 int pfs_cmd_queue_add(pfs_cmd_args_t *cmd_args) {
+    m_pipe = cmd_args->pipe;
     cmd_args->handler(cmd_args->argc, cmd_args->argv);
+    if (m_pipe != NULL) {
+        pfs_pipe_finish(m_pipe, append_buffer);
+        m_pipe = NULL;
+    }
     return 0;
 }
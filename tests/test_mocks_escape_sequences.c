@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdbool.h>
+
+#include <pfs_escape_sequences.h>
+
+// escape sequences are not handled by the test suites, the trace replay links
+// the real ones instead
+
+void pfs_handle_esacpe_sequence(pfs_input_buffer_t *input_buffer) {
+    (void) input_buffer;
+}
+
+bool pfs_escape_sequence_handle_char(pfs_input_buffer_t *input_buffer,
+                                     char c) {
+    (void) input_buffer;
+    (void) c;
+    return false;
+}
+
+void pfs_escape_sequence_flush(pfs_input_buffer_t *input_buffer) {
+    (void) input_buffer;
+}
+
+void pfs_escape_sequence_expire(pfs_input_buffer_t *input_buffer,
+                                uint32_t now_us) {
+    (void) input_buffer;
+    (void) now_us;
+}
@@ -0,0 +1,362 @@
+/*
+ * Copyright (c) 2025 Jakub Zimnol
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <FreeRTOS.h>
+#include <queue.h>
+#include <semphr.h>
+#include <task.h>
+
+#include <pico/stdlib.h>
+
+#include <pico_freertos_shell/transport.h>
+
+#include <pfs_session.h>
+#include <pfs_utils.h>
+
+#include <test_utils.h>
+
+// all the kernel objects are guarded by a single lock, every change of their
+// state wakes up everybody waiting for one
+static pthread_mutex_t m_kernel = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t m_changed = PTHREAD_COND_INITIALIZER;
+
+static __thread TaskHandle_t m_current_task;
+
+static uint64_t now_us(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000u + (uint64_t) now.tv_nsec / 1000u;
+}
+
+static void deadline_after(TickType_t ticks, struct timespec *deadline) {
+    clock_gettime(CLOCK_REALTIME, deadline);
+    uint64_t ns = (uint64_t) deadline->tv_nsec + (uint64_t) ticks * 1000000u;
+    deadline->tv_sec += (time_t) (ns / 1000000000u);
+    deadline->tv_nsec = (long) (ns % 1000000000u);
+}
+
+// with the kernel lock taken, false once the deadline has passed
+static bool wait_for_change(TickType_t timeout,
+                            const struct timespec *deadline) {
+    if (timeout == portMAX_DELAY) {
+        pthread_cond_wait(&m_changed, &m_kernel);
+        return true;
+    }
+    return pthread_cond_timedwait(&m_changed, &m_kernel, deadline)
+           != ETIMEDOUT;
+}
+
+static void changed(void) {
+    pthread_cond_broadcast(&m_changed);
+}
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t length,
+                                 UBaseType_t item_size,
+                                 uint8_t *storage,
+                                 StaticQueue_t *buffer) {
+    *buffer = (StaticQueue_t) {
+            .storage = storage,
+            .length = length,
+            .item_size = item_size,
+    };
+    return buffer;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue,
+                            const void *item,
+                            TickType_t timeout) {
+    struct timespec deadline;
+    deadline_after(timeout, &deadline);
+    pthread_mutex_lock(&m_kernel);
+    bool expired = false;
+    while (queue->count == queue->length) {
+        if (timeout == 0 || expired) {
+            pthread_mutex_unlock(&m_kernel);
+            return pdFALSE;
+        }
+        expired = !wait_for_change(timeout, &deadline);
+    }
+    if (queue->item_size > 0) {
+        UBaseType_t tail = (queue->head + queue->count) % queue->length;
+        memcpy(&queue->storage[tail * queue->item_size], item,
+               queue->item_size);
+    }
+    queue->count++;
+    changed();
+    pthread_mutex_unlock(&m_kernel);
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t timeout) {
+    struct timespec deadline;
+    deadline_after(timeout, &deadline);
+    pthread_mutex_lock(&m_kernel);
+    bool expired = false;
+    while (queue->count == 0) {
+        if (timeout == 0 || expired) {
+            pthread_mutex_unlock(&m_kernel);
+            return pdFALSE;
+        }
+        expired = !wait_for_change(timeout, &deadline);
+    }
+    if (queue->item_size > 0) {
+        memcpy(item, &queue->storage[queue->head * queue->item_size],
+               queue->item_size);
+    }
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    changed();
+    pthread_mutex_unlock(&m_kernel);
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    pthread_mutex_lock(&m_kernel);
+    UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&m_kernel);
+    return count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+    pthread_mutex_lock(&m_kernel);
+    UBaseType_t spaces = queue->length - queue->count;
+    pthread_mutex_unlock(&m_kernel);
+    return spaces;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *buffer) {
+    SemaphoreHandle_t mutex = xQueueCreateStatic(1, 0, NULL, buffer);
+    mutex->count = 1;
+    return mutex;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *buffer) {
+    return xQueueCreateStatic(1, 0, NULL, buffer);
+}
+
+static void *task_thread(void *arg) {
+    m_current_task = (TaskHandle_t) arg;
+    m_current_task->function(m_current_task->parameters);
+    return NULL;
+}
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t function,
+                               const char *name,
+                               uint32_t stack_depth,
+                               void *parameters,
+                               UBaseType_t priority,
+                               StackType_t *stack,
+                               StaticTask_t *buffer) {
+    (void) name;
+    (void) stack_depth;
+    (void) priority;
+    (void) stack;
+    *buffer = (StaticTask_t) {
+            .function = function,
+            .parameters = parameters,
+    };
+    // the tasks run until the process exits
+    if (pthread_create(&buffer->thread, NULL, task_thread, buffer) != 0
+        || pthread_detach(buffer->thread) != 0) {
+        return NULL;
+    }
+    return buffer;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return m_current_task;
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t) (now_us() / 1000u);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    usleep(ticks * 1000u);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    pthread_mutex_lock(&m_kernel);
+    task->notifications++;
+    changed();
+    pthread_mutex_unlock(&m_kernel);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken) {
+    (void) xTaskNotifyGive(task);
+    *woken = pdFALSE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t timeout) {
+    TaskHandle_t task = m_current_task;
+    struct timespec deadline;
+    deadline_after(timeout, &deadline);
+    pthread_mutex_lock(&m_kernel);
+    bool expired = false;
+    while (task->notifications == 0 && timeout != 0 && !expired) {
+        expired = !wait_for_change(timeout, &deadline);
+    }
+    uint32_t notifications = task->notifications;
+    if (notifications > 0) {
+        task->notifications = clear ? 0 : notifications - 1;
+    }
+    pthread_mutex_unlock(&m_kernel);
+    return notifications;
+}
+
+void vTaskSetTimeOutState(TimeOut_t *time_out) {
+    time_out->start = xTaskGetTickCount();
+}
+
+BaseType_t xTaskCheckForTimeOut(TimeOut_t *time_out, TickType_t *remaining) {
+    if (*remaining == portMAX_DELAY) {
+        return pdFALSE;
+    }
+    TickType_t now = xTaskGetTickCount();
+    TickType_t elapsed = now - time_out->start;
+    if (elapsed >= *remaining) {
+        *remaining = 0;
+        return pdTRUE;
+    }
+    *remaining -= elapsed;
+    time_out->start = now;
+    return pdFALSE;
+}
+
+// the parts of pico-sdk used by the shell tasks, there is no input and printf()
+// of the tasks is queued as by the wrapped pico-sdk stdio, other threads (e.g.
+// the one running the tests) print directly
+
+void _pfs_append_queue(const char *buffer, uint32_t buffer_size);
+bool _pfs_is_initialized(void);
+
+int __real_vprintf(const char *format, va_list va);
+int __real_puts(const char *s);
+
+// the kernel keeps the real time, the clock of the shell stands still once a
+// test sets it
+static bool m_time_set;
+static uint64_t m_time_us;
+
+void utils_set_time_us(uint32_t time_us) {
+    __atomic_store_n(&m_time_us, time_us, __ATOMIC_RELAXED);
+    __atomic_store_n(&m_time_set, true, __ATOMIC_RELEASE);
+}
+
+uint64_t time_us_64(void) {
+    if (__atomic_load_n(&m_time_set, __ATOMIC_ACQUIRE)) {
+        return __atomic_load_n(&m_time_us, __ATOMIC_RELAXED);
+    }
+    return now_us();
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t) time_us_64();
+}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+    (void) timeout_us;
+    return PICO_ERROR_TIMEOUT;
+}
+
+void stdio_flush(void) {}
+
+void stdio_set_chars_available_callback(void (*fn)(void *), void *param) {
+    (void) fn;
+    (void) param;
+}
+
+int vfctprintf(void (*out)(char character, void *arg),
+               void *arg,
+               const char *format,
+               va_list va) {
+    char buffer[256];
+    int len = vsnprintf(buffer, sizeof(buffer), format, va);
+    for (int i = 0; i < len && i < (int) sizeof(buffer) - 1; i++) {
+        out(buffer[i], arg);
+    }
+    return len;
+}
+
+static bool is_queued(void) {
+    return _pfs_is_initialized() && xTaskGetCurrentTaskHandle() != NULL;
+}
+
+int __wrap_vprintf(const char *format, va_list va) {
+    if (!is_queued()) {
+        return __real_vprintf(format, va);
+    }
+    char buffer[256];
+    int ret = vsnprintf(buffer, sizeof(buffer), format, va);
+    if (ret > 0) {
+        size_t len = (size_t) ret < sizeof(buffer) ? (size_t) ret
+                                                   : sizeof(buffer) - 1;
+        _pfs_append_queue(buffer, (uint32_t) len);
+    }
+    return ret;
+}
+
+int __wrap_printf(const char *format, ...) {
+    va_list va;
+    va_start(va, format);
+    int ret = __wrap_vprintf(format, va);
+    va_end(va);
+    return ret;
+}
+
+// the compiler turns printf("text\n") into puts("text")
+int __wrap_puts(const char *s) {
+    if (!is_queued()) {
+        return __real_puts(s);
+    }
+    int len = (int) strlen(s);
+    _pfs_append_queue(s, (uint32_t) len);
+    _pfs_append_queue("\n", 1);
+    return len;
+}
+
+// the output of the shell itself goes to the current session's transport, as
+// from pfs_io.c
+void PFS_WRAPPED(pfs_io_puts_immediately)(const char *s) {
+    pfs_transport_t *transport = pfs_session_current()->transport;
+    if (transport == NULL) {
+        fputs(s, stdout);
+        return;
+    }
+    (void) transport->vtable->write(transport, s, strlen(s), NULL, NULL);
+}
+
+void PFS_WRAPPED(pfs_io_putchar_immediately)(char c) {
+    char buf[2] = {c, '\0'};
+    PFS_WRAPPED(pfs_io_puts_immediately)(buf);
+}
@@ -22,14 +22,20 @@
 
 #pragma once
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif // __cplusplus
 
 char *utils_get_out_string_immediately_buffer(void);
 void utils_reset_out_string_immediately_buffer(void);
+void utils_set_time_us(uint32_t time_us);
 
 void pfs_reset_commands(void);
+void pfs_reset_log_modules(void);
+uint32_t pfs_cmd_stats_untracked_calls(void);
+void pfs_reset_output_sequence(void);
 
 #ifdef __cplusplus
 }